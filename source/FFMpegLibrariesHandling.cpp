@@ -658,6 +658,18 @@ namespace
     // All field following this line are not part of the public API and may change/be removed.
   } AVStream_58;
 
+  // The AVIndexEntry is part of AVFormat. It did not change in the versions that we support.
+  typedef struct AVIndexEntry_57_58
+  {
+    int64_t pos;
+    int64_t timestamp;
+  #define AVINDEX_KEYFRAME 0x0001
+  #define AVINDEX_DISCARD_FRAME 0x0002
+    int flags:2;
+    int size:30;
+    int min_distance;
+  } AVIndexEntry_57_58;
+
   // AVCodecParameters is part of avcodec.
   typedef struct AVCodecParameters_57_58
   {
@@ -847,6 +859,8 @@ FFmpegLibraryFunctions::FFmpegLibraryFunctions()
   av_read_frame = nullptr;
   av_seek_frame = nullptr;
   avformat_version = nullptr;
+  avformat_index_get_entries_count = nullptr;
+  avformat_index_get_entry = nullptr;
 
   avcodec_find_decoder = nullptr;
   avcodec_alloc_context3 = nullptr;
@@ -882,6 +896,10 @@ bool FFmpegLibraryFunctions::bindFunctionsFromAVFormatLib()
   if (!resolveAvFormat(av_read_frame, "av_read_frame")) return false;
   if (!resolveAvFormat(av_seek_frame, "av_seek_frame")) return false;
   if (!resolveAvFormat(avformat_version, "avformat_version")) return false;
+
+  // These functions are quite new. If they are not available, we try to get the index from the AVStream directly.
+  resolveAvFormat(avformat_index_get_entries_count, "avformat_index_get_entries_count", false);
+  resolveAvFormat(avformat_index_get_entry, "avformat_index_get_entry", false);
   return true;
 }
 
@@ -961,17 +979,18 @@ template <typename T> bool FFmpegLibraryFunctions::resolveAvUtil(T &fun, const c
   return (fun != nullptr);
 }
 
-QFunctionPointer FFmpegLibraryFunctions::resolveAvFormat(const char *symbol)
+QFunctionPointer FFmpegLibraryFunctions::resolveAvFormat(const char *symbol, bool failIsError)
 {
+  // Failure to resolve the function is only an error if failIsError is set.
   QFunctionPointer ptr = libAvformat.resolve(symbol);
-  if (!ptr)
+  if (!ptr && failIsError)
     LOG(QStringLiteral("Error loading the avformat library: Can't find function %1.").arg(symbol));
   return ptr;
 }
 
-template <typename T> bool FFmpegLibraryFunctions::resolveAvFormat(T &fun, const char *symbol)
+template <typename T> bool FFmpegLibraryFunctions::resolveAvFormat(T &fun, const char *symbol, bool failIsError)
 {
-  fun = reinterpret_cast<T>(resolveAvFormat(symbol));
+  fun = reinterpret_cast<T>(resolveAvFormat(symbol, failIsError));
   return (fun != nullptr);
 }
 
@@ -1237,8 +1256,24 @@ bool FFmpegVersionHandler::loadFFmpegLibraries()
     possibilites.append(QCoreApplication::applicationDirPath() + "/ffmpeg/");
     possibilites.append("");                                                    // Just try to call QLibrary::load so that the system folder will be searched.
 
+    // Trying all versions in all paths takes a while. Try the libraries that were found the last time first.
+    // Adding a library to one of the directories changes the search key, so new libraries with a higher priority
+    // are found. The system directories are searched last.
+    const QString searchKey = getLibrarySearchKey(possibilites, possibilites.mid(0, possibilites.count() - 1));
+    const QStringList cachedLibraryFiles = getCachedLibraryFiles("FFmpeg", searchKey);
+    if (cachedLibraryFiles.count() == 4)
+    {
+      LOG("Trying to load the libraries that were found the last time.");
+      librariesLoaded = loadFFMpegLibrarySpecific(cachedLibraryFiles[0], cachedLibraryFiles[1], cachedLibraryFiles[2], cachedLibraryFiles[3]);
+      if (!librariesLoaded)
+        removeCachedLibraryFiles("FFmpeg");
+    }
+
     for (QString path : possibilites)
     {
+      if (librariesLoaded)
+        break;
+
       if (path.isEmpty())
         LOG("Trying to load the libraries in the system path");
       else
@@ -1246,7 +1281,7 @@ bool FFmpegVersionHandler::loadFFmpegLibraries()
 
       librariesLoaded = loadFFmpegLibraryInPath(path);
       if (librariesLoaded)
-        break;
+        setCachedLibraryFiles("FFmpeg", searchKey, lib.getLoadedLibraryFiles());
     }
   }
 
@@ -1361,6 +1396,47 @@ int FFmpegVersionHandler::seek_frame(AVFormatContextWrapper & fmt, int stream_id
   return ret;
 }
 
+bool FFmpegVersionHandler::get_index_entries(AVStreamWrapper &stream, QList<AVIndexEntryWrapper> &entries)
+{
+  entries.clear();
+  AVStream *str = stream.get_stream();
+  if (str == nullptr)
+    return false;
+
+  QList<const AVIndexEntry_57_58*> srcEntries;
+  if (lib.avformat_index_get_entries_count && lib.avformat_index_get_entry)
+  {
+    const int nrEntries = lib.avformat_index_get_entries_count(str);
+    for (int i = 0; i < nrEntries; i++)
+      srcEntries.append(reinterpret_cast<const AVIndexEntry_57_58*>(lib.avformat_index_get_entry(str, i)));
+  }
+  else if (libVersion.avformat == 57)
+  {
+    // In this version, we know where the index is in the AVStream
+    AVStream_57 *src = reinterpret_cast<AVStream_57*>(str);
+    const AVIndexEntry_57_58 *srcIndex = reinterpret_cast<const AVIndexEntry_57_58*>(src->index_entries);
+    for (int i = 0; i < src->nb_index_entries; i++)
+      srcEntries.append(&srcIndex[i]);
+  }
+  else
+    // The index is not part of the public API of the AVStream and we can not access it
+    return false;
+
+  for (const AVIndexEntry_57_58 *e : srcEntries)
+  {
+    if (e == nullptr)
+      return false;
+    AVIndexEntryWrapper entry;
+    entry.pos = e->pos;
+    entry.timestamp = e->timestamp;
+    entry.keyframe = (e->flags & AVINDEX_KEYFRAME);
+    entry.discard = (e->flags & AVINDEX_DISCARD_FRAME);
+    entries.append(entry);
+  }
+  LOG(QString("get_index_entries found %1 entries").arg(entries.count()));
+  return !entries.isEmpty();
+}
+
 int FFmpegVersionHandler::seek_beginning(AVFormatContextWrapper & fmt)
 {
   // This is "borrowed" from the ffmpeg sources (https://ffmpeg.org/doxygen/4.0/ffmpeg_8c_source.html seek_to_start)
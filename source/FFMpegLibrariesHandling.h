@@ -59,6 +59,8 @@ public:
   bool loadFFMpegLibrarySpecific(QString avFormatLib, QString avCodecLib, QString avUtilLib, QString swResampleLib);
   
   QStringList getLibPaths() const;
+  // Get the full paths of the loaded libraries (avFormat, avCodec, avUtil, swResample)
+  QStringList getLoadedLibraryFiles() const { return QStringList() << libAvformat.fileName() << libAvcodec.fileName() << libAvutil.fileName() << libSwresample.fileName(); }
 
   // From avformat
   void     (*av_register_all)           ();
@@ -68,6 +70,9 @@ public:
   int      (*av_read_frame)             (AVFormatContext *s, AVPacket *pkt);
   int      (*av_seek_frame)             (AVFormatContext *s, int stream_index, int64_t timestamp, int flags);
   unsigned (*avformat_version)          (void);
+  // These are optional (and quite new). We use them to get the index of a stream if they are available.
+  int                 (*avformat_index_get_entries_count) (const AVStream *st);
+  const AVIndexEntry *(*avformat_index_get_entry)         (AVStream *st, int idx);
 
   // From avcodec
   AVCodec           *(*avcodec_find_decoder)     (AVCodecID id);
@@ -125,8 +130,8 @@ private:
 
   QFunctionPointer resolveAvUtil(const char *symbol);
   template <typename T> bool resolveAvUtil(T &ptr, const char *symbol);
-  QFunctionPointer resolveAvFormat(const char *symbol);
-  template <typename T> bool resolveAvFormat(T &ptr, const char *symbol);
+  QFunctionPointer resolveAvFormat(const char *symbol, bool failIsError);
+  template <typename T> bool resolveAvFormat(T &ptr, const char *symbol, bool failIsError=true);
   QFunctionPointer resolveAvCodec(const char *symbol, bool failIsError);
   template <typename T> bool resolveAvCodec(T &ptr, const char *symbol, bool failIsError=true);
   QFunctionPointer resolveSwresample(const char *symbol);
@@ -401,8 +406,10 @@ public:
   int get_frame_height();
   AVColorSpace get_colorspace();
   int get_index() { update(); return index; }
+  int64_t get_nb_frames() { update(); return nb_frames; }
 
   AVCodecParametersWrapper get_codecpar() { update(); return codecpar; }
+  AVStream *get_stream() { return str; }
 
   // This is set when the file is opened (in FFmpegVersionHandler::open_input)
   AVCodecIDWrapper codecIDWrapper;
@@ -432,6 +439,16 @@ private:
   FFmpegLibraryVersion libVer;
 };
 
+// An entry of the index of a stream (AVIndexEntry). Some demuxers (e.g. mp4) create an index that contains
+// all frames of the stream when opening the file.
+struct AVIndexEntryWrapper
+{
+  int64_t pos;
+  int64_t timestamp;  //< In the time base of the stream. For mp4 this is the DTS.
+  bool keyframe;
+  bool discard;       //< The frame is not shown (e.g. because of an edit list)
+};
+
 // AVPacket data can be in one of two formats:
 // 1: The raw annexB format with start codes (0x00000001 or 0x000001)
 // 2: ISO/IEC 14496-15 mp4 format: The first 4 bytes determine the size of the NAL unit followed by the payload
@@ -841,6 +858,9 @@ public:
   int seek_frame(AVFormatContextWrapper &fmt, int stream_idx, int dts);
   int seek_beginning(AVFormatContextWrapper & fmt);
 
+  // Get the index of the stream that the demuxer created when opening the file (if available).
+  bool get_index_entries(AVStreamWrapper &stream, QList<AVIndexEntryWrapper> &entries);
+
   // All the function pointers of the ffmpeg library
   FFmpegLibraryFunctions lib;
   
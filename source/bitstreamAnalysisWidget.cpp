@@ -45,6 +45,36 @@
 #define DEBUG_ANALYSIS(fmt,...) ((void)0)
 #endif
 
+bitstreamAnalysisParser::bitstreamAnalysisParser(inputFormat inputFormatType, const QString &filePath, bool parsingLimitEnabled) :
+  filePath(filePath),
+  inputFormatType(inputFormatType),
+  parsingLimitEnabled(parsingLimitEnabled)
+{
+  if (inputFormatType == inputAnnexBHEVC)
+    parser.reset(new parserAnnexBHEVC());
+  else if (inputFormatType == inputAnnexBAVC)
+    parser.reset(new parserAnnexBAVC());
+  else if (inputFormatType == inputLibavformat)
+    parser.reset(new parserAVFormat());
+  parser->enableModel();
+  parser->setParsingLimitEnabled(parsingLimitEnabled);
+}
+
+bitstreamAnalysisParser::~bitstreamAnalysisParser()
+{
+  if (backgroundParserFuture.isRunning())
+  {
+    DEBUG_ANALYSIS("bitstreamAnalysisParser::~bitstreamAnalysisParser stopping parser");
+    parser->setAbortParsing();
+    backgroundParserFuture.waitForFinished();
+  }
+}
+
+void bitstreamAnalysisParser::startParsing()
+{
+  backgroundParserFuture = QtConcurrent::run(&backgroundParserPool, parser.data(), &parserBase::runParsingOfFile, filePath);
+}
+
 BitstreamAnalysisWidget::BitstreamAnalysisWidget(QWidget *parent) :
   QWidget(parent)
 {
@@ -112,22 +142,14 @@ void BitstreamAnalysisWidget::updateParsingStatusText(int progressValue)
   }
 }
 
-void BitstreamAnalysisWidget::stopAndDeleteParser()
-{
-  if (backgroundParserFuture.isRunning())
-  {
-    DEBUG_ANALYSIS("BitstreamAnalysisWidget::stopAndDeleteParser stopping parser");
-    parser->setAbortParsing();
-    backgroundParserFuture.waitForFinished();
-  }
-  parser.reset();
-  DEBUG_ANALYSIS("BitstreamAnalysisWidget::stopAndDeleteParser parser stopped and deleted");
-}
-
-void BitstreamAnalysisWidget::backgroundParsingFunction()
+void BitstreamAnalysisWidget::releaseParser()
 {
   if (parser)
-    parser->runParsingOfFile(compressedFilePath);
+    parser->disconnect(this);
+  parser = nullptr;
+  ui.dataTreeView->setModel(nullptr);
+  currentParser.clear();
+  DEBUG_ANALYSIS("BitstreamAnalysisWidget::releaseParser parser released");
 }
 
 void BitstreamAnalysisWidget::currentSelectedItemsChanged(playlistItem *item1, playlistItem *item2, bool chageByPlayback)
@@ -145,7 +167,7 @@ void BitstreamAnalysisWidget::currentSelectedItemsChanged(playlistItem *item1, p
   restartParsingOfCurrentItem();
 }
 
-void BitstreamAnalysisWidget::restartParsingOfCurrentItem()
+void BitstreamAnalysisWidget::restartParsingOfCurrentItem(bool forceNewParsing)
 {
   if (!isVisible())
   {
@@ -153,51 +175,79 @@ void BitstreamAnalysisWidget::restartParsingOfCurrentItem()
     return;
   }
 
-  stopAndDeleteParser();
+  releaseParser();
   
   if (currentCompressedVideo.isNull())
   {
     DEBUG_ANALYSIS("BitstreamAnalysisWidget::restartParsingOfCurrentItem no compressed video - abort");
     updateParsingStatusText(-1);
-    parser.reset();
     return;
   }
 
-  // Setup a new parser
-  inputFormat inputFormatType = currentCompressedVideo->getInputFormat();
-  if (inputFormatType == inputAnnexBHEVC)
-    parser.reset(new parserAnnexBHEVC(this));
-  else if (inputFormatType == inputAnnexBAVC)
-    parser.reset(new parserAnnexBAVC(this));
-  else if (inputFormatType == inputLibavformat)
-    parser.reset(new parserAVFormat(this));
-  parser->enableModel();
+  // Forget the parsers that are not referenced by any item anymore
+  for (auto it = sharedParsers.begin(); it != sharedParsers.end();)
+  {
+    if (it.value().isNull())
+      it = sharedParsers.erase(it);
+    else
+      it++;
+  }
+
+  // Was the file of the item parsed before (by this item or another item of the same file)? The same file can be
+  // opened with different input formats (e.g. as raw annexB and using libavformat) which need different parsers.
+  const QString compressedFilePath = currentCompressedVideo->getName();
+  const inputFormat compressedInputFormat = currentCompressedVideo->getInputFormat();
+  const QPair<QString, int> parserKey(compressedFilePath, int(compressedInputFormat));
   const bool parsingLimitSet = !ui.parseEntireFileCheckBox->isChecked();
-  parser->setParsingLimitEnabled(parsingLimitSet);
+  QSharedPointer<bitstreamAnalysisParser> existingParser = currentCompressedVideo->getBitstreamAnalysisParser();
+  if (!existingParser)
+    existingParser = sharedParsers.value(parserKey).toStrongRef();
+  const bool reuseParser = !forceNewParsing && existingParser && existingParser->getInputFormat() == compressedInputFormat &&
+                           existingParser->isParsingLimitEnabled() == parsingLimitSet;
 
-  connect(parser.data(), &parserBase::nalModelUpdated, this, &BitstreamAnalysisWidget::updateParserItemModel);
-  connect(parser.data(), &parserBase::streamInfoUpdated, this, &BitstreamAnalysisWidget::updateStreamInfo);
-  connect(parser.data(), &parserBase::backgroundParsingDone, this, &BitstreamAnalysisWidget::backgroundParsingDone);
+  if (reuseParser)
+    currentParser = existingParser;
+  else
+    currentParser.reset(new bitstreamAnalysisParser(compressedInputFormat, compressedFilePath, parsingLimitSet));
+  currentCompressedVideo->setBitstreamAnalysisParser(currentParser);
+  sharedParsers[parserKey] = currentParser;
+  parser = currentParser->getParser();
 
-  compressedFilePath = currentCompressedVideo->getName();
+  connect(parser, &parserBase::nalModelUpdated, this, &BitstreamAnalysisWidget::updateParserItemModel);
+  connect(parser, &parserBase::streamInfoUpdated, this, &BitstreamAnalysisWidget::updateStreamInfo);
+  connect(parser, &parserBase::backgroundParsingDone, this, &BitstreamAnalysisWidget::backgroundParsingDone);
 
   ui.dataTreeView->setModel(parser->getPacketItemModel());
   ui.dataTreeView->setColumnWidth(0, 600);
   ui.dataTreeView->setColumnWidth(1, 100);
   ui.dataTreeView->setColumnWidth(2, 120);
 
+  // The display settings of the previous parser do not apply to this one
+  parser->setStreamColorCoding(ui.colorCodeStreamsCheckBox->isChecked());
+  parser->setFilterStreamIndex(showVideoStreamOnly ? parser->getVideoStreamIndex() : -1);
+
   updateStreamInfo();
   
+  if (reuseParser)
+  {
+    // Show the results so far. The parser may still be running.
+    DEBUG_ANALYSIS("BitstreamAnalysisWidget::restartParsingOfCurrentItem reusing parser");
+    parser->updateNumberModelItems();
+    updateParsingStatusText(currentParser->isParsingRunning() ? parser->getParsingProgressPercent() : 100);
+    return;
+  }
+
   // Start the background parsing thread
   updateParsingStatusText(0);
-  backgroundParserFuture = QtConcurrent::run(this, &BitstreamAnalysisWidget::backgroundParsingFunction);
+  currentParser->startParsing();
   DEBUG_ANALYSIS("BitstreamAnalysisWidget::restartParsingOfCurrentItem new parser created and started");
 }
 
 void BitstreamAnalysisWidget::hideEvent(QHideEvent *event)
 {
+  // The parsing results stay with the playlist item so we don't have to parse the file again if the widget is shown again
   DEBUG_ANALYSIS("BitstreamAnalysisWidget::hideEvent");
-  stopAndDeleteParser();
+  releaseParser();
   QWidget::hideEvent(event);
 }
 
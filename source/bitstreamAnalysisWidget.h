@@ -33,6 +33,7 @@
 #ifndef BITSTREAMANALYSISDIALOG_H
 #define BITSTREAMANALYSISDIALOG_H
 
+#include <QThreadPool>
 #include <QWidget>
 #include <QtConcurrent>
 
@@ -43,13 +44,43 @@
 #include "playlistItemCompressedVideo.h"
 #include "typedef.h"
 
+/* The parser of a file for the bitstream analysis and the background process that runs it. The parsing results are
+ * shared (reference counted) between the BitstreamAnalysisWidget and all playlist items of the same file. This way,
+ * the file is not parsed again if the widget is shown again or if an item is selected again. Parsing is aborted
+ * when the last reference is released.
+ */
+class bitstreamAnalysisParser
+{
+public:
+  bitstreamAnalysisParser(inputFormat inputFormatType, const QString &filePath, bool parsingLimitEnabled);
+  ~bitstreamAnalysisParser();
+
+  // Start parsing in a background thread. Connect to the signals of the parser before calling this.
+  void startParsing();
+  bool isParsingRunning() const { return backgroundParserFuture.isRunning(); }
+
+  parserBase *getParser() const { return parser.data(); }
+  QString getFilePath() const { return filePath; }
+  inputFormat getInputFormat() const { return inputFormatType; }
+  bool isParsingLimitEnabled() const { return parsingLimitEnabled; }
+
+private:
+  QScopedPointer<parserBase> parser;
+  // Parsing the entire file can take very long so it does not run in the global thread pool
+  QThreadPool backgroundParserPool;
+  QFuture<bool> backgroundParserFuture;
+  QString filePath;
+  inputFormat inputFormatType;
+  bool parsingLimitEnabled;
+};
+
 class BitstreamAnalysisWidget : public QWidget
 {
   Q_OBJECT
 
 public:
   BitstreamAnalysisWidget(QWidget *parent = nullptr);
-  ~BitstreamAnalysisWidget() { stopAndDeleteParser(); }
+  ~BitstreamAnalysisWidget() { releaseParser(); }
 
 public slots:
   void currentSelectedItemsChanged(playlistItem *item1, playlistItem *item2, bool chageByPlayback);
@@ -60,8 +91,8 @@ private slots:
   void backgroundParsingDone(QString error);
 
   void showVideoStreamOnlyCheckBoxToggled(bool state);
-  void colorCodeStreamsCheckBoxToggled(bool state) { parser->setStreamColorCoding(state); }
-  void parseEntireBitstreamCheckBoxToggled(bool state) { Q_UNUSED(state); restartParsingOfCurrentItem(); }
+  void colorCodeStreamsCheckBoxToggled(bool state) { if (parser) parser->setStreamColorCoding(state); }
+  void parseEntireBitstreamCheckBoxToggled(bool state) { Q_UNUSED(state); restartParsingOfCurrentItem(true); }
 
 protected:
   void hideEvent(QHideEvent *event) override;
@@ -74,15 +105,19 @@ private:
   // -1: No Item selected, 0-99: parsing in progress, 100: parsing done
   void updateParsingStatusText(int progressValue);
 
-  // Tell the parser to stop and block until it stops. Then delete the parser.
-  void stopAndDeleteParser();
+  // Disconnect from the current parser and release the reference to it. The parser keeps running if it is still
+  // referenced by a playlist item.
+  void releaseParser();
 
-  void restartParsingOfCurrentItem();
+  // Show the parsing results for the current item. If the item (or another item of the same file) was parsed
+  // before, these results are used. Otherwise (or if forceNewParsing is set) a new parser is started.
+  void restartParsingOfCurrentItem(bool forceNewParsing=false);
 
-  QScopedPointer<parserBase> parser;
-  QFuture<void> backgroundParserFuture;
-  void backgroundParsingFunction();
-  QString compressedFilePath;
+  QSharedPointer<bitstreamAnalysisParser> currentParser;
+  parserBase *parser {nullptr};
+
+  // All parsers which are still referenced by a playlist item (by file path)
+  QHash<QPair<QString, int>, QWeakPointer<bitstreamAnalysisParser>> sharedParsers;
 
   QPointer<playlistItemCompressedVideo> currentCompressedVideo;
 
@@ -117,18 +117,47 @@ void decoderBaseSingleLib::loadDecoderLibrary(QString specificLibrary)
       << QCoreApplication::applicationDirPath() + "/libde265/%1"
       << "%1"; // Try the system directories.
 
+    // Trying all names in all paths takes a while. Try the library that was found the last time first.
+    // Adding a library to one of the directories changes the search key, so a new library with a higher
+    // priority is found.
+    QStringList libDirectories;
+    for (auto &libPath : libPaths)
+      if (libPath != "%1")
+        libDirectories.append(libPath.arg(""));
+    const QString cacheName = libNames.last();
+    const QString searchKey = getLibrarySearchKey(QStringList() << libNames << libPaths, libDirectories);
+    const QStringList cachedLibraryFiles = getCachedLibraryFiles(cacheName, searchKey);
+    if (!cachedLibraryFiles.isEmpty())
+    {
+      library.setFileName(cachedLibraryFiles.first());
+      libraryPath = cachedLibraryFiles.first();
+      libLoaded = library.load();
+      if (!libLoaded)
+        removeCachedLibraryFiles(cacheName);
+    }
+
+    // If a name with a higher priority was tried in the system directories, a library with that name could be
+    // installed there later. That can not be detected, so the library that is found is not remembered then.
+    bool systemDirectoriesTried = false;
     for (auto &libName : libNames)
     {
+      if (libLoaded)
+        break;
       for (auto &libPath : libPaths)
       {
         library.setFileName(libPath.arg(libName));
         libraryPath = libPath.arg(libName);
         libLoaded = library.load();
         if (libLoaded)
+        {
+          // The file name is now the full path of the loaded library
+          if (!systemDirectoriesTried)
+            setCachedLibraryFiles(cacheName, searchKey, QStringList() << library.fileName());
           break;
+        }
+        if (libPath == "%1")
+          systemDirectoriesTried = true;
       }
-      if (libLoaded)
-        break;
     }
   }
 
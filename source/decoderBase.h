@@ -89,6 +89,8 @@ public:
   bool statisticsEnabled() const { return retrieveStatistics; }
   void enableStatisticsRetrieval() { retrieveStatistics = true; }
   statisticsData getStatisticsData(int typeIdx);
+  // Get the statistics of all types for the current frame (empty if statistics retrieval is not enabled)
+  QHash<int, statisticsData> getFrameStatistics() const { return retrieveStatistics ? curPOCStats : QHash<int, statisticsData>(); }
   virtual void fillStatisticList(statisticHandler &statSource) const { Q_UNUSED(statSource); };
 
   // Error handling
@@ -438,14 +438,36 @@ void decoderHM::cacheStatistics(libHMDec_picture *img)
       libHMDec_InternalsType statType = libHMDEC_get_internal_type(t);
       if (stats != nullptr && nrValues > 0)
       {
+        // Collect the values of this batch and add them to the statistics at once. The library may return the
+        // values in many batches.
+        statisticsBlockList valueBlocks, vectorBlocks;
+        QVector<int> values;
+        QVector<QPoint> vectors;
+        if (statType == LIBHMDEC_TYPE_VECTOR || statType == LIBHMDEC_TYPE_INTRA_DIR)
+        {
+          vectorBlocks.reserve(nrValues);
+          vectors.reserve(nrValues);
+        }
+        if (statType != LIBHMDEC_TYPE_VECTOR)
+        {
+          valueBlocks.reserve(nrValues);
+          values.reserve(nrValues);
+        }
+
         for (unsigned int i = 0; i < nrValues; i++)
         {
           libHMDec_BlockValue b = stats[i];
 
           if (statType == LIBHMDEC_TYPE_VECTOR)
-            curPOCStats[t].addBlockVector(b.x, b.y, b.w, b.h, b.value, b.value2);
+          {
+            vectorBlocks.append(b.x, b.y, b.w, b.h);
+            vectors.append(QPoint(b.value, b.value2));
+          }
           else
-            curPOCStats[t].addBlockValue(b.x, b.y, b.w, b.h, b.value);
+          {
+            valueBlocks.append(b.x, b.y, b.w, b.h);
+            values.append(b.value);
+          }
           if (statType == LIBHMDEC_TYPE_INTRA_DIR)
           {
             // Also add the vecotr to draw
@@ -453,10 +475,16 @@ void decoderHM::cacheStatistics(libHMDec_picture *img)
             {
               int vecX = (float)vectorTable[b.value][0] * b.w / 4;
               int vecY = (float)vectorTable[b.value][1] * b.w / 4;
-              curPOCStats[t].addBlockVector(b.x, b.y, b.w, b.h, vecX, vecY);
+              vectorBlocks.append(b.x, b.y, b.w, b.h);
+              vectors.append(QPoint(vecX, vecY));
             }
           }
         }
+
+        if (values.count() > 0)
+          curPOCStats[t].addBlockValues(valueBlocks, values);
+        if (vectors.count() > 0)
+          curPOCStats[t].addBlockVectors(vectorBlocks, vectors);
       }
     } while (callAgain); // Continue until the library returns that there is no more to retrive
   }
@@ -462,6 +462,7 @@ void decoderLibde265::cacheStatistics(const de265_image *img)
   {
     QScopedArrayPointer<uint16_t> tmpArr(new uint16_t[ widthInCTB * heightInCTB ]);
     de265_internals_get_CTB_sliceIdx(img, tmpArr.data());
+    curPOCStats[0].reserveBlockValues(widthInCTB * heightInCTB);
     for (int y = 0; y < heightInCTB; y++)
       for (int x = 0; x < widthInCTB; x++)
       {
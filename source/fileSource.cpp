@@ -32,6 +32,7 @@
 
 #include "fileSource.h"
 
+#include <climits>
 #include <QDateTime>
 #include <QDir>
 #include <QRegExp>
@@ -41,6 +42,9 @@
 #ifdef Q_OS_WIN
 #include <windows.h>
 #endif
+#if defined(Q_OS_LINUX) || defined(Q_OS_MAC)
+#include <fcntl.h>
+#endif
  
 #define FILESOURCE_DEBUG_SIMULATESLOWLOADING 0
 #if FILESOURCE_DEBUG_SIMULATESLOWLOADING && !NDEBUG
@@ -115,6 +119,22 @@ int64_t fileSource::readBytes(QByteArray &targetBuffer, int64_t startPos, int64_
   return srcFile.read(targetBuffer.data(), nrBytes);
 }
 
+void fileSource::readAhead(int64_t startPos, int64_t nrBytes)
+{
+  if (!isOk() || startPos < 0 || nrBytes <= 0)
+    return;
+
+  // The hint is not a read operation and does not change the file position. No need to lock the readMutex.
+#if defined(Q_OS_LINUX)
+  posix_fadvise(srcFile.handle(), startPos, nrBytes, POSIX_FADV_WILLNEED);
+#elif defined(Q_OS_MAC)
+  struct radvisory advice;
+  advice.ra_offset = startPos;
+  advice.ra_count = int(qMin(nrBytes, int64_t(INT_MAX)));
+  fcntl(srcFile.handle(), F_RDADVISE, &advice);
+#endif
+}
+
 QList<infoItem> fileSource::getFileInfoList() const
 {
   QList<infoItem> infoList;
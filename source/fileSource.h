@@ -86,6 +86,11 @@ public:
   void readBytes(byteArrayAligned &data, int64_t startPos, int64_t nrBytes);
 #endif
 
+  // Give the operating system a hint that the given range of the file will be read soon. The data is then
+  // read into the file system cache in the background so that a following readBytes() call does not block.
+  // This does nothing on systems that do not support such hints.
+  void readAhead(int64_t startPos, int64_t nrBytes);
+
   QString getAbsoluteFilePath() const { return fileInfo.absoluteFilePath(); }
 
   // Get the absolute path to the file (from absolute or relative path)
@@ -350,10 +350,7 @@ bool fileSourceFFmpegFile::openFile(const QString &filePath, QWidget *mainWindow
 
   // If another (already opened) bitstream is given, copy bitstream info from there; Otherwise scan the bitstream.
   if (other && other->isFileOpened)
-  {
-    nrFrames = other->nrFrames;
-    keyFrameList = other->keyFrameList;
-  }
+    copyFrameIndex(*other);
   else if (parseFile)
   {
     if (!scanBitstream(mainWindow))
@@ -377,8 +374,39 @@ void fileSourceFFmpegFile::updateFileWatchSetting()
     fileWatcher.removePath(fullFilePath);
 }
 
+bool fileSourceFFmpegFile::runScanningOfFile()
+{
+  const bool scanningOk = scanBitstream(nullptr);
+
+  QMutexLocker lock(&frameIndexMutex);
+  scanningDone = true;
+  firstKeyFrameFound.wakeAll();
+  return scanningOk;
+}
+
+void fileSourceFFmpegFile::waitForFirstKeyFrame()
+{
+  QMutexLocker lock(&frameIndexMutex);
+  while (!scanningDone && keyFrameList.isEmpty())
+    firstKeyFrameFound.wait(&frameIndexMutex);
+}
+
+void fileSourceFFmpegFile::copyFrameIndex(const fileSourceFFmpegFile &other)
+{
+  QMutexLocker otherLock(&other.frameIndexMutex);
+  const int otherNrFrames = other.nrFrames;
+  const QList<pictureIdx> otherKeyFrameList = other.keyFrameList;
+  otherLock.unlock();
+
+  QMutexLocker lock(&frameIndexMutex);
+  nrFrames = otherNrFrames;
+  keyFrameList = otherKeyFrameList;
+}
+
 int fileSourceFFmpegFile::getClosestSeekableDTSBefore(int frameIdx, int &seekToFrameIdx) const
 {
+  QMutexLocker lock(&frameIndexMutex);
+
   // We are always be able to seek to the beginning of the file
   int bestSeekDTS = keyFrameList[0].dts;
   seekToFrameIdx = keyFrameList[0].frame;
@@ -406,6 +434,10 @@ bool fileSourceFFmpegFile::scanBitstream(QWidget *mainWindow)
   if (!isFileOpened)
     return false;
 
+  // If the index of the container has all the information, we don't have to read all packets
+  if (scanContainerIndex())
+    return true;
+
   // Create the dialog (if the given pointer is not null)
   int64_t maxPTS = getMaxTS();
   // Updating the dialog (setValue) is quite slow. Only do this if the percent value changes.
@@ -420,16 +452,17 @@ bool fileSourceFFmpegFile::scanBitstream(QWidget *mainWindow)
     progress->setWindowModality(Qt::WindowModal);
   }
 
+  frameIndexMutex.lock();
   nrFrames = 0;
+  frameIndexMutex.unlock();
   while (goToNextPacket(true))
   {
     DEBUG_FFMPEG("fileSourceFFmpegFile::scanBitstream: frame %d pts %d dts %d%s", nrFrames, (int)pkt.get_pts(), (int)pkt.get_dts(), pkt.get_flag_keyframe() ? " - keyframe" : "");
 
-    if (pkt.get_flag_keyframe())
-      keyFrameList.append(pictureIdx(nrFrames, pkt.get_dts()));
-
     if (progress && progress->wasCanceled())
       return false;
+    if (abortScanning.load())
+      return false;
 
     int newPercentValue = pkt.get_pts() * 100 / maxPTS;
     if (newPercentValue != curPercentValue)
@@ -439,11 +472,53 @@ bool fileSourceFFmpegFile::scanBitstream(QWidget *mainWindow)
       curPercentValue = newPercentValue;
     }
 
+    QMutexLocker lock(&frameIndexMutex);
+    if (pkt.get_flag_keyframe())
+    {
+      keyFrameList.append(pictureIdx(nrFrames, pkt.get_dts()));
+      if (keyFrameList.count() == 1)
+        firstKeyFrameFound.wakeAll();
+    }
     nrFrames++;
   }
 
   DEBUG_FFMPEG("fileSourceFFmpegFile::scanBitstream: Scan done. Found %d frames and %d keyframes.", nrFrames, keyFrameList.length());
-  return !progress->wasCanceled();
+  return !(progress && progress->wasCanceled());
+}
+
+bool fileSourceFFmpegFile::scanContainerIndex()
+{
+  QList<AVIndexEntryWrapper> entries;
+  if (!ff.get_index_entries(video_stream, entries))
+    return false;
+
+  // The index can only be used if it contains every frame (in decoding order). Some containers only index
+  // the keyframes (e.g. the cues in mkv files). Then we don't know the frame numbers of the keyframes.
+  if (video_stream.get_nb_frames() != entries.count())
+  {
+    DEBUG_FFMPEG("fileSourceFFmpegFile::scanContainerIndex: The index has %d entries but the stream has %d frames.", entries.count(), (int)video_stream.get_nb_frames());
+    return false;
+  }
+
+  QList<pictureIdx> indexKeyFrameList;
+  for (int i = 0; i < entries.count(); i++)
+  {
+    // Frames that are discarded (e.g. because of an edit list) are not counted the same way when reading the packets.
+    // The timestamps must be increasing DTS values.
+    if (entries[i].discard || (i > 0 && entries[i].timestamp < entries[i-1].timestamp))
+      return false;
+
+    if (entries[i].keyframe)
+      indexKeyFrameList.append(pictureIdx(i, entries[i].timestamp));
+  }
+  if (indexKeyFrameList.isEmpty())
+    return false;
+
+  QMutexLocker lock(&frameIndexMutex);
+  nrFrames = entries.count();
+  keyFrameList = indexKeyFrameList;
+  DEBUG_FFMPEG("fileSourceFFmpegFile::scanContainerIndex: Found %d frames and %d keyframes in the index.", nrFrames, keyFrameList.length());
+  return true;
 }
 
 void fileSourceFFmpegFile::openFileAndFindVideoStream(QString fileName)
@@ -33,6 +33,9 @@
 #ifndef FILESOURCEFFMPEGFILE_H
 #define FILESOURCEFFMPEGFILE_H
 
+#include <QAtomicInt>
+#include <QMutex>
+#include <QWaitCondition>
 #include "fileSource.h"
 #include "FFMpegLibrariesHandling.h"
 #include "videoHandlerYUV.h"
@@ -51,6 +54,17 @@ public:
   // Load the ffmpeg libraries and try to open the file. The fileSource will install a watcher for the file.
   // Return false if anything goes wrong.
   bool openFile(const QString &filePath, QWidget *mainWindow=nullptr, fileSourceFFmpegFile *other=nullptr, bool parseFile=true);
+
+  // If the file was opened without parsing it, the frame index (number of frames and keyframes) can be obtained in the
+  // background. First, try to get it from the index of the container (fast). If that does not work, all packets must
+  // be scanned. Use a separate instance for this (runScanningOfFile reads the file) and copy the frame index from it
+  // to the instances that are used for reading while the scanning is running.
+  bool readContainerIndex() { return scanContainerIndex(); }
+  bool runScanningOfFile();
+  void setAbortScanning() { abortScanning.store(1); }
+  // Wait until the first keyframe was found (or scanning is done). Decoding can start from there.
+  void waitForFirstKeyFrame();
+  void copyFrameIndex(const fileSourceFFmpegFile &other);
   
   // Is the file at the end?
   // TODO: How do we do this?
@@ -89,7 +103,7 @@ public:
   int64_t getMaxTS();
 
   // Get information on the video stream
-  int getNumberFrames() const { return nrFrames; }
+  int getNumberFrames() const { QMutexLocker lock(&frameIndexMutex); return nrFrames; }
   AVCodecIDWrapper getVideoStreamCodecID() { return ff.getCodecIDWrapper(video_stream.getCodecID()); }
   AVCodecParametersWrapper getVideoCodecPar() { return video_stream.get_codecpar(); }
 
@@ -141,6 +155,14 @@ protected:
   // If a mainWindow pointer is given, open a progress dialog. Return true on success. False if the process was canceled.
   bool scanBitstream(QWidget *mainWindow);
   int nrFrames {0};
+  // The frame index (nrFrames and keyFrameList) may be read while it is scanned in the background
+  QMutex mutable frameIndexMutex;
+  QWaitCondition firstKeyFrameFound;
+  bool scanningDone {false};
+  QAtomicInt abortScanning;
+  // Some containers (e.g. mp4) have an index of all frames that the demuxer reads when opening the file. If the index
+  // contains all frames, we can get the keyframes and the number of frames from it without reading the whole file.
+  bool scanContainerIndex();
 
   // Private struct for navigation. We index frames by frame number and FFMpeg uses the pts.
   // This connects both values.
@@ -33,6 +33,7 @@
 #include "frameHandler.h"
 
 #include <QPainter>
+#include <QtMath>
 #include "playlistItem.h"
 
 // ------ Initialize the static list of frame size presets ----------
@@ -78,6 +79,112 @@ QStringList frameHandler::frameSizePresetList::getFormattedNames() const
 
 frameHandler::frameSizePresetList frameHandler::presetFrameSizes;
 
+// ------ The glyph atlas for drawing pixel values ----------
+
+// All characters that can appear in a pixel value text
+#define PIXEL_VALUE_GLYPHS "0123456789-RGBYUV"
+// Free space around each glyph in the atlas (for antialiasing)
+#define PIXEL_VALUE_GLYPH_PADDING 1
+
+frameHandler::pixelValueGlyphAtlas &frameHandler::getPixelValueGlyphAtlas()
+{
+  static pixelValueGlyphAtlas glyphAtlas;
+  return glyphAtlas;
+}
+
+void frameHandler::pixelValueGlyphAtlas::renderAtlas(const QFont &font, int pixelRatio)
+{
+  const QString glyphs(PIXEL_VALUE_GLYPHS);
+  const QFontMetricsF metrics(font);
+  const int padding = PIXEL_VALUE_GLYPH_PADDING;
+
+  // All cells have the same size (the widest glyph)
+  qreal maxAdvance = 0;
+  for (QChar c : glyphs)
+    maxAdvance = qMax(maxAdvance, metrics.width(c));
+  glyphCellSize = QSizeF(qCeil(maxAdvance) + 2 * padding, qCeil(metrics.height()) + 2 * padding);
+  lineSpacing = metrics.lineSpacing();
+
+  atlas = QPixmap(int(glyphCellSize.width()) * glyphs.length() * pixelRatio, int(glyphCellSize.height()) * 2 * pixelRatio);
+  atlas.setDevicePixelRatio(pixelRatio);
+  atlas.fill(Qt::transparent);
+
+  QPainter atlasPainter(&atlas);
+  atlasPainter.setFont(font);
+  for (int i = 0; i < glyphs.length(); i++)
+  {
+    const int c = glyphs[i].toLatin1();
+    const qreal x = i * glyphCellSize.width();
+    atlasPainter.setPen(Qt::black);
+    atlasPainter.drawText(QPointF(x + padding, padding + metrics.ascent()), glyphs.mid(i, 1));
+    atlasPainter.setPen(Qt::white);
+    atlasPainter.drawText(QPointF(x + padding, glyphCellSize.height() + padding + metrics.ascent()), glyphs.mid(i, 1));
+
+    glyphSource[c] = QRectF(x * pixelRatio, 0, glyphCellSize.width() * pixelRatio, glyphCellSize.height() * pixelRatio);
+    glyphAdvance[c] = metrics.width(glyphs[i]);
+  }
+
+  atlasFont = font;
+  atlasPixelRatio = pixelRatio;
+}
+
+void frameHandler::pixelValueGlyphAtlas::begin(QPainter *painter)
+{
+  const int pixelRatio = painter->device()->devicePixelRatio();
+  if (atlas.isNull() || painter->font() != atlasFont || pixelRatio != atlasPixelRatio)
+    renderAtlas(painter->font(), pixelRatio);
+  fragments.resize(0);
+}
+
+void frameHandler::pixelValueGlyphAtlas::addValues(const QRect &rect, const char *labels, const int *values, int nrValues, bool white)
+{
+  const QPointF center = QRectF(rect).center();
+  const qreal rowOffset = white ? glyphCellSize.height() * atlasPixelRatio : 0;
+  const qreal scale = 1.0 / atlasPixelRatio;
+  qreal y = qRound(center.y() - nrValues * lineSpacing / 2);
+
+  for (int i = 0; i < nrValues; i++)
+  {
+    // Format the line (label, sign and digits)
+    char text[16];
+    int length = 0;
+    text[length++] = labels[i];
+    if (values[i] < 0)
+      text[length++] = '-';
+    char digits[12];
+    int nrDigits = 0;
+    unsigned int val = (values[i] < 0) ? -(unsigned int)values[i] : values[i];
+    do
+    {
+      digits[nrDigits++] = '0' + val % 10;
+      val /= 10;
+    } while (val > 0);
+    while (nrDigits > 0)
+      text[length++] = digits[--nrDigits];
+
+    // Center the line horizontally and add a fragment for each character
+    qreal width = 0;
+    for (int j = 0; j < length; j++)
+      width += glyphAdvance[int(text[j])];
+    qreal x = qRound(center.x() - width / 2);
+    for (int j = 0; j < length; j++)
+    {
+      const QRectF source = glyphSource[int(text[j])].translated(0, rowOffset);
+      const QPointF targetCenter(x - PIXEL_VALUE_GLYPH_PADDING + glyphCellSize.width() / 2, y - PIXEL_VALUE_GLYPH_PADDING + glyphCellSize.height() / 2);
+      fragments.append(QPainter::PixmapFragment::create(targetCenter, source, scale, scale));
+      x += glyphAdvance[int(text[j])];
+    }
+    y += lineSpacing;
+  }
+}
+
+void frameHandler::pixelValueGlyphAtlas::end(QPainter *painter)
+{
+  if (!fragments.isEmpty())
+    painter->drawPixmapFragments(fragments.constData(), fragments.count(), atlas);
+  fragments.resize(0);
+}
+
 // ---------------- frameHandler ---------------------------------
 
 // Activate this if you want to know when which buffer is loaded/converted to image and so on.
@@ -126,6 +233,17 @@ void frameHandler::setFrameSize(const QSize &newSize)
     // Set the new size
     DEBUG_FRAME("frameHandler::setFrameSize %dx%d", newSize.width(), newSize.height());
     frameSize = newSize;
+
+    if (ui.created())
+    {
+      // Update the controls without triggering slotVideoControlChanged
+      const QSignalBlocker blocker1(ui.widthSpinBox);
+      const QSignalBlocker blocker2(ui.heightSpinBox);
+      const QSignalBlocker blocker3(ui.frameSizeComboBox);
+      ui.widthSpinBox->setValue(frameSize.width());
+      ui.heightSpinBox->setValue(frameSize.height());
+      ui.frameSizeComboBox->setCurrentIndex(presetFrameSizes.findSize(frameSize));
+    }
   }
 }
 
@@ -230,6 +348,8 @@ void frameHandler::drawPixelValues(QPainter *painter, const int frameIdx, const
   // This QRect has the size of one pixel and is moved on top of each pixel to draw the text
   QRect pixelRect;
   pixelRect.setSize(QSize(zoomFactor, zoomFactor));
+  pixelValueGlyphAtlas &glyphAtlas = getPixelValueGlyphAtlas();
+  glyphAtlas.begin(painter);
   for (int x = xMin; x <= xMax; x++)
   {
     for (int y = yMin; y <= yMax; y++)
@@ -238,10 +358,10 @@ void frameHandler::drawPixelValues(QPainter *painter, const int frameIdx, const
       QPoint pixCenter = centerPointZero + QPoint(x * zoomFactor, y * zoomFactor);
       pixelRect.moveCenter(pixCenter);
      
-      // Get the text to show
+      // Get the values to show
       bool drawWhite = false;
       QRgb pixVal;
-      QString valText;
+      int values[3];
       if (item2 != nullptr)
       {
         QRgb pixel1 = getPixelVal(x, y);
@@ -261,87 +381,109 @@ void frameHandler::drawPixelValues(QPainter *painter, const int frameIdx, const
           drawWhite = (dR == 0 && dG == 0 && dB == 0);
         else
           drawWhite = (qRed(pixVal) < 128 && qGreen(pixVal) < 128 && qBlue(pixVal) < 128);
-        valText = QString("R%1\nG%2\nB%3").arg(dR).arg(dG).arg(dB);
+        values[0] = dR;
+        values[1] = dG;
+        values[2] = dB;
       }
       else
       {
         pixVal = getPixelVal(x, y);
         drawWhite = (qRed(pixVal) < 128 && qGreen(pixVal) < 128 && qBlue(pixVal) < 128);
-        valText = QString("R%1\nG%2\nB%3").arg(qRed(pixVal)).arg(qGreen(pixVal)).arg(qBlue(pixVal));
+        values[0] = qRed(pixVal);
+        values[1] = qGreen(pixVal);
+        values[2] = qBlue(pixVal);
       }
       
-      painter->setPen(drawWhite ? Qt::white : Qt::black);
-      painter->drawText(pixelRect, Qt::AlignCenter, valText);
+      glyphAtlas.addValues(pixelRect, "RGB", values, 3, drawWhite);
     }
   }
+  glyphAtlas.end(painter);
 }
 
-QImage frameHandler::calculateDifference(frameHandler *item2, const int frameIdxItem0, const int frameIdxItem1, QList<infoItem> &differenceInfoList, const int amplificationFactor, const bool markDifference)
+namespace
 {
-  Q_UNUSED(frameIdxItem0);
-  Q_UNUSED(frameIdxItem1);
-
-  int width  = qMin(frameSize.width(), item2->frameSize.width());
-  int height = qMin(frameSize.height(), item2->frameSize.height());
-
-  QImage diffImg(width, height, platformImageFormat());
+  // Calculate the RGB difference of two frames of the given size. The pixel values are read using the two given functions.
+  template <typename GetPixel0, typename GetPixel1>
+  QImage calculateDifferenceRGB(int width, int height, GetPixel0 getPixel0, GetPixel1 getPixel1, QList<infoItem> &differenceInfoList, const int amplificationFactor, const bool markDifference)
+  {
+    QImage diffImg(width, height, platformImageFormat());
 
-  // Also calculate the MSE while we're at it (R,G,B)
-  int64_t mseAdd[3] = {0, 0, 0};
+    // Also calculate the MSE while we're at it (R,G,B)
+    int64_t mseAdd[3] = {0, 0, 0};
 
-  for (int y = 0; y < height; y++)
-  {
-    for (int x = 0; x < width; x++)
+    for (int y = 0; y < height; y++)
     {
-      QRgb pixel1 = getPixelVal(x, y);
-      QRgb pixel2 = item2->getPixelVal(x, y);
+      for (int x = 0; x < width; x++)
+      {
+        QRgb pixel1 = getPixel0(x, y);
+        QRgb pixel2 = getPixel1(x, y);
 
-      int dR = int(qRed(pixel1)) - int(qRed(pixel2));
-      int dG = int(qGreen(pixel1)) - int(qGreen(pixel2));
-      int dB = int(qBlue(pixel1)) - int(qBlue(pixel2));
+        int dR = int(qRed(pixel1)) - int(qRed(pixel2));
+        int dG = int(qGreen(pixel1)) - int(qGreen(pixel2));
+        int dB = int(qBlue(pixel1)) - int(qBlue(pixel2));
 
-      int r, g, b;
-      if (markDifference)
-      {
-        r = (dR != 0) ? 255 : 0;
-        g = (dG != 0) ? 255 : 0;
-        b = (dB != 0) ? 255 : 0;
-      }
-      else if (amplificationFactor != 1)
-      {  
-        r = clip(128 + dR * amplificationFactor, 0, 255);
-        g = clip(128 + dG * amplificationFactor, 0, 255);
-        b = clip(128 + dB * amplificationFactor, 0, 255);
-      }
-      else
-      {  
-        r = clip(128 + dR, 0, 255);
-        g = clip(128 + dG, 0, 255);
-        b = clip(128 + dB, 0, 255);
+        int r, g, b;
+        if (markDifference)
+        {
+          r = (dR != 0) ? 255 : 0;
+          g = (dG != 0) ? 255 : 0;
+          b = (dB != 0) ? 255 : 0;
+        }
+        else if (amplificationFactor != 1)
+        {  
+          r = clip(128 + dR * amplificationFactor, 0, 255);
+          g = clip(128 + dG * amplificationFactor, 0, 255);
+          b = clip(128 + dB * amplificationFactor, 0, 255);
+        }
+        else
+        {  
+          r = clip(128 + dR, 0, 255);
+          g = clip(128 + dG, 0, 255);
+          b = clip(128 + dB, 0, 255);
+        }
+        
+        mseAdd[0] += dR * dR;
+        mseAdd[1] += dG * dG;
+        mseAdd[2] += dB * dB;
+
+        QRgb val = qRgb(r, g, b);
+        diffImg.setPixel(x, y, val);
       }
-      
-      mseAdd[0] += dR * dR;
-      mseAdd[1] += dG * dG;
-      mseAdd[2] += dB * dB;
-
-      QRgb val = qRgb(r, g, b);
-      diffImg.setPixel(x, y, val);
     }
+
+    differenceInfoList.append(infoItem("Difference Type","RGB"));
+    
+    double mse[4];
+    mse[0] = double(mseAdd[0]) / (width * height);
+    mse[1] = double(mseAdd[1]) / (width * height);
+    mse[2] = double(mseAdd[2]) / (width * height);
+    mse[3] = mse[0] + mse[1] + mse[2];
+    differenceInfoList.append(infoItem("MSE R",QString("%1").arg(mse[0])));
+    differenceInfoList.append(infoItem("MSE G",QString("%1").arg(mse[1])));
+    differenceInfoList.append(infoItem("MSE B",QString("%1").arg(mse[2])));
+    differenceInfoList.append(infoItem("MSE All",QString("%1").arg(mse[3])));
+
+    return diffImg;
   }
+}
+
+QImage frameHandler::calculateDifference(frameHandler *item2, const int frameIdxItem0, const int frameIdxItem1, QList<infoItem> &differenceInfoList, const int amplificationFactor, const bool markDifference)
+{
+  Q_UNUSED(frameIdxItem0);
+  Q_UNUSED(frameIdxItem1);
+
+  int width  = qMin(frameSize.width(), item2->frameSize.width());
+  int height = qMin(frameSize.height(), item2->frameSize.height());
+
+  return calculateDifferenceRGB(width, height, [this](int x, int y) { return getPixelVal(x, y); }, [item2](int x, int y) { return item2->getPixelVal(x, y); }, differenceInfoList, amplificationFactor, markDifference);
+}
+
+QImage frameHandler::calculateDifferenceOfImages(const QImage &image0, const QImage &image1, QList<infoItem> &differenceInfoList, const int amplificationFactor, const bool markDifference)
+{
+  int width  = qMin(image0.width(), image1.width());
+  int height = qMin(image0.height(), image1.height());
 
-  differenceInfoList.append(infoItem("Difference Type","RGB"));
-  
-  double mse[4];
-  mse[0] = double(mseAdd[0]) / (width * height);
-  mse[1] = double(mseAdd[1]) / (width * height);
-  mse[2] = double(mseAdd[2]) / (width * height);
-  mse[3] = mse[0] + mse[1] + mse[2];
-  differenceInfoList.append(infoItem("MSE R",QString("%1").arg(mse[0])));
-  differenceInfoList.append(infoItem("MSE G",QString("%1").arg(mse[1])));
-  differenceInfoList.append(infoItem("MSE B",QString("%1").arg(mse[2])));
-  differenceInfoList.append(infoItem("MSE All",QString("%1").arg(mse[3])));
-
-  return diffImg;
+  return calculateDifferenceRGB(width, height, [&image0](int x, int y) { return image0.pixel(x, y); }, [&image1](int x, int y) { return image1.pixel(x, y); }, differenceInfoList, amplificationFactor, markDifference);
 }
 
 bool frameHandler::isPixelDark(const QPoint &pixelPos)
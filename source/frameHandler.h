@@ -33,8 +33,12 @@
 #ifndef FRAMEHANDLER_H
 #define FRAMEHANDLER_H
 
+#include <QFont>
 #include <QImage>
 #include <QObject>
+#include <QPainter>
+#include <QPixmap>
+#include <QVector>
 #include "typedef.h"
 #include "ui_frameHandler.h"
 
@@ -79,6 +83,9 @@ public:
   // function can be overloaded by more specialized video items. For example the videoHandlerYUV
   // overloads this and calculates the difference directly on the YUV values (if possible).
   virtual QImage calculateDifference(frameHandler *item2, const int frameIdxItem0, const int frameIdxItem1, QList<infoItem> &differenceInfoList, const int amplificationFactor, const bool markDifference);
+  // Calculate the RGB difference of the two given images (of the top left aligned part that overlaps). This does not use
+  // the current frame of any handler so it can be called from a caching thread.
+  static QImage calculateDifferenceOfImages(const QImage &image0, const QImage &image1, QList<infoItem> &differenceInfoList, const int amplificationFactor, const bool markDifference);
   
   // Create the frame controls and return a pointer to the layout. This can be used by
   // inherited classes to create a properties widget.
@@ -116,6 +123,35 @@ protected:
   // When slotVideoControlChanged is called, update the controls and return the new selected size
   QSize getNewSizeFromControls();
 
+  // Formatting and laying out a text for every visible pixel in drawPixelValues is slow. Instead, all characters that
+  // can appear in the pixel values (digits, '-' and the component names) are rendered once into an atlas (one row
+  // black, one row white). The values of all pixels are collected and then drawn from the atlas in one call.
+  class pixelValueGlyphAtlas
+  {
+  public:
+    // Start collecting values. The values are drawn with the font of the painter. If the font changed, the atlas is
+    // rendered again.
+    void begin(QPainter *painter);
+    // Add the values centered in rect. There is one line for each value. The line starts with the character of labels
+    // for the value (e.g. "YUV" for three lines).
+    void addValues(const QRect &rect, const char *labels, const int *values, int nrValues, bool white);
+    // Draw all values that were added since begin()
+    void end(QPainter *painter);
+  private:
+    void renderAtlas(const QFont &font, int pixelRatio);
+    QPixmap atlas;
+    QFont atlasFont;
+    int atlasPixelRatio {0};
+    // For each (ASCII) character: The source rect in the black row of the atlas (in pixels) and the advance.
+    QRectF glyphSource[128];
+    qreal glyphAdvance[128];
+    QSizeF glyphCellSize;
+    qreal lineSpacing {0};
+    QVector<QPainter::PixmapFragment> fragments;
+  };
+  // The atlas is shared by all frame handlers. Drawing is only done in the main thread.
+  static pixelValueGlyphAtlas &getPixelValueGlyphAtlas();
+
 private:
 
   // A list of all frame size presets. Only used privately in this class. Defined in the .cpp file.
@@ -101,6 +101,7 @@ MainWindow::MainWindow(bool useAlternativeSources, QWidget *parent) : QMainWindo
   connect(ui.playlistTreeWidget, &PlaylistTreeWidget::itemAboutToBeDeleted, ui.propertiesWidget, &PropertiesWidget::itemAboutToBeDeleted);
   connect(ui.playlistTreeWidget, &PlaylistTreeWidget::openFileDialog, this, &MainWindow::showFileOpenDialog);
   connect(ui.playlistTreeWidget, &PlaylistTreeWidget::selectedItemDoubleBufferLoad, ui.playbackController, &PlaybackController::currentSelectedItemsDoubleBufferLoad);
+  connect(ui.playlistTreeWidget, &PlaylistTreeWidget::recentFileListChanged, this, &MainWindow::updateRecentFileActions);
 
   ui.displaySplitView->setAttribute(Qt::WA_AcceptTouchEvents);
 
@@ -698,8 +699,6 @@ void MainWindow::showFileOpenDialog()
   }
 
   ui.playlistTreeWidget->loadFiles(fileNames);
-
-  updateRecentFileActions();
 }
 
 /// End Full screen. Goto one window mode and reset all the geometry and state settings that were saved.
@@ -31,9 +31,15 @@
 */
 
 #include "parserAnnexB.h"
+#include <algorithm>
 #include <assert.h>
 #include "mainwindow.h"
+#include <QFile>
 #include <QProgressDialog>
+#include <QQueue>
+#include <QThread>
+#include <QThreadPool>
+#include <QtConcurrent>
 
 #define PARSERANNEXB_DEBUG_OUTPUT 0
 #if PARSERANNEXB_DEBUG_OUTPUT && !NDEBUG
@@ -43,9 +49,76 @@
 #define DEBUG_ANNEXB(fmt,...) ((void)0)
 #endif
 
+// A frame that is found later in the bitstream can only be output before a limited number of frames that were found
+// before it (sps_max_num_reorder_pics / max_num_reorder_frames). Both AVC and HEVC limit this to less than 16. While
+// parsing, all but the last this many frames (in display order) will not change their position anymore.
+#define PARSER_ANNEXB_MAX_REORDERED_FRAMES 16
+
+// For parsing, the file is split into chunks of this size. The NAL units in the chunks are located in parallel.
+#define PARSER_ANNEXB_CHUNK_SIZE (8 * 1024 * 1024)
+
+namespace
+{
+  // The NAL units that start in one chunk of the file (the start code position is the position of the first byte
+  // of the start code). The last NAL unit may continue in the next chunk(s).
+  struct annexBChunk
+  {
+    bool ok {false};
+    // All bytes from the start of the chunk to the first start code in the chunk (the end of a NAL from a previous chunk)
+    QByteArray leadingData;
+    QList<uint64_t> nalStartPos;
+    QList<QByteArray> nalData;
+  };
+
+  // Read the chunk [chunkStart, chunkEnd) from the file and locate all start codes (0x000001 or 0x00000001).
+  // A start code belongs to the chunk that contains its 0x01 byte. So the first bytes of the start code may be
+  // in the previous chunk. This function is thread-safe. Every call opens the file on its own.
+  annexBChunk findNALUnitsInChunk(QString filePath, int64_t chunkStart, int64_t chunkEnd)
+  {
+    annexBChunk chunk;
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly))
+      return chunk;
+
+    // Also read the last 3 bytes of the previous chunk (which may contain the zero bytes of a start code)
+    const int64_t bufferStart = std::max(chunkStart - 3, int64_t(0));
+    if (!file.seek(bufferStart))
+      return chunk;
+    const QByteArray buffer = file.read(chunkEnd - bufferStart);
+    if (buffer.size() != chunkEnd - bufferStart)
+      return chunk;
+
+    static const QByteArray startCode("\x00\x00\x01", 3);
+    QList<int> nalStartIdx;
+    for (int idx = buffer.indexOf(startCode); idx != -1; idx = buffer.indexOf(startCode, idx + 3))
+    {
+      if (bufferStart + idx + 2 < chunkStart)
+        // The 0x01 byte is in the previous chunk
+        continue;
+      // For 0001 point to the first 0 byte
+      nalStartIdx.append((idx > 0 && buffer.at(idx - 1) == (char)0) ? idx - 1 : idx);
+    }
+
+    const int chunkStartIdx = int(chunkStart - bufferStart);
+    const int firstNALIdx = nalStartIdx.isEmpty() ? buffer.size() : nalStartIdx.first();
+    if (firstNALIdx > chunkStartIdx)
+      chunk.leadingData = buffer.mid(chunkStartIdx, firstNALIdx - chunkStartIdx);
+    for (int i = 0; i < nalStartIdx.size(); i++)
+    {
+      const int end = (i + 1 < nalStartIdx.size()) ? nalStartIdx[i + 1] : buffer.size();
+      chunk.nalStartPos.append(bufferStart + nalStartIdx[i]);
+      chunk.nalData.append(buffer.mid(nalStartIdx[i], end - nalStartIdx[i]));
+    }
+    chunk.ok = true;
+    return chunk;
+  }
+}
+
 bool parserAnnexB::addFrameToList(int poc, QUint64Pair fileStartEndPos, bool randomAccessPoint)
 {
-  if (POCList.contains(poc))
+  // The POC list is always kept sorted
+  auto pocPosition = std::lower_bound(POCList.begin(), POCList.end(), poc);
+  if (pocPosition != POCList.end() && *pocPosition == poc)
     return false;
 
   if (pocOfFirstRandomAccessFrame == -1 && randomAccessPoint)
@@ -58,14 +131,39 @@ bool parserAnnexB::addFrameToList(int poc, QUint64Pair fileStartEndPos, bool ran
     newFrame.fileStartEndPos = fileStartEndPos;
     newFrame.randomAccessPoint = randomAccessPoint;
     frameList.append(newFrame);
+    if (randomAccessPoint)
+      nrFramesBeforeLastRandomAccessPoint = frameList.size() - 1;
 
-    POCList.append(poc);
+    POCList.insert(pocPosition, poc);
   }
   return true;
 }
 
+int parserAnnexB::getNumberPOCs() const
+{
+  QMutexLocker lock(&parsingMutex);
+  if (!fileParsingRunning)
+    return frameList.size();
+  return std::max(nrFramesBeforeLastRandomAccessPoint, frameList.size() - PARSER_ANNEXB_MAX_REORDERED_FRAMES);
+}
+
+void parserAnnexB::waitForFirstFrames()
+{
+  QMutexLocker lock(&parsingMutex);
+  while (!fileParsingDone && (!fileParsingRunning || std::max(nrFramesBeforeLastRandomAccessPoint, frameList.size() - PARSER_ANNEXB_MAX_REORDERED_FRAMES) <= 0))
+    firstFramesFound.wait(&parsingMutex);
+}
+
+bool parserAnnexB::isFileParsingRunning() const
+{
+  QMutexLocker lock(&parsingMutex);
+  return fileParsingRunning;
+}
+
 int parserAnnexB::getClosestSeekableFrameNumberBefore(int frameIdx, int &codingOrderFrameIdx) const
 {
+  QMutexLocker lock(&parsingMutex);
+
   // Get the POC for the frame number
   int seekPOC = POCList[frameIdx];
 
@@ -100,6 +198,7 @@ int parserAnnexB::getClosestSeekableFrameNumberBefore(int frameIdx, int &codingO
 
 QUint64Pair parserAnnexB::getFrameStartEndPos(int codingOrderFrameIdx)
 {
+  QMutexLocker lock(&parsingMutex);
   if (codingOrderFrameIdx < 0 || codingOrderFrameIdx >= frameList.size())
     return QUint64Pair(-1, -1);
   return frameList[codingOrderFrameIdx].fileStartEndPos;
@@ -128,26 +227,30 @@ bool parserAnnexB::parseAnnexBFile(QScopedPointer<fileSourceAnnexBFile> &file, Q
   stream_info.parsing = true;
   emit streamInfoUpdated();
 
-  // Just push all NAL units from the annexBFile into the annexBParser
-  QByteArray nalData;
+  parsingMutex.lock();
+  fileParsingRunning = true;
+  fileParsingDone = false;
+  nrFramesBeforeLastRandomAccessPoint = 0;
+  parsingMutex.unlock();
+
+  // Parse the given NAL unit. Return false if parsing should be aborted.
   int nalID = 0;
-  QUint64Pair nalStartEndPosFile;
-  bool abortParsing = false;
   QElapsedTimer signalEmitTimer;
   signalEmitTimer.start();
-  while (!file->atEnd() && !abortParsing)
+  auto parseNALUnit = [&](const QByteArray &nalData, QUint64Pair nalStartEndPosFile)
   {
     // Update the progress dialog
-    int64_t pos = file->pos();
-    progressPercentValue = clip((int)(pos * 100 / stream_info.file_size), 0, 100);
+    progressPercentValue = clip((int)(nalStartEndPosFile.first * 100 / stream_info.file_size), 0, 100);
 
     try
     {
-      nalData = file->getNextNALUnit(false, &nalStartEndPosFile);
+      QMutexLocker lock(&parsingMutex);
       if (!parseAndAddNALUnit(nalID, nalData, nullptr, nalStartEndPosFile))
       {
         DEBUG_ANNEXB("parserAnnexB::parseAndAddNALUnit Error parsing NAL %d", nalID);
       }
+      if (nrFramesBeforeLastRandomAccessPoint > 0 || frameList.size() > PARSER_ANNEXB_MAX_REORDERED_FRAMES)
+        firstFramesFound.wakeAll();
     }
     catch (const std::exception &exc)
     {
@@ -167,13 +270,12 @@ bool parserAnnexB::parseAnnexBFile(QScopedPointer<fileSourceAnnexBFile> &file, Q
     {
       // Updating the dialog (setValue) is quite slow. Only do this if the percent value changes.
       if (progressDialog->wasCanceled())
-        return false;
+        cancelBackgroundParser = true;
 
-      int newPercentValue = (int)((file->pos() - maxPos) * 100 / maxPos);
-      if (newPercentValue != curPercentValue)
+      if (progressPercentValue != curPercentValue)
       {
-        progressDialog->setValue(newPercentValue);
-        curPercentValue = newPercentValue;
+        progressDialog->setValue(progressPercentValue);
+        curPercentValue = progressPercentValue;
       }
     }
 
@@ -186,17 +288,89 @@ bool parserAnnexB::parseAnnexBFile(QScopedPointer<fileSourceAnnexBFile> &file, Q
     if (cancelBackgroundParser)
     {
       DEBUG_ANNEXB("parserAnnexB::parseAndAddNALUnit Abort parsing by user request.");
-      abortParsing = true;
+      return false;
     }
     if (parsingLimitEnabled && frameList.size() > PARSER_FILE_FRAME_NR_LIMIT)
     {
       DEBUG_ANNEXB("parserAnnexB::parseAndAddNALUnit Abort parsing because frame limit was reached.");
-      abortParsing = true;
+      return false;
     }
+    return true;
+  };
+
+  // Locating the NAL units (reading the file and searching for start codes) is done for multiple chunks of the file
+  // in parallel. Parsing the NAL units depends on the parameter sets (and other NAL units) before them. This is done
+  // here in order. Only a limited number of chunks is read ahead so that the memory usage is limited.
+  QThreadPool chunkPool;
+  chunkPool.setMaxThreadCount(std::max(QThread::idealThreadCount(), 1));
+  const int maxChunksInFlight = chunkPool.maxThreadCount() * 2;
+  const QString filePath = file->getAbsoluteFilePath();
+  QQueue<QFuture<annexBChunk>> chunkQueue;
+  int64_t nextChunkStart = 0;
+
+  // The last NAL unit of a chunk is not complete until the start code of the next NAL unit is found
+  QByteArray pendingNALData;
+  QUint64Pair pendingNALStartEndPos(-1, -1);
+  bool abortParsing = false;
+  while (!abortParsing)
+  {
+    while (chunkQueue.size() < maxChunksInFlight && nextChunkStart < maxPos)
+    {
+      const int64_t chunkEnd = std::min(nextChunkStart + PARSER_ANNEXB_CHUNK_SIZE, maxPos);
+      chunkQueue.enqueue(QtConcurrent::run(&chunkPool, findNALUnitsInChunk, filePath, nextChunkStart, chunkEnd));
+      nextChunkStart = chunkEnd;
+    }
+    if (chunkQueue.isEmpty())
+      break;
+
+    const annexBChunk chunk = chunkQueue.dequeue().result();
+    if (!chunk.ok)
+    {
+      DEBUG_ANNEXB("parserAnnexB::parseAnnexBFile Error reading from file.");
+      break;
+    }
+
+    if (pendingNALStartEndPos.first != uint64_t(-1))
+    {
+      pendingNALData += chunk.leadingData;
+      if (!chunk.nalStartPos.isEmpty())
+      {
+        // The pending NAL ends where the first NAL of this chunk starts (the start code may begin in the previous chunk)
+        pendingNALData.chop(int(std::min(uint64_t(pendingNALData.size()), pendingNALStartEndPos.first + pendingNALData.size() - chunk.nalStartPos.first())));
+        pendingNALStartEndPos.second = chunk.nalStartPos.first();
+        abortParsing = !parseNALUnit(pendingNALData, pendingNALStartEndPos);
+        pendingNALStartEndPos.first = uint64_t(-1);
+      }
+    }
+
+    for (int i = 0; i < chunk.nalStartPos.size() && !abortParsing; i++)
+    {
+      if (i + 1 < chunk.nalStartPos.size())
+        abortParsing = !parseNALUnit(chunk.nalData[i], QUint64Pair(chunk.nalStartPos[i], chunk.nalStartPos[i + 1]));
+      else
+      {
+        pendingNALData = chunk.nalData[i];
+        pendingNALStartEndPos = QUint64Pair(chunk.nalStartPos[i], -1);
+      }
+    }
+  }
+  if (!abortParsing && pendingNALStartEndPos.first != uint64_t(-1))
+  {
+    // The last NAL unit ends with the file
+    pendingNALStartEndPos.second = maxPos - 1;
+    parseNALUnit(pendingNALData, pendingNALStartEndPos);
   }
+  // Wait for all chunks that were read ahead
+  for (QFuture<annexBChunk> &f : chunkQueue)
+    f.waitForFinished();
 
   // We are done.
+  parsingMutex.lock();
   parseAndAddNALUnit(-1, QByteArray());
+  fileParsingRunning = false;
+  fileParsingDone = true;
+  firstFramesFound.wakeAll();
+  parsingMutex.unlock();
   DEBUG_ANNEXB("parserAnnexB::parseAndAddNALUnit Parsing done. Found %d POCs.", POCList.length());
 
   if (packetModel)
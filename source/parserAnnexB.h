@@ -35,6 +35,8 @@
 
 #include <QList>
 #include <QAbstractItemModel>
+#include <QMutex>
+#include <QWaitCondition>
 #include "videoHandlerYUV.h"
 #include "parserBase.h"
 #include "fileSourceAnnexBFile.h"
@@ -51,8 +53,13 @@ public:
   parserAnnexB(QObject *parent = nullptr) : parserBase(parent) {};
   virtual ~parserAnnexB() {};
 
-  // How many POC's have been found in the file
-  int getNumberPOCs() const { return frameList.size(); }
+  // How many POC's have been found in the file. While the file is parsed (parseAnnexBFile), only the frames that
+  // can not change their position in display order anymore are counted. This number grows while parsing.
+  int getNumberPOCs() const;
+  // Wait until parseAnnexBFile (which may run in another thread) found the first frames that can be decoded
+  // or until parsing of the file finished.
+  void waitForFirstFrames();
+  bool isFileParsingRunning() const;
 
   // Clear all knowledge about the bitstream.
   void clearData();
@@ -160,6 +167,18 @@ protected:
 
   int pocOfFirstRandomAccessFrame {-1};
 
+  // While parsing a file, the number of frames (in coding order) before the last random access point. All frames which
+  // are found after a random access point follow all these frames in display order.
+  int nrFramesBeforeLastRandomAccessPoint {0};
+
+  // The file can be parsed in a background thread while the results are already used for decoding. All functions that
+  // are used for decoding must lock this mutex when accessing the lists above. parseAnnexBFile locks it while
+  // parsing a NAL unit.
+  mutable QMutex parsingMutex;
+  QWaitCondition firstFramesFound;
+  bool fileParsingRunning {false};
+  bool fileParsingDone {false};
+
   // Save general information about the file here
   struct stream_info_type
   {
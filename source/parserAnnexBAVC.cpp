@@ -47,6 +47,7 @@ using namespace parserCommon;
 
 double parserAnnexBAVC::getFramerate() const
 {
+  QMutexLocker lock(&parsingMutex);
   // Find the first SPS and return the framerate (if signaled)
   for (auto nal : nalUnitList)
   {
@@ -66,6 +67,7 @@ double parserAnnexBAVC::getFramerate() const
 
 QSize parserAnnexBAVC::getSequenceSizeSamples() const
 {
+  QMutexLocker lock(&parsingMutex);
   // Find the first SPS and return the size
   for (auto nal : nalUnitList)
   {
@@ -93,6 +95,7 @@ QSize parserAnnexBAVC::getSequenceSizeSamples() const
 
 yuvPixelFormat parserAnnexBAVC::getPixelFormat() const
 {
+  QMutexLocker lock(&parsingMutex);
   // Get the subsampling and bit-depth from the sps
   int bitDepthY = -1;
   int bitDepthC = -1;
@@ -2121,6 +2124,7 @@ bool parserAnnexBAVC::user_data_sei::parse_internal(QByteArray &sliceHeaderData,
 
 QList<QByteArray> parserAnnexBAVC::getSeekFrameParamerSets(int iFrameNr, uint64_t &filePos)
 {
+  QMutexLocker lock(&parsingMutex);
   // Get the POC for the frame number
   int seekPOC = POCList[iFrameNr];
 
@@ -2173,6 +2177,7 @@ QList<QByteArray> parserAnnexBAVC::getSeekFrameParamerSets(int iFrameNr, uint64_
 
 QByteArray parserAnnexBAVC::getExtradata()
 {
+  QMutexLocker lock(&parsingMutex);
   // Convert the SPS and PPS that we found in the bitstream to the libavformat avcc format (see avc.c)
   QByteArray e;
   e += 1; /* version */
@@ -2244,6 +2249,7 @@ QByteArray parserAnnexBAVC::getExtradata()
 
 QPair<int,int> parserAnnexBAVC::getProfileLevel()
 {
+  QMutexLocker lock(&parsingMutex);
   for (auto nal : nalUnitList)
   {
     // This should be an hevc nal
@@ -2260,6 +2266,7 @@ QPair<int,int> parserAnnexBAVC::getProfileLevel()
 
 QPair<int,int> parserAnnexBAVC::getSampleAspectRatio()
 {
+  QMutexLocker lock(&parsingMutex);
   for (auto nal : nalUnitList)
   {
     // This should be an hevc nal
@@ -56,6 +56,7 @@ const QStringList parserAnnexBHEVC::nal_unit_type_toString = QStringList()
 
 double parserAnnexBHEVC::getFramerate() const
 {
+  QMutexLocker lock(&parsingMutex);
   // First try to get the framerate from the parameter sets themselves
   for (auto nal : nalUnitList)
   {
@@ -93,6 +94,7 @@ double parserAnnexBHEVC::getFramerate() const
 
 QSize parserAnnexBHEVC::getSequenceSizeSamples() const
 {
+  QMutexLocker lock(&parsingMutex);
   // Find the first SPS and return the size
   for (auto nal : nalUnitList)
   {
@@ -111,6 +113,7 @@ QSize parserAnnexBHEVC::getSequenceSizeSamples() const
 
 yuvPixelFormat parserAnnexBHEVC::getPixelFormat() const
 {
+  QMutexLocker lock(&parsingMutex);
   // Get the subsampling and bit-depth from the sps
   int bitDepthY = -1;
   int bitDepthC = -1;
@@ -152,6 +155,7 @@ yuvPixelFormat parserAnnexBHEVC::getPixelFormat() const
 
 QList<QByteArray> parserAnnexBHEVC::getSeekFrameParamerSets(int iFrameNr, uint64_t &filePos)
 {
+  QMutexLocker lock(&parsingMutex);
   // Get the POC for the frame number
   int seekPOC = POCList[iFrameNr];
 
@@ -213,6 +217,7 @@ QList<QByteArray> parserAnnexBHEVC::getSeekFrameParamerSets(int iFrameNr, uint64
 
 QByteArray parserAnnexBHEVC::getExtradata()
 {
+  QMutexLocker lock(&parsingMutex);
   // Just return the VPS, SPS and PPS in NAL unit format. From the format in the extradata, ffmpeg will detect that
   // the input file is in raw NAL unit format and accept AVPacets in NAL unit format.
   QByteArray ret;
@@ -262,6 +267,7 @@ QByteArray parserAnnexBHEVC::getExtradata()
 
 QPair<int,int> parserAnnexBHEVC::getProfileLevel()
 {
+  QMutexLocker lock(&parsingMutex);
   for (auto nal : nalUnitList)
   {
     // This should be an hevc nal
@@ -278,6 +284,7 @@ QPair<int,int> parserAnnexBHEVC::getProfileLevel()
 
 QPair<int,int> parserAnnexBHEVC::getSampleAspectRatio()
 {
+  QMutexLocker lock(&parsingMutex);
   for (auto nal : nalUnitList)
   {
     // This should be an hevc nal
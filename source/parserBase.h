@@ -57,6 +57,8 @@ public:
   QAbstractItemModel *getPacketItemModel() { return streamIndexFilter.data(); }
   
   void setNewNumberModelItems(unsigned int n) { packetModel->setNewNumberModelItems(n); }
+  // Show all items that were added to the model so far (e.g. if nobody received nalModelUpdated)
+  void updateNumberModelItems() { packetModel->setNewNumberModelItems(packetModel->getNumberFirstLevelChildren()); }
   void enableModel();
 
   // Get info about the stream organized in a tree
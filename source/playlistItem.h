@@ -188,6 +188,9 @@ public:
   virtual int getNumberCachedFrames() const { return 0; }
   // How many bytes will caching one frame use (in bytes)?
   virtual unsigned int getCachingFrameSize() const { return 0; }
+  // Items that keep their frames in a cache of their own (getCachingFrameSize() is 0) can only hold this many frames
+  // in that cache. The video cache will not schedule more frames than this. -1: No limit.
+  virtual int getCachingFrameLimit() const { return -1; }
   // Remove the frame with the given index from the cache.
   virtual void removeFrameFromCache(int idx) { Q_UNUSED(idx); }
   virtual void removeAllFramesFromCache() {};
@@ -35,6 +35,7 @@
 #include <QThread>
 #include <QInputDialog>
 #include <QPlainTextEdit>
+#include <QtConcurrent>
 
 #include <inttypes.h>
 
@@ -58,11 +59,15 @@
 #endif
 
 // When decoding, it can make sense to seek forward to another random access point.
-// However, for this we have to clear the decoder, seek the file and restart decoding. Internally,
-// the decoder might already have decoded the frame anyways so it makes no sense to seek but to just
-// keep on decoding normally (linearly). If the requested fram number is only is in the future
-// by lower than this threshold, we will not seek.
-#define FORWARD_SEEK_THRESHOLD 5
+// However, for this we have to clear the decoder, seek the file and restart decoding. Until the decoding and seeking
+// times were measured (see seekCostModel), a seek is assumed to cost as much as decoding this many frames.
+#define SEEK_COST_DEFAULT_OVERHEAD_FRAMES 5
+
+// The measured decoding and seeking times are averaged (exponential moving average with this weight for a new value)
+#define SEEK_COST_AVERAGING_WEIGHT 0.2
+
+// While an annexB file is parsed in the background, the frame limits are updated in this interval (in ms).
+#define BACKGROUND_PARSING_UPDATE_INTERVAL 500
 
 playlistItemCompressedVideo::playlistItemCompressedVideo(const QString &compressedFilePath, int displayComponent, inputFormat input, decoderEngine decoder)
   : playlistItemWithVideo(compressedFilePath, playlistItem_Indexed)
@@ -120,8 +125,12 @@ playlistItemCompressedVideo::playlistItemCompressedVideo(const QString &compress
       possibleDecoders.append(decoderEngineFFMpeg);
     }
 
+    // Parse the file in the background. Decoding can start as soon as the parameter sets and the first frames
+    // were found. The number of frames grows while the rest of the file is parsed.
     DEBUG_COMPRESSED("playlistItemCompressedVideo::playlistItemCompressedVideo Start parsing of file");
-    inputFileAnnexBParser->parseAnnexBFile(inputFileAnnexBLoading, mainWindow);
+    inputFileAnnexBParser->setParsingLimitEnabled(false);
+    backgroundParsingFuture = QtConcurrent::run(&backgroundParsingPool, inputFileAnnexBParser.data(), &parserAnnexB::runParsingOfFile, compressedFilePath);
+    inputFileAnnexBParser->waitForFirstFrames();
     
     // Get the frame size and the pixel format
     frameSize = inputFileAnnexBParser->getSequenceSizeSamples();
@@ -137,11 +146,25 @@ playlistItemCompressedVideo::playlistItemCompressedVideo(const QString &compress
     // Try ffmpeg to open the file
     DEBUG_COMPRESSED("playlistItemCompressedVideo::playlistItemCompressedVideo Open file using ffmpeg");
     inputFileFFmpegLoading.reset(new fileSourceFFmpegFile());
-    if (!inputFileFFmpegLoading->openFile(compressedFilePath, mainWindow))
+    if (!inputFileFFmpegLoading->openFile(compressedFilePath, mainWindow, nullptr, false))
     {
       setError("Error opening file using libavcodec.");
       return;
     }
+    if (!inputFileFFmpegLoading->readContainerIndex())
+    {
+      // Scan all packets in the background. Decoding can start as soon as the first keyframe was found.
+      DEBUG_COMPRESSED("playlistItemCompressedVideo::playlistItemCompressedVideo Start scanning of file");
+      inputFileFFmpegScanning.reset(new fileSourceFFmpegFile());
+      if (!inputFileFFmpegScanning->openFile(compressedFilePath, mainWindow, nullptr, false))
+      {
+        setError("Error opening file a second time using libavcodec for scanning.");
+        return;
+      }
+      backgroundParsingFuture = QtConcurrent::run(&backgroundParsingPool, inputFileFFmpegScanning.data(), &fileSourceFFmpegFile::runScanningOfFile);
+      inputFileFFmpegScanning->waitForFirstKeyFrame();
+      inputFileFFmpegLoading->copyFrameIndex(*inputFileFFmpegScanning);
+    }
     // Is this file RGB or YUV?
     rawFormat = inputFileFFmpegLoading->getRawFormat();
     DEBUG_COMPRESSED("playlistItemCompressedVideo::playlistItemCompressedVideo Raw format %s", rawFormat == raw_YUV ? "YUV" : rawFormat == raw_RGB ? "RGB" : "Unknown");
@@ -174,7 +197,7 @@ playlistItemCompressedVideo::playlistItemCompressedVideo(const QString &compress
     {
       // Open the file again for caching
       inputFileFFmpegCaching.reset(new fileSourceFFmpegFile());
-      if (!inputFileFFmpegCaching->openFile(compressedFilePath, mainWindow, inputFileFFmpegLoading.data()))
+      if (!inputFileFFmpegCaching->openFile(compressedFilePath, mainWindow, inputFileFFmpegLoading.data(), false))
       {
         setError("Error opening file a second time using libavcodec for caching.");
         return;
@@ -263,6 +286,11 @@ playlistItemCompressedVideo::playlistItemCompressedVideo(const QString &compress
   // Set the frame number limits
   startEndFrame = getStartEndFrameLimits();
   DEBUG_COMPRESSED("playlistItemCompressedVideo::playlistItemCompressedVideo Start end frame limits %d,%d", startEndFrame.first, startEndFrame.second);
+  if (isInputFormatTypeAnnexB() || inputFileFFmpegScanning)
+  {
+    backgroundParsingFrameLimit = startEndFrame.second;
+    backgroundParsingTimer.start(BACKGROUND_PARSING_UPDATE_INTERVAL, this);
+  }
   if (startEndFrame.second == -1)
     // No frames to decode
     return;
@@ -332,6 +360,57 @@ playlistItemCompressedVideo *playlistItemCompressedVideo::newPlaylistItemCompres
   return newFile;
 }
 
+playlistItemCompressedVideo::~playlistItemCompressedVideo()
+{
+  if (backgroundParsingFuture.isRunning())
+  {
+    // Abort parsing of the file and wait for the background thread
+    if (inputFileAnnexBParser)
+      inputFileAnnexBParser->setAbortParsing();
+    if (inputFileFFmpegScanning)
+      inputFileFFmpegScanning->setAbortScanning();
+    backgroundParsingFuture.waitForFinished();
+  }
+}
+
+void playlistItemCompressedVideo::timerEvent(QTimerEvent *event)
+{
+  if (event->timerId() != backgroundParsingTimer.timerId())
+    return playlistItemWithVideo::timerEvent(event);
+
+  // Once the future is finished, this is the last update
+  const bool parsingFinished = backgroundParsingFuture.isFinished();
+  if (parsingFinished)
+    backgroundParsingTimer.stop();
+
+  if (inputFileFFmpegScanning)
+  {
+    updateFFmpegFrameIndex();
+    if (parsingFinished)
+      inputFileFFmpegScanning.reset();
+  }
+
+  const int frameLimit = getStartEndFrameLimits().second;
+  if (frameLimit != backgroundParsingFrameLimit)
+  {
+    // More frames were found. If the end of the range was the last frame, it will be the new last frame.
+    indexRange range = startEndFrame;
+    if (range.second == backgroundParsingFrameLimit)
+      range.second = frameLimit;
+    backgroundParsingFrameLimit = frameLimit;
+    setStartEndFrame(range, false);
+    emit signalItemChanged(false, RECACHE_NONE);
+  }
+}
+
+void playlistItemCompressedVideo::updateFFmpegFrameIndex()
+{
+  // The caching source is read from the caching threads. copyFrameIndex locks the index while copying.
+  inputFileFFmpegLoading->copyFrameIndex(*inputFileFFmpegScanning);
+  if (inputFileFFmpegCaching)
+    inputFileFFmpegCaching->copyFrameIndex(*inputFileFFmpegScanning);
+}
+
 infoData playlistItemCompressedVideo::getInfo() const
 {
   infoData info("HEVC File Info");
@@ -354,6 +433,10 @@ infoData playlistItemCompressedVideo::getInfo() const
     QSize videoSize = video->getFrameSize();
     info.items.append(infoItem("Resolution", QString("%1x%2").arg(videoSize.width()).arg(videoSize.height()), "The video resolution in pixel (width x height)"));
     info.items.append(infoItem("Num POCs", QString::number(startEndFrame.second - startEndFrame.first + 1), "The number of pictures in the stream."));
+    if (backgroundParsingFuture.isRunning() && inputFileAnnexBParser)
+      info.items.append(infoItem("Parsing", QString("%1%").arg(inputFileAnnexBParser->getParsingProgressPercent()), "The file is parsed in the background. More pictures will become available."));
+    else if (backgroundParsingFuture.isRunning())
+      info.items.append(infoItem("Parsing", "Running", "The file is scanned in the background. More pictures will become available."));
     if (decodingEnabled)
     {
       QStringList l = loadingDecoder->getLibraryPaths();
@@ -366,6 +449,14 @@ infoData playlistItemCompressedVideo::getInfo() const
       info.items.append(infoItem("Decoder", loadingDecoder->getCodecName()));
       info.items.append(infoItem("Statistics", loadingDecoder->statisticsSupported() ? "Yes" : "No", "Is the decoder able to provide internals (statistics)?"));
       info.items.append(infoItem("Stat Parsing", loadingDecoder->statisticsEnabled() ? "Yes" : "No", "Are the statistics of the sequence currently extracted from the stream?"));
+      QMutexLocker lock(&seekCostMutex);
+      const seekCostModel &cost = seekCost[0];
+      if (cost.frameDecodeTimeMs >= 0)
+        info.items.append(infoItem("Decoding Time", QString("%1 ms/frame").arg(cost.frameDecodeTimeMs, 0, 'f', 1), "The measured average time for decoding one frame."));
+      if (cost.seekOverheadMs >= 0)
+        info.items.append(infoItem("Seek Time", QString("%1 ms").arg(cost.seekOverheadMs, 0, 'f', 1), "The measured average additional time that a seek costs (resetting the decoder and decoding until the first frame is output)."));
+      if (cost.lastCostForward > 0 || cost.lastCostSeek > 0)
+        info.items.append(infoItem("Last Seek Decision", QString("%1 (forward %2 ms, seek %3 ms)").arg(cost.lastDecisionSeek ? "Seek" : "Decode forward").arg(cost.lastCostForward, 0, 'f', 1).arg(cost.lastCostSeek, 0, 'f', 1), "When a frame after the current frame was requested, was it estimated to be faster to decode forward or to seek to a random access point?"));
     }
   }
   if (decoderEngineType == decoderEngineFFMpeg)
@@ -470,15 +561,24 @@ void playlistItemCompressedVideo::loadRawData(int frameIdxInternal, bool caching
     return;
   }
 
+  if (caching && loadingDecoder->statisticsEnabled() && !cachingDecoder->statisticsEnabled())
+  {
+    // Statistics were enabled. Also retrieve them in the caching decoder so that the statistics of all cached
+    // frames are kept as well. Force a seek so that the decoder is reset.
+    cachingDecoder->enableStatisticsRetrieval();
+    currentFrameIdx[1] = -1;
+  }
+
   // Get the right decoder
   decoderBase *dec = caching ? cachingDecoder.data() : loadingDecoder.data();
   int curFrameIdx = caching ? currentFrameIdx[1] : currentFrameIdx[0];
 
-  // Should we seek?
-  if (curFrameIdx == -1 || frameIdxInternal < curFrameIdx || frameIdxInternal > curFrameIdx + FORWARD_SEEK_THRESHOLD)
+  // Should we seek? If the next frame is requested, there is nothing to decide.
+  bool didSeek = false;
+  if (curFrameIdx == -1 || frameIdxInternal < curFrameIdx || frameIdxInternal > curFrameIdx + 1)
   {
     // Definitely seek when we have to go backwards
-    bool seek = (frameIdxInternal < curFrameIdx);
+    bool seek = (curFrameIdx == -1 || frameIdxInternal < curFrameIdx);
 
     // Get the closest possible seek position
     int seekToFrame = -1;
@@ -494,20 +594,31 @@ void playlistItemCompressedVideo::loadRawData(int frameIdxInternal, bool caching
         seekToDTS = inputFileFFmpegLoading->getClosestSeekableDTSBefore(frameIdxInternal, seekToFrame);
     }
 
-    if (curFrameIdx == -1 || seekToFrame > curFrameIdx + FORWARD_SEEK_THRESHOLD)
-    {
-      // A seek forward makes sense
-      seek = true;
-    }
+    if (!seek && seekToFrame > curFrameIdx + 1)
+      // Check if a seek forward is faster than decoding all frames up to the requested frame
+      seek = isSeekCheaper(caching, curFrameIdx, seekToFrame, frameIdxInternal);
 
     if (seek)
     {
       // Seek and update the frame counters. The seekToPosition function will update the currentFrameIdx[] indices
       readAnnexBFrameCounterCodingOrder = seekToAnnexBFrameCount;
       DEBUG_COMPRESSED("playlistItemCompressedVideo::loadYUVData seeking to frame %d PTS %d AnnexBCnt %d", seekToFrame, seekToDTS, readAnnexBFrameCounterCodingOrder);
+      QMutexLocker lock(&seekCostMutex);
+      seekCost[caching ? 1 : 0].timer.start();
+      seekCost[caching ? 1 : 0].measuringSeek = true;
+      lock.unlock();
       seekToPosition(seekToFrame, seekToDTS, caching);
+      didSeek = true;
     }
   }
+
+  // Measure the decoding times from here (after a seek, the timer was already started before the seek)
+  if (!didSeek)
+  {
+    QMutexLocker lock(&seekCostMutex);
+    seekCost[caching ? 1 : 0].timer.start();
+    seekCost[caching ? 1 : 0].measuringSeek = false;
+  }
   
   // Decode until we get the right frame from the deocder
   bool rightFrame = caching ? currentFrameIdx[1] == frameIdxInternal : currentFrameIdx[0] == frameIdxInternal;
@@ -585,11 +696,15 @@ void playlistItemCompressedVideo::loadRawData(int frameIdxInternal, bool caching
           currentFrameIdx[0]++;
 
         DEBUG_COMPRESSED("playlistItemCompressedVideo::loadYUVData decoded frame %d", caching ? currentFrameIdx[1] : currentFrameIdx[0]);
+        updateSeekCostModel(caching);
         rightFrame = caching ? currentFrameIdx[1] == frameIdxInternal : currentFrameIdx[0] == frameIdxInternal;
         if (rightFrame)
         {
           video->rawData = dec->getRawFrameData();
           video->rawData_frameIdx = frameIdxInternal;
+          if (dec->statisticsEnabled())
+            // Keep all statistics of the frame so that we don't have to decode it again to show them
+            statSource.addStatisticsToCache(frameIdxInternal, dec->getFrameStatistics());
         }
       }
     }
@@ -602,6 +717,12 @@ void playlistItemCompressedVideo::loadRawData(int frameIdxInternal, bool caching
     }
   }
 
+  // Don't measure the time until the next frame is requested
+  seekCostMutex.lock();
+  seekCost[caching ? 1 : 0].timer.invalidate();
+  seekCost[caching ? 1 : 0].measuringSeek = false;
+  seekCostMutex.unlock();
+
   if (decodingNotPossibleAfter >= 0 && frameIdxInternal >= decodingNotPossibleAfter)
   {
     // The specified frame (which is thoretically in the bitstream) can not be decoded.
@@ -625,6 +746,45 @@ void playlistItemCompressedVideo::loadRawData(int frameIdxInternal, bool caching
   }
 }
 
+bool playlistItemCompressedVideo::isSeekCheaper(bool caching, int curFrameIdx, int seekToFrame, int frameIdx)
+{
+  QMutexLocker lock(&seekCostMutex);
+  seekCostModel &cost = seekCost[caching ? 1 : 0];
+
+  // Before anything was measured, only the relation of the two times is important
+  const double frameTime = (cost.frameDecodeTimeMs > 0) ? cost.frameDecodeTimeMs : 1.0;
+  const double seekTime = (cost.seekOverheadMs >= 0) ? cost.seekOverheadMs : SEEK_COST_DEFAULT_OVERHEAD_FRAMES * frameTime;
+
+  // After a seek, the decoder outputs frame seekToFrame first
+  cost.lastCostForward = (frameIdx - curFrameIdx) * frameTime;
+  cost.lastCostSeek = seekTime + (frameIdx - seekToFrame + 1) * frameTime;
+  cost.lastDecisionSeek = cost.lastCostSeek < cost.lastCostForward;
+  DEBUG_COMPRESSED("playlistItemCompressedVideo::isSeekCheaper %s: forward %d->%d %f ms, seek to %d %f ms", cost.lastDecisionSeek ? "seek" : "forward", curFrameIdx, frameIdx, cost.lastCostForward, seekToFrame, cost.lastCostSeek);
+  return cost.lastDecisionSeek;
+}
+
+void playlistItemCompressedVideo::updateSeekCostModel(bool caching)
+{
+  QMutexLocker lock(&seekCostMutex);
+  seekCostModel &cost = seekCost[caching ? 1 : 0];
+  if (!cost.timer.isValid())
+    return;
+
+  const double elapsedMs = cost.timer.nsecsElapsed() / 1000000.0;
+  auto average = [](double &value, double newValue) {
+    value = (value < 0) ? newValue : value * (1 - SEEK_COST_AVERAGING_WEIGHT) + newValue * SEEK_COST_AVERAGING_WEIGHT;
+  };
+  if (cost.measuringSeek)
+  {
+    // This is the first frame after a seek. Everything except the decoding of this frame is the overhead of the seek.
+    average(cost.seekOverheadMs, std::max(elapsedMs - std::max(cost.frameDecodeTimeMs, 0.0), 0.0));
+    cost.measuringSeek = false;
+  }
+  else
+    average(cost.frameDecodeTimeMs, elapsedMs);
+  cost.timer.start();
+}
+
 void playlistItemCompressedVideo::seekToPosition(int seekToFrame, int seekToDTS, bool caching)
 {
   // Do the seek
@@ -736,6 +896,12 @@ bool playlistItemCompressedVideo::allocateDecoder(int displayComponent)
   loadingDecoder.reset();
   cachingDecoder.reset();
 
+  // The times measured for the old decoders are not valid anymore
+  seekCostMutex.lock();
+  seekCost[0] = seekCostModel();
+  seekCost[1] = seekCostModel();
+  seekCostMutex.unlock();
+
   if (decoderEngineType == decoderEngineLibde265)
   {
     DEBUG_COMPRESSED("playlistItemCompressedVideo::allocateDecoder Initializing interactive libde265 decoder");
@@ -937,7 +1103,9 @@ void playlistItemCompressedVideo::loadFrame(int frameIdx, bool playing, bool loa
     {
       // Load the requested current frame
       DEBUG_COMPRESSED("playlistItemCompressedVideo::loadFrame loading frame %d %s", frameIdxInternal, playing ? "(playing)" : "");
-      video->loadFrame(frameIdxInternal);
+      // If the raw values are not needed, the frame might be in the disk cache
+      if (loadRawdata || !video->loadFrameFromDiskCache(frameIdxInternal))
+        video->loadFrame(frameIdxInternal);
     }
     if (stateStat == LoadingNeeded)
     {
@@ -958,7 +1126,8 @@ void playlistItemCompressedVideo::loadFrame(int frameIdx, bool playing, bool loa
     {
       DEBUG_COMPRESSED("playlistItplaylistItemCompressedVideoemRawFile::loadFrame loading frame into double buffer %d %s", nextFrameIdx, playing ? "(playing)" : "");
       isFrameLoadingDoubleBuffer = true;
-      video->loadFrame(nextFrameIdx, true);
+      if (!video->loadFrameFromDiskCache(nextFrameIdx, true))
+        video->loadFrame(nextFrameIdx, true);
       isFrameLoadingDoubleBuffer = false;
       if (emitSignals)
         emit signalItemDoubleBufferLoaded();
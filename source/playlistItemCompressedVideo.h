@@ -33,6 +33,12 @@
 #ifndef PLAYLISTITEMCOMPRESSEDVIDEO_H
 #define PLAYLISTITEMCOMPRESSEDVIDEO_H
 
+#include <QBasicTimer>
+#include <QElapsedTimer>
+#include <QFuture>
+#include <QMutex>
+#include <QSharedPointer>
+#include <QThreadPool>
 #include "decoderBase.h"
 #include "fileSourceFFmpegFile.h"
 #include "parserAnnexB.h"
@@ -40,6 +46,7 @@
 #include "statisticHandler.h"
 #include "ui_playlistItemCompressedFile.h"
 
+class bitstreamAnalysisParser;
 class videoHandler;
 
 /* This playlist item encapsulates all compressed video sequences. 
@@ -59,6 +66,7 @@ public:
   * 'displayComponent' initializes the component to display (reconstruction/prediction/residual/trCoeff).
   */
   playlistItemCompressedVideo(const QString &fileName, int displayComponent=0, inputFormat input = inputInvalid, decoderEngine decoder = decoderEngineInvalid);
+  virtual ~playlistItemCompressedVideo();
 
   // Save the compressed file element to the given XML structure.
   virtual void savePlaylist(QDomElement &root, const QDir &playlistDir) const Q_DECL_OVERRIDE;
@@ -105,6 +113,11 @@ public:
   virtual int cachingThreadLimit() Q_DECL_OVERRIDE { return 1; }
 
   inputFormat getInputFormat() const { return inputFormatType; }
+
+  // The results of parsing the file in the bitstream analysis (BitstreamAnalysisWidget). They are kept with the item
+  // so that the file does not have to be parsed again if the item is analyzed again.
+  QSharedPointer<bitstreamAnalysisParser> getBitstreamAnalysisParser() const { return bitstreamAnalysis; }
+  void setBitstreamAnalysisParser(QSharedPointer<bitstreamAnalysisParser> p) { bitstreamAnalysis = p; }
   
 protected:
   // Override from playlistItemIndexed. The readerEngine can tell us how many frames there are in the sequence.
@@ -130,6 +143,16 @@ protected:
   QScopedPointer<fileSourceAnnexBFile> inputFileAnnexBLoading;
   QScopedPointer<fileSourceAnnexBFile> inputFileAnnexBCaching;
   QScopedPointer<parserAnnexB> inputFileAnnexBParser;
+  // The annexB file is parsed in the background. Decoding can start as soon as the first frames were found. While parsing
+  // is running, the timer is used to update the frame limits. Parsing runs in a pool of its own because it can take
+  // very long and the GUI waits for the first frames. In the global thread pool, it could wait behind other long tasks.
+  QThreadPool backgroundParsingPool;
+  QFuture<bool> backgroundParsingFuture;
+  QBasicTimer backgroundParsingTimer;
+
+  QSharedPointer<bitstreamAnalysisParser> bitstreamAnalysis;
+  int backgroundParsingFrameLimit {-1};
+  virtual void timerEvent(QTimerEvent *event) Q_DECL_OVERRIDE; // Overloaded from QObject. Called when the timer fires.
   // When reading annex B data using the fileSourceAnnexBFile::getFrameData function, we need to count how many frames we already read.
   int readAnnexBFrameCounterCodingOrder { -1 };
   
@@ -143,6 +166,11 @@ protected:
   // read the NAL units from the compressed file.
   QScopedPointer<fileSourceFFmpegFile> inputFileFFmpegLoading;
   QScopedPointer<fileSourceFFmpegFile> inputFileFFmpegCaching;
+  // If the container has no complete index, all packets have to be scanned to get the frame index. This is done in the
+  // background (like the annexB parsing) using a third instance. The frame index is copied to the other instances in
+  // the timer.
+  QScopedPointer<fileSourceFFmpegFile> inputFileFFmpegScanning;
+  void updateFFmpegFrameIndex();
   
   // Is the loadFrame function currently loading?
   bool isFrameLoading { false };
@@ -165,6 +193,27 @@ protected:
   // Seek the input file to the given position, reset the decoder and prepare it to start decoding from the given position.
   void seekToPosition(int seekToFrame, int seekToDTS, bool caching);
 
+  // When a frame after the current frame of the decoder is requested, we can either decode forward or seek to a random
+  // access point closer to the frame. The decision is based on the costs of both options. For this, the decoding time
+  // per frame and the overhead of a seek (resetting the decoder and filling it until the first frame is output) are
+  // measured while decoding (for the loading and the caching decoder [0/1] separately).
+  struct seekCostModel
+  {
+    double frameDecodeTimeMs {-1};
+    double seekOverheadMs {-1};
+    QElapsedTimer timer;            //< Runs while decoding in loadRawData
+    bool measuringSeek {false};     //< The next decoded frame is the first after a seek
+    // The last decision (for the info panel)
+    bool lastDecisionSeek {false};
+    double lastCostForward {0};
+    double lastCostSeek {0};
+  };
+  seekCostModel seekCost[2];
+  mutable QMutex seekCostMutex;
+  // Return true if seeking to seekToFrame is cheaper than decoding forward from curFrameIdx to frameIdx
+  bool isSeekCheaper(bool caching, int curFrameIdx, int seekToFrame, int frameIdx);
+  void updateSeekCostModel(bool caching);
+
   // For certain decoders (FFmpeg or HM), pushing data may fail. The decoder may or may not switch to retrieveing mode.
   // In this case, we must re-push the packet for which pushing failed.
   bool repushData {false};
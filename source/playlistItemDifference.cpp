@@ -56,6 +56,7 @@ playlistItemDifference::playlistItemDifference()
   frameLimitsMax = false;
   isDifferenceLoading = false;
   isDifferenceLoadingToDoubleBuffer = false;
+  cachingEnabled = true;
 
   // The text that is shown when no difference can be drawn
   infoText = DIFFERENCE_INFO_TEXT;
@@ -75,10 +76,7 @@ infoData playlistItemDifference::getInfo() const
   if (childCount() >= 2)
     info.items.append(infoItem(QString("File 2"), getChildPlaylistItem(1)->getName()));
 
-  // Report the position of the first difference in coding order
-  difference.reportFirstDifferencePosition(info.items);
-
-  // Report MSE
+  // Report the position of the first difference in coding order and the MSE
   for (int i = 0; i < difference.differenceInfoList.length(); i++)
   {
     infoItem p = difference.differenceInfoList[i];
@@ -241,7 +239,7 @@ void playlistItemDifference::loadFrame(int frameIdx, bool playing, bool loadRawD
       // Since every playlist item can have it's own relative indexing, we need two frame indices
       int idx0 = getChildPlaylistItem(0)->getFrameIdxInternal(nextFrameIdx);
       int idx1 = getChildPlaylistItem(1)->getFrameIdxInternal(nextFrameIdx);
-      difference.loadFrameDifference(frameIdxInternal, idx0, idx1, true);
+      difference.loadFrameDifference(nextFrameIdx, idx0, idx1, true);
       isDifferenceLoadingToDoubleBuffer = false;
       if (emitSignals)
         emit signalItemDoubleBufferLoaded();
@@ -249,10 +247,44 @@ void playlistItemDifference::loadFrame(int frameIdx, bool playing, bool loadRawD
   }
 }
 
+void playlistItemDifference::cacheFrame(int frameIdx, bool testMode)
+{
+  if (!cachingEnabled || childCount() != 2 || !difference.inputsValid())
+    return;
+
+  // Since every playlist item can have it's own relative indexing, we need two frame indices
+  const int frameIdxInternal = getFrameIdxInternal(frameIdx);
+  const int idx0 = getChildPlaylistItem(0)->getFrameIdxInternal(frameIdxInternal);
+  const int idx1 = getChildPlaylistItem(1)->getFrameIdxInternal(frameIdxInternal);
+  DEBUG_DIFF("playlistItemDifference::cacheFrame caching difference for frame %d", frameIdxInternal);
+  difference.cacheFrameDifference(frameIdxInternal, idx0, idx1, testMode);
+}
+
+QList<int> playlistItemDifference::getCachedFrames() const
+{
+  // Convert indices from internal to external indices
+  QList<int> retList;
+  for (int i : difference.getCachedFrames())
+    retList.append(getFrameIdxExternal(i));
+  return retList;
+}
+
+void playlistItemDifference::reloadItemSource()
+{
+  playlistItemContainer::reloadItemSource();
+  difference.invalidateInputs();
+  emit signalItemChanged(true, RECACHE_CLEAR);
+}
+
 void playlistItemDifference::childChanged(bool redraw, recacheIndicator recache)
 {
-  // One of the child items changed and needs to redraw. This means that the difference is out of date
-  // and has to be recalculated.
-  difference.invalidateAllBuffers();
+  // One of the child items changed so that it has to be recached. This means that the difference (and all
+  // cached differences) are out of date and have to be recalculated. If a child only needs a redraw (e.g. because
+  // it loaded a frame), the differences are still valid.
+  if (recache != RECACHE_NONE)
+  {
+    difference.invalidateInputs();
+    recache = RECACHE_CLEAR;
+  }
   playlistItemContainer::childChanged(redraw, recache);
 }
\ No newline at end of file
@@ -69,9 +69,25 @@ public:
   // Get the pixel values from A, B and the difference.
   virtual ValuePairListSets getPixelValues(const QPoint &pixelPos, int frameIdx) Q_DECL_OVERRIDE;
 
+  // Reload the child items. All calculated differences are invalid after this.
+  virtual void reloadItemSource() Q_DECL_OVERRIDE;
+
   // Return the frame handler pointer that draws the difference
   virtual frameHandler *getFrameHandler() Q_DECL_OVERRIDE { return &difference; }
 
+  // -- Caching
+  // The differences are calculated by the caching threads and kept in the cache of the difference video handler.
+  virtual bool isCachable() const Q_DECL_OVERRIDE { return playlistItem::isCachable() && childCount() == 2 && difference.inputsValid(); }
+  virtual void cacheFrame(int frameIdx, bool testMode) Q_DECL_OVERRIDE;
+  virtual QList<int> getCachedFrames() const Q_DECL_OVERRIDE;
+  virtual int getNumberCachedFrames() const Q_DECL_OVERRIDE { return difference.getNumberCachedFrames(); }
+  virtual unsigned int getCachingFrameSize() const Q_DECL_OVERRIDE { return difference.getCachingFrameSize(); }
+  virtual void removeFrameFromCache(int idx) Q_DECL_OVERRIDE { difference.removeFrameFromCache(getFrameIdxInternal(idx)); }
+  virtual void removeAllFramesFromCache() Q_DECL_OVERRIDE { difference.removeAllFrameFromCache(); }
+  // The frames of the inputs are requested through their caching path. For compressed inputs (which have one caching decoder)
+  // it is best if the frames are requested in order, so only one thread calculates differences at a time.
+  virtual int cachingThreadLimit() Q_DECL_OVERRIDE { return 1; }
+
 protected slots:
   virtual void childChanged(bool redraw, recacheIndicator recache) Q_DECL_OVERRIDE;
 
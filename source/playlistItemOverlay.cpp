@@ -49,6 +49,12 @@
 
 #define CUSTOM_POS_MAX 100000
 
+// The maximum size (in pixels) of the composite of all child items. Bigger overlays are always drawn item by item.
+#define OVERLAY_COMPOSITE_MAX_PIXELS (8192*8192)
+// The composite is only rendered for a frame that has already been shown for this long (in ms). During playback, a frame
+// is replaced before that, even if it is drawn more than once (by the split view or in the separate window).
+#define OVERLAY_COMPOSITE_MIN_SHOW_TIME_MS 250
+
 playlistItemOverlay::playlistItemOverlay() :
   playlistItemContainer("Overlay Item")
 {
@@ -161,9 +167,26 @@ void playlistItemOverlay::drawItem(QPainter *painter, int frameIdx, double zoomF
   // Update the layout if the number of items changedupdateLayout
   updateLayout();
 
+  if (!drawRawData && drawComposite(painter, frameIdx, zoomFactor))
+    return;
+
   // Translate to the center of this overlay item
   painter->translate(centerRoundTL(boundingRect) * zoomFactor * -1);
 
+  drawChildItems(painter, frameIdx, zoomFactor, drawRawData);
+
+  // Reverse translation to the center of this overlay item
+  painter->translate(centerRoundTL(boundingRect) * zoomFactor);
+
+  if (frameIdx != lastDrawnFrameIdx)
+  {
+    lastDrawnFrameIdx = frameIdx;
+    lastDrawnFrameTimer.start();
+  }
+}
+
+void playlistItemOverlay::drawChildItems(QPainter *painter, int frameIdx, double zoomFactor, bool drawRawData)
+{
   // Draw all child items at their positions
   for (int i = 0; i < childCount(); i++)
   {
@@ -176,9 +199,47 @@ void playlistItemOverlay::drawItem(QPainter *painter, int frameIdx, double zoomF
       painter->translate(center * zoomFactor * -1);
     }
   }
+}
 
-  // Reverse translation to the center of this overlay item
-  painter->translate(centerRoundTL(boundingRect) * zoomFactor);
+bool playlistItemOverlay::drawComposite(QPainter *painter, int frameIdx, double zoomFactor)
+{
+  // The composite is only used if we are zoomed out. Then all children are visible and have to be scaled down.
+  // If we zoom in, only the visible parts of the children are drawn and the children may draw details that
+  // depend on the zoom factor (e.g. statistics).
+  if (zoomFactor > 1.0)
+    return false;
+
+  if (frameIdx != compositeFrameIdx)
+  {
+    // During playback, every frame is only shown briefly (but may be drawn by several views right after each other).
+    // Rendering the composite would only cost time there. So the composite is only rendered if a frame that has been
+    // shown for a while is drawn again.
+    if (frameIdx != lastDrawnFrameIdx || !lastDrawnFrameTimer.isValid() || lastDrawnFrameTimer.elapsed() < OVERLAY_COMPOSITE_MIN_SHOW_TIME_MS)
+      return false;
+
+    const int64_t nrPixels = int64_t(boundingRect.width()) * boundingRect.height();
+    if (nrPixels == 0 || nrPixels > OVERLAY_COMPOSITE_MAX_PIXELS)
+      return false;
+
+    // All children must have loaded the frame. Otherwise the composite would show the previous frame of some children.
+    if (needsLoading(frameIdx, false) == LoadingNeeded || isLoading())
+      return false;
+
+    DEBUG_OVERLAY("playlistItemOverlay::drawComposite rendering composite for frame %d", frameIdx);
+    compositeImage = QImage(boundingRect.size(), QImage::Format_ARGB32_Premultiplied);
+    compositeImage.fill(Qt::transparent);
+    QPainter compositePainter(&compositeImage);
+    compositePainter.setRenderHints(painter->renderHints());
+    compositePainter.translate(-boundingRect.topLeft());
+    drawChildItems(&compositePainter, frameIdx, 1.0, false);
+    compositePainter.end();
+    compositeFrameIdx = frameIdx;
+  }
+
+  // The composite is drawn at the position of the bounding rect relative to the center of this overlay item
+  QRectF compositeRect(QPointF(boundingRect.topLeft() - centerRoundTL(boundingRect)) * zoomFactor, QSizeF(boundingRect.size()) * zoomFactor);
+  painter->drawImage(compositeRect, compositeImage);
+  return true;
 }
 
 QSize playlistItemOverlay::getSize() const
@@ -196,6 +257,7 @@ void playlistItemOverlay::updateLayout(bool onlyIfItemsChanged)
     childItemRects.clear();
     childItemsIDs.clear();
     boundingRect = QRect();
+    invalidateComposite();
     return;
   }
 
@@ -220,6 +282,9 @@ void playlistItemOverlay::updateLayout(bool onlyIfItemsChanged)
 
   DEBUG_OVERLAY("playlistItemOverlay::updateLayout%s", onlyIfNrItemsChanged ? " onlyIfNrItemsChanged" : "");
 
+  // The composite of the child items must be rendered again
+  invalidateComposite();
+
   if (nrItemsChanged || itemOrderChanged)
   {
     // Resize the childItems/IDs list
@@ -524,6 +589,8 @@ void playlistItemOverlay::childChanged(bool redraw, recacheIndicator recache)
 {
   if (redraw)
     updateLayout(false);
+  else if (recache != RECACHE_NONE)
+    invalidateComposite();
 
   playlistItemContainer::childChanged(redraw, recache);
 }
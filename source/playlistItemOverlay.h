@@ -37,6 +37,7 @@
 #include "typedef.h"
 #include "ui_playlistItemOverlay.h"
 
+#include <QElapsedTimer>
 #include <QGridLayout>
 
 class playlistItemOverlay : public playlistItemContainer
@@ -101,6 +102,20 @@ private:
   // will be updated only if the number or oder of items changed.
   void updateLayout(bool onlyIfItemsChanged=true);
 
+  // Draw all child items at their positions (childItemRects). The painter must be translated to the center of this item.
+  void drawChildItems(QPainter *painter, int frameIdx, double zoomFactor, bool drawRawData);
+
+  // The composite of all child items for the frame compositeFrameIdx (rendered at native resolution). If the same frame
+  // is drawn again after it was shown for a while (e.g. when panning or zooming out), the composite is drawn instead of
+  // drawing and scaling all children. lastDrawnFrameTimer measures how long lastDrawnFrameIdx has been shown.
+  // Return false if the composite can not be used and the children have to be drawn.
+  bool drawComposite(QPainter *painter, int frameIdx, double zoomFactor);
+  void invalidateComposite() { compositeImage = QImage(); compositeFrameIdx = -1; lastDrawnFrameIdx = -1; }
+  QImage compositeImage;
+  int compositeFrameIdx {-1};
+  int lastDrawnFrameIdx {-1};
+  QElapsedTimer lastDrawnFrameTimer;
+
   // The grid layout that contains all the custom positions
   QGridLayout *customPositionGrid = nullptr;
   void updateCustomPositionGrid();
@@ -32,8 +32,11 @@
 
 #include "playlistItemRawFile.h"
 
+#include <algorithm>
 #include <QFileInfo>
 #include <QPainter>
+#include <QSettings>
+#include <QtConcurrent>
 #include <QUrl>
 #include <QVBoxLayout>
 
@@ -47,6 +50,19 @@ using namespace YUV_Internals;
 #define DEBUG_RAWFILE(fmt,...) ((void)0)
 #endif
 
+// When frames are loaded in sequential order (forward or backward), we request this many of the
+// following frames to be read into the file system cache in the background.
+#define RAWFILE_READAHEAD_NR_FRAMES 4
+
+// If the frames of a y4m file have no parameters, the frame offsets are calculated. This many frame headers
+// (evenly distributed over the file) are checked to verify this.
+#define RAWFILE_Y4M_NR_VERIFIED_FRAMES 32
+
+// The number of bytes that are read from the start of the file to guess the format from the correlation
+#define RAWFILE_FORMAT_DETECTION_NR_BYTES 24883200
+// For this many files, the format that was guessed from the correlation is remembered in the settings
+#define RAWFILE_MAX_REMEMBERED_FORMATS 100
+
 playlistItemRawFile::playlistItemRawFile(const QString &rawFilePath, const QSize &frameSize, const QString &sourcePixelFormat, const QString &fmt)
   : playlistItemWithVideo(rawFilePath, playlistItem_Indexed)
 {
@@ -54,6 +70,9 @@ playlistItemRawFile::playlistItemRawFile(const QString &rawFilePath, const QSize
   // Set the Qt::AA_UseHighDpiPixmaps attribute and then just use QIcon(":image.png")
   // If there is also a image@2x.png in the qrc, Qt will use this for high DPI
   isY4MFile = false;
+  lastLoadedFrameIdx = -1;
+  readAheadDirection = 0;
+  formatDetected = false;
 
   // Set the properties of the playlistItem
   setIcon(0, convertIcon(":img_video.png"));
@@ -97,11 +116,17 @@ playlistItemRawFile::playlistItemRawFile(const QString &rawFilePath, const QSize
     // Try to get the frame format from the file name. The fileSource can guess this.
     setFormatFromFileName();
 
-    if (!video->isFormatValid())
+    if (!video->isFormatValid() && rawFormat == raw_YUV)
     {
-      // Load 24883200 bytes from the input and try to get the format from the correlation.
+      // Maybe we already guessed the format of this file before. If not, guess it in the background.
+      if (!loadRememberedFormat())
+        startFormatDetection();
+    }
+    else if (!video->isFormatValid())
+    {
+      // Load some bytes from the input and try to get the format from the correlation.
       QByteArray rawData;
-      dataSource.readBytes(rawData, 0, 24883200);
+      dataSource.readBytes(rawData, 0, RAWFILE_FORMAT_DETECTION_NR_BYTES);
       video->setFormatFromCorrelation(rawData, dataSource.getFileSize());
     }
   }
@@ -117,6 +142,9 @@ playlistItemRawFile::playlistItemRawFile(const QString &rawFilePath, const QSize
 
   if (video->isFormatValid())
     startEndFrame = getStartEndFrameLimits();
+  if (y4mIndexingTimer.isActive())
+    // The end frame is extended while the frames are indexed (see timerEvent)
+    y4mIndexingFrameLimit = startEndFrame.second;
 
   // If the videHandler requests raw data, we provide it from the file
   connect(video.data(), &videoHandler::signalRequestRawData, this, &playlistItemRawFile::loadRawData, Qt::DirectConnection);
@@ -129,6 +157,17 @@ playlistItemRawFile::playlistItemRawFile(const QString &rawFilePath, const QSize
   cachingEnabled = true;
 }
 
+playlistItemRawFile::~playlistItemRawFile()
+{
+  // The background format detection works on the file. Wait for it to finish.
+  if (formatDetectionFuture.isRunning())
+    formatDetectionFuture.waitForFinished();
+  // Abort the indexing of the y4m frames
+  y4mIndexingAbort.store(1);
+  if (y4mIndexingFuture.isRunning())
+    y4mIndexingFuture.waitForFinished();
+}
+
 int64_t playlistItemRawFile::getNumberFrames() const
 {
   if (!dataSource.isOk() || !video->isFormatValid())
@@ -138,7 +177,12 @@ int64_t playlistItemRawFile::getNumberFrames() const
   }
 
   if (isY4MFile)
+  {
+    if (y4mFrameStride > 0)
+      return (dataSource.getFileSize() - y4mFirstFrameOffset) / y4mFrameStride;
+    QMutexLocker lock(&y4mFrameIndicesMutex);
     return y4mFrameIndices.count();
+  }
 
   // The file was opened successfully
   int64_t bpf = getBytesPerFrame();
@@ -152,6 +196,11 @@ infoData playlistItemRawFile::getInfo() const
   // At first append the file information part (path, date created, file size...)
   info.items.append(dataSource.getFileInfoList());
 
+  if (formatDetectionFuture.isRunning())
+    info.items.append(infoItem("Format", "Detecting format..."));
+  if (y4mIndexingFuture.isRunning())
+    info.items.append(infoItem("Y4M", "Indexing frames..."));
+
   info.items.append(infoItem("Num Frames", QString::number(getNumberFrames())));
   info.items.append(infoItem("Bytes per Frame", QString("%1").arg(getBytesPerFrame())));
 
@@ -311,16 +360,70 @@ bool playlistItemRawFile::parseY4MFile()
     stride = width * height * 3;
   if (format.bitsPerSample > 8)
     stride *= 2;
-  
-  while (true)
+
+  if (dataSource.readBytes(rawData, offset, 5) < 5 || rawData.left(5) != "FRAME")
+    return setError("Error parsing the Y4M header: Could not locate the first 'FRAME' indicator.");
+
+  // Success. Set the format.
+  video->setFrameSize(QSize(width, height));
+  getYUVVideo()->setYUVPixelFormat(format);
+
+  // In most files, the frames have no parameters. Then all frames have the same size and we can calculate the offsets.
+  y4mFirstFrameOffset = offset;
+  if (verifyY4MConstantFrameSize(6 + stride))
+  {
+    y4mFrameStride = 6 + stride;
+    return true;
+  }
+
+  // The frames must be indexed. This is done in the background so that the file can already be used.
+  // The number of frames grows while indexing.
+  y4mIndexingFuture = QtConcurrent::run(&y4mIndexingPool, this, &playlistItemRawFile::indexY4MFrames, offset, int64_t(stride));
+  y4mIndexingTimer.start(200, this);
+  return true;
+}
+
+bool playlistItemRawFile::verifyY4MConstantFrameSize(int64_t frameStride)
+{
+  // All frames must have the same size ("FRAME" + 0x0A + the YUV data) ...
+  const int64_t framesSize = dataSource.getFileSize() - y4mFirstFrameOffset;
+  if (framesSize % frameStride != 0)
+    return false;
+
+  // ... and a sample of the frame headers must have no parameters.
+  const int64_t nrFrames = framesSize / frameStride;
+  const int64_t nrChecks = std::min(nrFrames, int64_t(RAWFILE_Y4M_NR_VERIFIED_FRAMES));
+  QByteArray frameHeader;
+  for (int64_t i = 0; i < nrChecks; i++)
+  {
+    const int64_t frameIdx = (nrChecks == 1) ? 0 : i * (nrFrames - 1) / (nrChecks - 1);
+    if (dataSource.readBytes(frameHeader, y4mFirstFrameOffset + frameIdx * frameStride, 6) < 6 || frameHeader != "FRAME\n")
+      return false;
+  }
+
+  DEBUG_RAWFILE("playlistItemRawFile::verifyY4MConstantFrameSize %d frames of constant size", (int)nrFrames);
+  return true;
+}
+
+void playlistItemRawFile::indexY4MFrames(int64_t offset, int64_t stride)
+{
+  // This runs in a background thread. The data source can be read from multiple threads.
+  QByteArray rawData;
+  while (!y4mIndexingAbort.load())
   {
     // Seek the file to 'offset' and read a few bytes
     if (dataSource.readBytes(rawData, offset, 20) < 20)
-      return setError("Error parsing the Y4M header: The file ended unexpectedly.");
+    {
+      DEBUG_RAWFILE("playlistItemRawFile::indexY4MFrames The file ended unexpectedly.");
+      return;
+    }
 
     QByteArray frameIndicator = rawData.mid(0, 5);
     if (frameIndicator != "FRAME")
-      return setError("Error parsing the Y4M header: Could not locate the next 'FRAME' indicator.");
+    {
+      DEBUG_RAWFILE("playlistItemRawFile::indexY4MFrames Could not locate the next 'FRAME' indicator.");
+      return;
+    }
 
     // We will now ignore all frame parameters by searching for the next 0x0A byte. I don't know what
     // we could do with these parameters. 
@@ -337,20 +440,140 @@ bool playlistItemRawFile::parseY4MFile()
     internalOffset++;
 
     if (internalOffset == 19)
-      return setError("Error parsing the Y4M header: The file ended unexpectedly.");
+    {
+      DEBUG_RAWFILE("playlistItemRawFile::indexY4MFrames The file ended unexpectedly.");
+      return;
+    }
 
     // Add the frame offset value
+    QMutexLocker lock(&y4mFrameIndicesMutex);
     y4mFrameIndices.append(offset);
+    lock.unlock();
 
     offset += stride;
     if (offset >= dataSource.getFileSize())
       break;
   }
+}
 
-  // Success. Set the format and return true;
-  video->setFrameSize(QSize(width, height));
-  getYUVVideo()->setYUVPixelFormat(format);
-  return true;
+void playlistItemRawFile::startFormatDetection()
+{
+  DEBUG_RAWFILE("playlistItemRawFile::startFormatDetection");
+  formatDetected = false;
+  formatDetectionTimer.start(100, this);
+  formatDetectionFuture = QtConcurrent::run(this, &playlistItemRawFile::formatDetectionFunction);
+}
+
+void playlistItemRawFile::formatDetectionFunction()
+{
+  // This runs in a background thread. Only the data source and the detection results may be accessed here.
+  // The data source is not used by anyone else until the format is known.
+  QByteArray rawData;
+  dataSource.readBytes(rawData, 0, RAWFILE_FORMAT_DETECTION_NR_BYTES);
+  formatDetected = videoHandlerYUV::getFormatFromCorrelation(rawData, dataSource.getFileSize(), detectedFrameSize, detectedFormat);
+}
+
+void playlistItemRawFile::timerEvent(QTimerEvent *event)
+{
+  if (event->timerId() == y4mIndexingTimer.timerId())
+  {
+    // Once the indexing is finished, this is the last update
+    if (y4mIndexingFuture.isFinished())
+      y4mIndexingTimer.stop();
+
+    const int frameLimit = getStartEndFrameLimits().second;
+    if (frameLimit != y4mIndexingFrameLimit)
+    {
+      // More frames were found. If the end of the range was the last frame, it will be the new last frame.
+      indexRange range = startEndFrame;
+      if (range.second == y4mIndexingFrameLimit)
+        range.second = frameLimit;
+      y4mIndexingFrameLimit = frameLimit;
+      setStartEndFrame(range, false);
+      emit signalItemChanged(false, RECACHE_NONE);
+    }
+    return;
+  }
+
+  if (event->timerId() != formatDetectionTimer.timerId())
+    return playlistItemWithVideo::timerEvent(event);
+
+  if (!formatDetectionFuture.isRunning())
+  {
+    formatDetectionTimer.stop();
+    formatDetectionFinished();
+  }
+}
+
+void playlistItemRawFile::formatDetectionFinished()
+{
+  DEBUG_RAWFILE("playlistItemRawFile::formatDetectionFinished %s", formatDetected ? "found" : "not found");
+
+  // If the user set a valid format in the meantime, we keep it.
+  if (!formatDetected || video->isFormatValid())
+  {
+    // Just update the info
+    emit signalItemChanged(false, RECACHE_NONE);
+    return;
+  }
+
+  getYUVVideo()->setYUVPixelFormat(detectedFormat);
+  video->setFrameSize(detectedFrameSize);
+  saveRememberedFormat();
+
+  // Update the frame range (and the controls) and redraw the item with the new format.
+  setStartEndFrame(getStartEndFrameLimits(), false);
+  emit signalItemChanged(true, RECACHE_CLEAR);
+}
+
+QString playlistItemRawFile::getFormatDetectionFileKey() const
+{
+  // Identify the file by the path, size and modification date. If the file changes, the remembered format is not used.
+  const QFileInfo fileInfo = dataSource.getFileInfo();
+  return QString("%1|%2|%3").arg(fileInfo.absoluteFilePath()).arg(fileInfo.size()).arg(fileInfo.lastModified().toMSecsSinceEpoch());
+}
+
+bool playlistItemRawFile::loadRememberedFormat()
+{
+  QSettings settings;
+  const QStringList formatList = settings.value("RawFile/detectedFormats").toStringList();
+  const QString key = getFormatDetectionFileKey() + "|";
+  for (const QString &entry : formatList)
+  {
+    // Each entry is "key|width|height|formatName"
+    if (!entry.startsWith(key))
+      continue;
+    const QStringList values = entry.mid(key.length()).split("|");
+    if (values.count() != 3)
+      return false;
+    const QSize frameSize(values[0].toInt(), values[1].toInt());
+    const yuvPixelFormat format(values[2]);
+    if (!frameSize.isValid() || !format.isValid())
+      return false;
+
+    DEBUG_RAWFILE("playlistItemRawFile::loadRememberedFormat %dx%d %s", frameSize.width(), frameSize.height(), values[2].toLatin1().data());
+    getYUVVideo()->setYUVPixelFormat(format);
+    video->setFrameSize(frameSize);
+    return true;
+  }
+  return false;
+}
+
+void playlistItemRawFile::saveRememberedFormat() const
+{
+  QSettings settings;
+  QStringList formatList = settings.value("RawFile/detectedFormats").toStringList();
+  const QString key = getFormatDetectionFileKey() + "|";
+
+  // Remove an old entry for this file and add the new one at the front. Only keep the most recent entries.
+  for (int i = formatList.count() - 1; i >= 0; i--)
+    if (formatList[i].startsWith(key))
+      formatList.removeAt(i);
+  const QString entry = QString("%1|%2|%3").arg(detectedFrameSize.width()).arg(detectedFrameSize.height()).arg(detectedFormat.getName());
+  formatList.prepend(key + entry);
+  while (formatList.count() > RAWFILE_MAX_REMEMBERED_FORMATS)
+    formatList.removeLast();
+  settings.setValue("RawFile/detectedFormats", formatList);
 }
 
 void playlistItemRawFile::setFormatFromFileName()
@@ -462,20 +685,59 @@ void playlistItemRawFile::loadRawData(int frameIdxInternal)
   DEBUG_RAWFILE("playlistItemRawFile::loadRawData %d", frameIdx);
 
   // Load the raw data for the given frameIdx from file and set it in the video
-  int64_t fileStartPos;
-  if (isY4MFile)
-    fileStartPos = y4mFrameIndices.at(frameIdxInternal);
-  else
-    fileStartPos = frameIdxInternal * getBytesPerFrame();
+  int64_t fileStartPos = getFrameStartPos(frameIdxInternal);
   int64_t nrBytes = getBytesPerFrame();
 
   if (dataSource.readBytes(video->rawData, fileStartPos, nrBytes) < nrBytes)
     return; // Error
   video->rawData_frameIdx = frameIdxInternal;
 
+  // While the data of this frame is converted, the next frames can already be read in the background.
+  readAheadFrames(frameIdxInternal);
+
   DEBUG_RAWFILE("playlistItemRawFile::loadRawData %d Done", frameIdxInternal);
 }
 
+int64_t playlistItemRawFile::getFrameStartPos(int frameIdxInternal) const
+{
+  if (isY4MFile)
+  {
+    if (y4mFrameStride > 0)
+      // Skip the frame header ("FRAME" + 0x0A)
+      return y4mFirstFrameOffset + frameIdxInternal * y4mFrameStride + 6;
+    QMutexLocker lock(&y4mFrameIndicesMutex);
+    return y4mFrameIndices.at(frameIdxInternal);
+  }
+  return frameIdxInternal * getBytesPerFrame();
+}
+
+void playlistItemRawFile::readAheadFrames(int frameIdxInternal)
+{
+  // This is called from loadRawData which is protected by the requestDataMutex of the video handler.
+  const int direction = frameIdxInternal - lastLoadedFrameIdx;
+  lastLoadedFrameIdx = frameIdxInternal;
+  if (direction != 1 && direction != -1)
+  {
+    // Random access. We can not predict which frame will be requested next.
+    readAheadDirection = 0;
+    return;
+  }
+
+  // If we keep on going in the same direction, all frames up to the end of the window were
+  // already requested before. Only the frame that just entered the window has to be requested.
+  const int firstFrameOffset = (direction == readAheadDirection) ? RAWFILE_READAHEAD_NR_FRAMES : 1;
+  readAheadDirection = direction;
+
+  const int64_t nrFrames = getNumberFrames();
+  for (int i = firstFrameOffset; i <= RAWFILE_READAHEAD_NR_FRAMES; i++)
+  {
+    const int idx = frameIdxInternal + direction * i;
+    if (idx < 0 || idx >= nrFrames)
+      break;
+    dataSource.readAhead(getFrameStartPos(idx), getBytesPerFrame());
+  }
+}
+
 ValuePairListSets playlistItemRawFile::getPixelValues(const QPoint &pixelPos, int frameIdx)
 {
   const int frameIdxInternal = getFrameIdxInternal(frameIdx);
@@ -501,12 +763,20 @@ void playlistItemRawFile::getSupportedFileExtensions(QStringList &allExtensions,
 
 void playlistItemRawFile::reloadItemSource()
 {
+  // The background format detection and the y4m indexing read from the file
+  if (formatDetectionFuture.isRunning())
+    formatDetectionFuture.waitForFinished();
+  if (y4mIndexingFuture.isRunning())
+    y4mIndexingFuture.waitForFinished();
+
   // Reopen the file
   dataSource.openFile(plItemNameOrFileName);
   if (!dataSource.isOk())
     // Opening the file failed.
     return;
 
+  lastLoadedFrameIdx = -1;
+  readAheadDirection = 0;
   video->invalidateAllBuffers();
 
   // Emit that the item needs redrawing and the cache changed.
@@ -33,8 +33,12 @@
 #ifndef PLAYLISTITEMRAWFILE_H
 #define PLAYLISTITEMRAWFILE_H
 
+#include <QAtomicInt>
+#include <QBasicTimer>
 #include <QFuture>
+#include <QMutex>
 #include <QString>
+#include <QThreadPool>
 #include "fileSource.h"
 #include "playlistItemWithVideo.h"
 #include "typedef.h"
@@ -48,6 +52,7 @@ public:
   // extensions (getSupportedFileExtensions), set the format "fmt" to either "rgb" or "yuv". If you already know the frame size and/or 
   // sourcePixelFormat, you can set them as well.
   playlistItemRawFile(const QString &rawFilePath, const QSize &frameSize=QSize(-1,-1), const QString &sourcePixelFormat=QString(), const QString &fmt=QString());
+  virtual ~playlistItemRawFile();
 
   // Overload from playlistItem. Save the raw file item to playlist.
   virtual void savePlaylist(QDomElement &root, const QDir &playlistDir) const Q_DECL_OVERRIDE;
@@ -101,12 +106,53 @@ private:
 
   int64_t getBytesPerFrame() const { return video->getBytesPerFrame(); }
 
+  // Get the byte position of the given frame in the file
+  int64_t getFrameStartPos(int frameIdxInternal) const;
+
+  // Detect the direction in which frames are requested (playback forward or backward) and give the file
+  // source a hint to read the next frames in that direction into the file system cache.
+  void readAheadFrames(int frameIdxInternal);
+  int lastLoadedFrameIdx;
+  int readAheadDirection;
+
   // A y4m file is a raw YUV file but it adds a header (which has information about the YUV format)
-  // and start indicators for every frame. This file will parse the header and save all the byte
-  // offsets for each raw YUV frame.
+  // and start indicators for every frame. This file will parse the header. If all frames have the same
+  // size (no frame parameters), the byte offset of each raw YUV frame is calculated (y4mFrameStride).
+  // Otherwise, the offsets of all frames are saved in y4mFrameIndices. This is done in a background thread.
   bool parseY4MFile();
+  bool verifyY4MConstantFrameSize(int64_t frameStride);
   bool isY4MFile;
+  int64_t y4mFirstFrameOffset {0};
+  int64_t y4mFrameStride {0};
+  void indexY4MFrames(int64_t offset, int64_t stride);
   QList<uint64_t> y4mFrameIndices;
+  mutable QMutex y4mFrameIndicesMutex;
+  // Indexing reads the entire file so it runs in a pool of its own (and not in the global thread pool)
+  QThreadPool y4mIndexingPool;
+  QFuture<void> y4mIndexingFuture;
+  QAtomicInt y4mIndexingAbort;
+  // While indexing, the timer is used to update the frame limits.
+  QBasicTimer y4mIndexingTimer;
+  int y4mIndexingFrameLimit {-1};
+
+  // If the format can not be guessed from the file name, it is guessed from the correlation of the first frames.
+  // This is done in a background thread. The result is remembered in the settings for the file so that the next
+  // time the file is opened, the format is known immediately.
+  void startFormatDetection();
+  void formatDetectionFunction();
+  void formatDetectionFinished();
+  QFuture<void> formatDetectionFuture;
+  bool formatDetected;
+  QSize detectedFrameSize;
+  YUV_Internals::yuvPixelFormat detectedFormat;
+  // A timer is used to check if the background format detection finished
+  QBasicTimer formatDetectionTimer;
+  virtual void timerEvent(QTimerEvent *event) Q_DECL_OVERRIDE; // Overloaded from QObject. Called when the timer fires.
+
+  // Get/set the format that was detected for this file in the past (from the settings).
+  QString getFormatDetectionFileKey() const;
+  bool loadRememberedFormat();
+  void saveRememberedFormat() const;
 };
 
 #endif // PLAYLISTITEMRAWFILE_H
@@ -33,18 +33,14 @@
 #include "playlistItemStatisticsCSVFile.h"
 
 #include <cassert>
+#include <cstring>
 #include <iostream>
 #include <QDebug>
+#include <QMutexLocker>
 #include <QtConcurrent>
 #include <QTime>
 #include "statisticsExtensions.h"
 
-// The internal buffer for parsing the starting positions. The buffer must not be larger than 2GB
-// so that we can address all the positions in it with int (using such a large buffer is not a good
-// idea anyways)
-#define STAT_PARSING_BUFFER_SIZE 1048576
-#define STAT_MAX_STRING_SIZE 1<<28
-
 playlistItemStatisticsCSVFile::playlistItemStatisticsCSVFile(const QString &itemNameOrFileName)
   : playlistItemStatisticsFile(itemNameOrFileName)
 {
@@ -58,17 +54,76 @@ playlistItemStatisticsCSVFile::playlistItemStatisticsCSVFile(const QString &item
   // Run the parsing of the file in the background
   cancelBackgroundParser = false;
   timer.start(1000, this);
-  backgroundParserFuture = QtConcurrent::run(this, &playlistItemStatisticsCSVFile::readFrameAndTypePositionsFromFile);
+  backgroundParserFuture = QtConcurrent::run(&backgroundParserPool, this, &playlistItemStatisticsCSVFile::readFrameAndTypePositionsFromFile);
 
   connect(&statSource, &statisticHandler::updateItem, [this](bool redraw){ emit signalItemChanged(redraw, RECACHE_NONE); });
   connect(&statSource, &statisticHandler::requestStatisticsLoading, this, &playlistItemStatisticsCSVFile::loadStatisticToCache, Qt::DirectConnection);
 }
 
+// Get the integer value of a CSV field in the same way as parseCSVLine(...)[i].toInt() would but without any allocations.
+// All spaces in the field are ignored. If the field is no valid integer, 0 is returned.
+static int getCSVFieldIntValue(const char *c, const char *end)
+{
+  while (c < end && (*c == ' ' || *c == '\t' || *c == '\r'))
+    c++;
+  bool negative = false;
+  if (c < end && (*c == '-' || *c == '+'))
+    negative = (*c++ == '-');
+  int value = 0;
+  bool digitFound = false;
+  for (; c < end; c++)
+  {
+    if (*c >= '0' && *c <= '9')
+    {
+      value = value * 10 + (*c - '0');
+      digitFound = true;
+    }
+    else if (*c != ' ' && *c != '\t' && *c != '\r')
+      return 0;
+  }
+  if (!digitFound)
+    return 0;
+  return negative ? -value : value;
+}
+
+// Get the POC (first field) and the type (sixth field) from a CSV line. Return false for empty lines, headers
+// (the first field starts with '%') and lines with less than six fields.
+static bool getPOCAndTypeFromCSVLine(const char *line, int length, int &poc, int &typeID)
+{
+  const char *end = line + length;
+  const char *fieldStart[6];
+  const char *fieldEnd[6];
+  const char *c = line;
+  for (int i = 0; i < 6; i++)
+  {
+    const char *delimiter = (const char*)memchr(c, ';', end - c);
+    if (delimiter == nullptr && i < 5)
+      return false;
+    fieldStart[i] = c;
+    fieldEnd[i] = (delimiter == nullptr) ? end : delimiter;
+    c = (delimiter == nullptr) ? end : delimiter + 1;
+  }
+
+  // ignore empty entries and headers
+  const char *first = fieldStart[0];
+  while (first < fieldEnd[0] && (*first == ' ' || *first == '\t' || *first == '\r'))
+    first++;
+  if (first == fieldEnd[0] || *first == '%')
+    return false;
+
+  poc = getCSVFieldIntValue(fieldStart[0], fieldEnd[0]);
+  typeID = getCSVFieldIntValue(fieldStart[5], fieldEnd[5]);
+  return true;
+}
+
 /** The background task that parses the file and extracts the exact file positions
 * where a new frame or a new type starts. If the user then later requests this type/POC
 * we can directly jump there and parse the actual information. This way we don't have to
 * scan the whole file which can get very slow for large files.
 *
+* The file is split into chunks which are parsed on all cores. For every chunk, the positions where
+* the POC or type changes are collected. In the end, these are evaluated in file order.
+*
 * This function might emit the objectInformationChanged() signal if something went wrong,
 * setting the error message, or if parsing finished successfully.
 */
@@ -76,141 +131,151 @@ void playlistItemStatisticsCSVFile::readFrameAndTypePositionsFromFile()
 {
   try
   {
-    // Open the file (again). Since this is a background process, we open the file again to
-    // not disturb any reading from not background code.
-    fileSource inputFile;
-    if (!inputFile.openFile(file.absoluteFilePath()))
+    // The position of the first line of a run of lines with the same POC and type
+    struct pocTypeStart
+    {
+      int poc;
+      int typeID;
+      qint64 pos;
+    };
+
+    const QList<fileChunk> chunks = getParsingChunks(file.getFileSize());
+    QVector<QVector<pocTypeStart>> chunkStarts(chunks.count());
+    QVector<int> chunkIndices;
+    for (int i = 0; i < chunks.count(); i++)
+      chunkIndices.append(i);
+    backgroundParserBytesParsed = 0;
+
+    // Written from the worker threads of blockingMap
+    QAtomicInt parsingOk(1);
+    QtConcurrent::blockingMap(chunkIndices, [&](int chunkIdx)
+    {
+      QVector<pocTypeStart> &starts = chunkStarts[chunkIdx];
+      int lastPOC = INT_INVALID;
+      int lastType = INT_INVALID;
+      bool sortingFixed = false;
+      const bool ok = parseLinesInChunk(chunks[chunkIdx], [&](const char *line, int length, int64_t filePos)
+      {
+        int poc, typeID;
+        if (!getPOCAndTypeFromCSVLine(line, length, poc, typeID))
+          return;
+        if (poc == lastPOC && typeID == lastType)
+          return;
+
+        // While parsing, the first start position of each POC/type is already made available so that it can be drawn.
+        // The final positions are set when all chunks were parsed.
+        QMutexLocker locker(&pocTypeStartListMutex);
+        if (chunkIdx == 0 && !sortingFixed && lastPOC != INT_INVALID)
+        {
+          // The first chunk is at the start of the file so we can already check the sorting here.
+          // If the type changes but the POC stays the same, this seems to be an interleaved file.
+          fileSortedByPOC = (poc == lastPOC);
+          sortingFixed = true;
+        }
+        bool redraw = false;
+        if (!pocTypeStartList[poc].contains(typeID))
+        {
+          pocTypeStartList[poc][typeID] = filePos;
+          if (poc > maxPOC)
+            maxPOC = poc;
+          // We added a start position for the frame index that is currently drawn. We might have to redraw.
+          redraw = (poc == currentDrawnFrameIdx);
+        }
+        locker.unlock();
+
+        // Do not hold the lock while emitting. A slot connected directly may need it.
+        if (redraw)
+          emit signalItemChanged(true, RECACHE_NONE);
+
+        lastPOC = poc;
+        lastType = typeID;
+        starts.append({poc, typeID, filePos});
+      });
+      if (!ok)
+        parsingOk.store(0);
+    });
+
+    if (!parsingOk.load())
+      // Parsing was canceled
       return;
 
-    // We perform reading using an input buffer
-    QByteArray inputBuffer;
-    bool fileAtEnd = false;
-    qint64 bufferStartPos = 0;
-
-    QString lineBuffer;
-    qint64  lineBufferStartPos = 0;
-    int     lastPOC = INT_INVALID;
-    int     lastType = INT_INVALID;
-    bool    sortingFixed = false; 
-    
-    while (!fileAtEnd && !cancelBackgroundParser)
+    // Go through the start positions of all chunks in file order. Only a change of the POC or type
+    // has an effect so this gives the same result as evaluating every line of the file.
+    QMap<int, QMap<int, qint64> > newPOCTypeStartList;
+    bool newFileSortedByPOC = false;
+    int newMaxPOC = 0;
+    int lastPOC = INT_INVALID;
+    int lastType = INT_INVALID;
+    bool sortingFixed = false;
+    for (const QVector<pocTypeStart> &starts : chunkStarts)
     {
-      // Fill the buffer
-      int bufferSize = inputFile.readBytes(inputBuffer, bufferStartPos, STAT_PARSING_BUFFER_SIZE);
-      if (bufferSize < STAT_PARSING_BUFFER_SIZE)
-        // Less bytes than the maximum buffer size were read. The file is at the end.
-        // This is the last run of the loop.
-        fileAtEnd = true;
-      // a corrupted file may contain an arbitrary amount of non-\n symbols
-      // prevent lineBuffer overflow by dumping it for such cases
-      if (lineBuffer.size() > STAT_MAX_STRING_SIZE)
-        lineBuffer.clear(); // prevent an overflow here
-      for (int i = 0; i < bufferSize; i++)
+      for (const pocTypeStart &s : starts)
       {
-        // Search for '\n' newline characters
-        if (inputBuffer.at(i) == 10)
+        const int poc = s.poc;
+        const int typeID = s.typeID;
+        if (poc == lastPOC && typeID == lastType)
+          // This continues the run from the previous chunk
+          continue;
+
+        if (lastType == -1 && lastPOC == -1)
+        {
+          // First POC/type line
+          newPOCTypeStartList[poc][typeID] = s.pos;
+          lastType = typeID;
+          lastPOC = poc;
+        }
+        else if (typeID != lastType && poc == lastPOC)
         {
-          // We found a newline character
-          if (lineBuffer.size() > 0)
+          // we found a new type but the POC stayed the same.
+          // This seems to be an interleaved file
+          // Check if we already collected a start position for this type
+          if (!sortingFixed)
           {
-            // Parse the previous line
-            // get components of this line
-            QStringList rowItemList = parseCSVLine(lineBuffer, ';');
-
-            // ignore empty entries and headers
-            if (!rowItemList[0].isEmpty() && rowItemList[0][0] != '%')
-            {
-              // check for POC/type information
-              int poc = rowItemList[0].toInt();
-              int typeID = rowItemList[5].toInt();
-
-              if (lastType == -1 && lastPOC == -1)
-              {
-                // First POC/type line
-                pocTypeStartList[poc][typeID] = lineBufferStartPos;
-                if (poc == currentDrawnFrameIdx)
-                  // We added a start position for the frame index that is currently drawn. We might have to redraw.
-                  emit signalItemChanged(true, RECACHE_NONE);
-
-                lastType = typeID;
-                lastPOC = poc;
-
-                // update number of frames
-                if (poc > maxPOC)
-                  maxPOC = poc;
-              }
-              else if (typeID != lastType && poc == lastPOC)
-              {
-                // we found a new type but the POC stayed the same.
-                // This seems to be an interleaved file
-                // Check if we already collected a start position for this type
-                if (!sortingFixed)
-                {
-                  // we only check the first occurence of this, in a non-interleaved file
-                  // the above condition can be met and will reset fileSortedByPOC
-                  
-                  fileSortedByPOC = true;
-                  sortingFixed = true; 
-                }
-                lastType = typeID;
-                if (!pocTypeStartList[poc].contains(typeID))
-                {
-                  pocTypeStartList[poc][typeID] = lineBufferStartPos;
-                  if (poc == currentDrawnFrameIdx)
-                    // We added a start position for the frame index that is currently drawn. We might have to redraw.
-                    emit signalItemChanged(true, RECACHE_NONE);
-                }
-              }
-              else if (poc != lastPOC)
-              {
-                // this is apparently not sorted by POCs and we will not check it further
-                if(!sortingFixed)
-                  sortingFixed = true;
-                
-                // We found a new POC
-                if (fileSortedByPOC)
-                {
-                  // There must not be a start position for any type with this POC already.
-                  if (pocTypeStartList.contains(poc))
-                    throw "The data for each POC must be continuous in an interleaved statistics file->";
-                }
-                else
-                {
-                
-                  // There must not be a start position for this POC/type already.
-                  if (pocTypeStartList.contains(poc) && pocTypeStartList[poc].contains(typeID))
-                    throw "The data for each typeID must be continuous in an non interleaved statistics file->";
-                }
-
-                lastPOC = poc;
-                lastType = typeID;
-
-                pocTypeStartList[poc][typeID] = lineBufferStartPos;
-                if (poc == currentDrawnFrameIdx)
-                  // We added a start position for the frame index that is currently drawn. We might have to redraw.
-                  emit signalItemChanged(true, RECACHE_NONE);
-
-                // update number of frames
-                if (poc > maxPOC)
-                  maxPOC = poc;
-
-                // Update percent of file parsed
-                backgroundParserProgress = ((double)lineBufferStartPos * 100 / (double)inputFile.getFileSize());
-              }
-            }
+            // we only check the first occurence of this, in a non-interleaved file
+            // the above condition can be met and will reset fileSortedByPOC
+            newFileSortedByPOC = true;
+            sortingFixed = true;
           }
-
-          lineBuffer.clear();
-          lineBufferStartPos = bufferStartPos + i + 1;
+          lastType = typeID;
+          if (!newPOCTypeStartList[poc].contains(typeID))
+            newPOCTypeStartList[poc][typeID] = s.pos;
         }
-        else
+        else if (poc != lastPOC)
         {
-          // No newline character found
-          lineBuffer.append(inputBuffer.at(i));
+          // this is apparently not sorted by POCs and we will not check it further
+          if(!sortingFixed)
+            sortingFixed = true;
+
+          // We found a new POC
+          if (newFileSortedByPOC)
+          {
+            // There must not be a start position for any type with this POC already.
+            if (newPOCTypeStartList.contains(poc))
+              throw "The data for each POC must be continuous in an interleaved statistics file->";
+          }
+          else
+          {
+            // There must not be a start position for this POC/type already.
+            if (newPOCTypeStartList.contains(poc) && newPOCTypeStartList[poc].contains(typeID))
+              throw "The data for each typeID must be continuous in an non interleaved statistics file->";
+          }
+
+          lastPOC = poc;
+          lastType = typeID;
+          newPOCTypeStartList[poc][typeID] = s.pos;
         }
+
+        // update number of frames
+        if (poc > newMaxPOC)
+          newMaxPOC = poc;
       }
+    }
 
-      bufferStartPos += bufferSize;
+    {
+      QMutexLocker locker(&pocTypeStartListMutex);
+      pocTypeStartList = newPOCTypeStartList;
+      fileSortedByPOC = newFileSortedByPOC;
+      maxPOC = newMaxPOC;
     }
 
     // Parsing complete
@@ -412,6 +477,7 @@ void playlistItemStatisticsCSVFile::loadStatisticToCache(int frameIdxInternal, i
 
     QTextStream in(file.getQFile());
 
+    QMutexLocker locker(&pocTypeStartListMutex);
     if (!pocTypeStartList.contains(frameIdxInternal) || !pocTypeStartList[frameIdxInternal].contains(typeID))
     {
       // There are no statistics in the file for the given frame and index.
@@ -433,6 +499,8 @@ void playlistItemStatisticsCSVFile::loadStatisticToCache(int frameIdxInternal, i
         if (value < startPos)
           startPos = value;
     }
+    const bool sortedByPOC = fileSortedByPOC;
+    locker.unlock();
 
     // fast forward
     in.seek(startPos);
@@ -455,7 +523,7 @@ void playlistItemStatisticsCSVFile::loadStatisticToCache(int frameIdxInternal, i
       if (poc != frameIdxInternal)
         break;
       // if there is a new type and this is a non interleaved file, we are done here.
-      if (!fileSortedByPOC && type != typeID)
+      if (!sortedByPOC && type != typeID)
         break;
 
       int values[4] = {0};
@@ -567,9 +635,11 @@ void playlistItemStatisticsCSVFile::reloadItemSource()
   }
 
   // Clear the parsed data
-  pocTypeStartList.clear();
-  statSource.statsCache.clear();
-  statSource.statsCacheFrameIdx = -1;
+  {
+    QMutexLocker locker(&pocTypeStartListMutex);
+    pocTypeStartList.clear();
+  }
+  statSource.clearStatisticsCache();
 
   // Reopen the file
   file.openFile(plItemNameOrFileName);
@@ -584,7 +654,7 @@ void playlistItemStatisticsCSVFile::reloadItemSource()
   // Run the parsing of the file in the background
   cancelBackgroundParser = false;
   timer.start(1000, this);
-  backgroundParserFuture = QtConcurrent::run(this, &playlistItemStatisticsCSVFile::readFrameAndTypePositionsFromFile);
+  backgroundParserFuture = QtConcurrent::run(&backgroundParserPool, this, &playlistItemStatisticsCSVFile::readFrameAndTypePositionsFromFile);
 }
 
 
@@ -35,6 +35,7 @@
 
 #include <QBasicTimer>
 #include <QFuture>
+#include <QMutex>
 #include "fileSource.h"
 #include "playlistItemStatisticsFile.h"
 #include "statisticHandler.h"
@@ -77,8 +78,9 @@ private:
   
   QStringList parseCSVLine(const QString &line, char delimiter) const;
 
-  // A list of file positions where each POC/type starts
+  // A list of file positions where each POC/type starts. This is filled by the background parser.
   QMap<int, QMap<int, qint64> > pocTypeStartList;
+  QMutex pocTypeStartListMutex;
 
   // --------------- background parsing ---------------
   //! Parser the whole file and get the positions where a new POC/type starts. Save this position in p_pocTypeStartList.
@@ -33,16 +33,16 @@
 #include "playlistItemStatisticsFile.h"
 
 #include <cassert>
+#include <cstring>
 #include <iostream>
 #include <QDebug>
+#include <QThread>
 #include <QTime>
 #include <QUrl>
 #include "statisticsExtensions.h"
 
-// The internal buffer for parsing the starting positions. The buffer must not be larger than 2GB
-// so that we can address all the positions in it with int (using such a large buffer is not a good
-// idea anyways)
-#define STAT_PARSING_BUFFER_SIZE 1048576
+// When parsing a file in parallel, a chunk should at least have this size. Smaller files are parsed in fewer chunks.
+#define STAT_PARSING_MIN_CHUNK_SIZE 16777216
 
 playlistItemStatisticsFile::playlistItemStatisticsFile(const QString &itemNameOrFileName)
   : playlistItem(itemNameOrFileName, playlistItem_Indexed)
@@ -55,6 +55,9 @@ playlistItemStatisticsFile::playlistItemStatisticsFile(const QString &itemNameOr
   maxPOC = 0;
   isStatisticsLoading = false;
 
+  // The statistics of multiple frames can be cached
+  cachingEnabled = true;
+
   // Set statistics icon
   setIcon(0, convertIcon(":img_stats.png"));
 
@@ -123,7 +126,13 @@ void playlistItemStatisticsFile::timerEvent(QTimerEvent *event)
   // Check if the background process is still running. If it is not, no signal are required anymore.
   // The final update signal was emitted by the background process.
   if (!backgroundParserFuture.isRunning())
+  {
     timer.stop();
+    // Statistics that were loaded while parsing may be incomplete. Now that the positions of all frames are known,
+    // the statistics will be loaded again (and the item can be cached).
+    statSource.clearStatisticsCache();
+    emit signalItemChanged(true, RECACHE_NONE);
+  }
   else
   {
     setStartEndFrame(indexRange(0, maxPOC), false);
@@ -131,6 +140,126 @@ void playlistItemStatisticsFile::timerEvent(QTimerEvent *event)
   }
 }
 
+QList<playlistItemStatisticsFile::fileChunk> playlistItemStatisticsFile::getParsingChunks(int64_t fileSize)
+{
+  const int64_t nrChunksMax = (fileSize + STAT_PARSING_MIN_CHUNK_SIZE - 1) / STAT_PARSING_MIN_CHUNK_SIZE;
+  const int nrChunks = int(qBound(int64_t(1), nrChunksMax, int64_t(QThread::idealThreadCount())));
+
+  QList<fileChunk> chunks;
+  for (int i = 0; i < nrChunks; i++)
+  {
+    fileChunk c;
+    c.start = fileSize * i / nrChunks;
+    c.end = fileSize * (i + 1) / nrChunks;
+    chunks.append(c);
+  }
+  return chunks;
+}
+
+bool playlistItemStatisticsFile::parseLinesInChunk(const fileChunk &chunk, const lineParsingFunction &lineFunction)
+{
+  // Open the file (again). Since this is a background process, we open the file again to
+  // not disturb any reading from not background code.
+  fileSource inputFile;
+  if (!inputFile.openFile(file.absoluteFilePath()))
+    return false;
+  const int64_t fileSize = inputFile.getFileSize();
+
+  // A line starts in this chunk if the character before it is a newline. So we start reading one byte before the chunk.
+  int64_t bufferStartPos = (chunk.start > 0) ? chunk.start - 1 : 0;
+  bool lineStartFound = (chunk.start == 0);
+  int64_t lineStartPos = 0;
+  int64_t progressPos = chunk.start;
+
+  // Lines that span over the end of the input buffer are collected here
+  QByteArray inputBuffer;
+  QByteArray lineBuffer;
+
+  while (!cancelBackgroundParser)
+  {
+    const int bufferSize = int(inputFile.readBytes(inputBuffer, bufferStartPos, STAT_PARSING_BUFFER_SIZE));
+    const bool fileAtEnd = (bufferSize < STAT_PARSING_BUFFER_SIZE);
+    const char *data = inputBuffer.constData();
+
+    int i = 0;
+    if (!lineStartFound)
+    {
+      // Skip the line that started in the previous chunk
+      const char *newline = (const char*)memchr(data, '\n', bufferSize);
+      if (newline != nullptr)
+      {
+        i = int(newline - data) + 1;
+        lineStartFound = true;
+        lineStartPos = bufferStartPos + i;
+      }
+      else
+        i = bufferSize;
+    }
+
+    while (lineStartFound && i < bufferSize)
+    {
+      if (lineStartPos >= chunk.end)
+        // All lines of this chunk were parsed
+        break;
+
+      const char *newline = (const char*)memchr(data + i, '\n', bufferSize - i);
+      if (newline == nullptr)
+      {
+        // The line continues in the next buffer. A corrupted file may contain an arbitrary amount
+        // of non-\n symbols. Prevent an overflow of the line buffer.
+        if (lineBuffer.size() > STAT_MAX_STRING_SIZE)
+          lineBuffer.clear();
+        lineBuffer.append(data + i, bufferSize - i);
+        break;
+      }
+
+      const int lineEnd = int(newline - data);
+      if (lineBuffer.isEmpty())
+        lineFunction(data + i, lineEnd - i, lineStartPos);
+      else
+      {
+        lineBuffer.append(data + i, lineEnd - i);
+        lineFunction(lineBuffer.constData(), lineBuffer.size(), lineStartPos);
+        lineBuffer.clear();
+      }
+      i = lineEnd + 1;
+      lineStartPos = bufferStartPos + i;
+    }
+
+    bufferStartPos += bufferSize;
+
+    // Update percent of file parsed
+    const int64_t newProgressPos = qMin(bufferStartPos, chunk.end);
+    if (newProgressPos > progressPos)
+    {
+      const qint64 bytesParsed = backgroundParserBytesParsed.fetchAndAddRelaxed(newProgressPos - progressPos) + (newProgressPos - progressPos);
+      backgroundParserProgress = double(bytesParsed) * 100 / double(fileSize);
+      progressPos = newProgressPos;
+    }
+
+    if (lineStartFound && lineStartPos >= chunk.end)
+      return true;
+    if (fileAtEnd)
+    {
+      // The last line of the file has no newline character
+      if (lineStartFound && !lineBuffer.isEmpty())
+        lineFunction(lineBuffer.constData(), lineBuffer.size(), lineStartPos);
+      return true;
+    }
+  }
+
+  return false;
+}
+
+QList<int> playlistItemStatisticsFile::getCachedFrames() const
+{
+  // Convert indices from internal to external indices
+  QList<int> retList;
+  for (int i : statSource.getCachedFrames())
+    retList.append(getFrameIdxExternal(i));
+  return retList;
+}
+
 void playlistItemStatisticsFile::createPropertiesWidget()
 {
   // Absolutely always only call this once//
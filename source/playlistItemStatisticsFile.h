@@ -33,12 +33,22 @@
 #ifndef PLAYLISTITEMSTATISTICSFILE_H
 #define PLAYLISTITEMSTATISTICSFILE_H
 
+#include <functional>
+#include <QAtomicInteger>
 #include <QBasicTimer>
 #include <QFuture>
+#include <QThreadPool>
 #include "fileSource.h"
 #include "playlistItem.h"
 #include "statisticHandler.h"
 
+// The internal buffer for parsing the starting positions. The buffer must not be larger than 2GB
+// so that we can address all the positions in it with int (using such a large buffer is not a good
+// idea anyways)
+#define STAT_PARSING_BUFFER_SIZE (1048576)
+// Lines that are longer than this are considered an error in the file
+#define STAT_MAX_STRING_SIZE (1<<28)
+
 class playlistItemStatisticsFile : public playlistItem
 {
   Q_OBJECT
@@ -79,6 +89,19 @@ public:
   virtual bool              providesStatistics() const Q_DECL_OVERRIDE { return true; }
   virtual statisticHandler *getStatisticsHandler() Q_DECL_OVERRIDE { return &statSource; }
 
+  // ----- Caching -----
+  // The statistics of multiple frames are cached in the statisticHandler (with its own size limit). The statistics
+  // can only be cached once the background parser knows where all frames are in the file.
+  virtual bool isCachable() const Q_DECL_OVERRIDE { return playlistItem::isCachable() && !backgroundParserFuture.isRunning(); }
+  // Loading from the file can only be done by one thread at a time
+  virtual int cachingThreadLimit() Q_DECL_OVERRIDE { return 1; }
+  virtual void cacheFrame(int idx, bool testMode) Q_DECL_OVERRIDE { if (!testMode) statSource.cacheStatistics(getFrameIdxInternal(idx)); }
+  virtual QList<int> getCachedFrames() const Q_DECL_OVERRIDE;
+  virtual int getNumberCachedFrames() const Q_DECL_OVERRIDE { return statSource.getNumberCachedFrames(); }
+  virtual int getCachingFrameLimit() const Q_DECL_OVERRIDE { return statSource.getCacheFrameLimit(); }
+  virtual void removeFrameFromCache(int idx) Q_DECL_OVERRIDE { statSource.removeFrameFromCache(getFrameIdxInternal(idx)); }
+  virtual void removeAllFramesFromCache() Q_DECL_OVERRIDE { statSource.clearStatisticsCache(); }
+
   // ----- Detection of source/file change events -----
   virtual bool isSourceChanged()  Q_DECL_OVERRIDE { return file.isFileChanged(); }
   virtual void updateSettings()   Q_DECL_OVERRIDE { file.updateFileWatchSetting(); statSource.updateSettings(); }
@@ -99,6 +122,8 @@ protected:
   // Is the loadFrame function currently loading?
   bool isStatisticsLoading;
 
+  // The file is parsed in a pool of its own so that parsing big files does not occupy the global thread pool
+  QThreadPool backgroundParserPool;
   QFuture<void> backgroundParserFuture;
   double backgroundParserProgress;
   bool cancelBackgroundParser;
@@ -106,6 +131,21 @@ protected:
   QBasicTimer timer;
   virtual void timerEvent(QTimerEvent *event) Q_DECL_OVERRIDE; // Overloaded from QObject. Called when the timer fires.
 
+  // For parsing a large file on all cores, the file is split into chunks. A chunk contains all the lines
+  // that start at a position in [start, end).
+  struct fileChunk
+  {
+    int64_t start;
+    int64_t end;
+  };
+  static QList<fileChunk> getParsingChunks(int64_t fileSize);
+  // Call lineFunction(line, length, filePos) for every line that starts in the given chunk. The line does not contain
+  // the newline character. This opens the file again so it can be called from multiple threads at the same time.
+  // backgroundParserProgress is updated. Return false if the file could not be opened or parsing was canceled.
+  typedef std::function<void(const char *line, int length, int64_t filePos)> lineParsingFunction;
+  bool parseLinesInChunk(const fileChunk &chunk, const lineParsingFunction &lineFunction);
+  QAtomicInteger<qint64> backgroundParserBytesParsed;
+
   // Set if the file is sorted by POC and the types are 'random' within this POC (true)
   // or if the file is sorted by typeID and the POC is 'random'
   bool fileSortedByPOC;
@@ -32,19 +32,17 @@
 
 #include "playlistItemStatisticsVTMBMSFile.h"
 
+#include <algorithm>
 #include <cassert>
+#include <cctype>
+#include <cstring>
 #include <iostream>
 #include <QDebug>
+#include <QMutexLocker>
 #include <QtConcurrent>
 #include <QTime>
 #include "statisticsExtensions.h"
 
-// The internal buffer for parsing the starting positions. The buffer must not be larger than 2GB
-// so that we can address all the positions in it with int (using such a large buffer is not a good
-// idea anyways)
-#define STAT_PARSING_BUFFER_SIZE 1048576
-#define STAT_MAX_STRING_SIZE 1<<28
-
 playlistItemStatisticsVTMBMSFile::playlistItemStatisticsVTMBMSFile(const QString &itemNameOrFileName)
   : playlistItemStatisticsFile(itemNameOrFileName)
 {
@@ -58,17 +56,82 @@ playlistItemStatisticsVTMBMSFile::playlistItemStatisticsVTMBMSFile(const QString
   // Run the parsing of the file in the background
   cancelBackgroundParser = false;
   timer.start(1000, this);
-  backgroundParserFuture = QtConcurrent::run(this, &playlistItemStatisticsVTMBMSFile::readFramePositionsFromFile);
+  backgroundParserFuture = QtConcurrent::run(&backgroundParserPool, this, &playlistItemStatisticsVTMBMSFile::readFramePositionsFromFile);
 
   connect(&statSource, &statisticHandler::updateItem, [this](bool redraw){ emit signalItemChanged(redraw, RECACHE_NONE); });
   connect(&statSource, &statisticHandler::requestStatisticsLoading, this, &playlistItemStatisticsVTMBMSFile::loadStatisticToCache, Qt::DirectConnection);
 }
 
+// ----- Tokenizer for the block statistic lines -----
+// The lines are parsed directly from the raw bytes. All functions advance the pointer c behind the parsed token
+// and return false if the expected token was not found.
+
+static void skipSpaces(const char *&c, const char *end)
+{
+  while (c < end && *c == ' ')
+    c++;
+}
+
+// Skip spaces and then read the given character
+static bool parseChar(const char *&c, const char *end, char expected)
+{
+  skipSpaces(c, end);
+  if (c >= end || *c != expected)
+    return false;
+  c++;
+  return true;
+}
+
+// Skip spaces and then read a (possibly negative) decimal integer
+static bool parseInt(const char *&c, const char *end, int &value)
+{
+  skipSpaces(c, end);
+  bool negative = false;
+  if (c < end && *c == '-')
+  {
+    negative = true;
+    c++;
+  }
+  if (c >= end || *c < '0' || *c > '9')
+    return false;
+  int v = 0;
+  while (c < end && *c >= '0' && *c <= '9')
+    v = v * 10 + (*c++ - '0');
+  value = negative ? -v : v;
+  return true;
+}
+
+// Find the "BlockStat: POC x" marker in the line and read the POC.
+// Lines without the marker are no block statistics and must be ignored.
+static bool parsePOC(const char *&c, const char *end, int &poc)
+{
+  static const char marker[] = "BlockStat: POC ";
+  const int markerLength = int(sizeof(marker)) - 1;
+
+  // Usually the marker is at the start of the line
+  if (end - c < markerLength)
+    return false;
+  if (memcmp(c, marker, markerLength) != 0)
+  {
+    const char *found = std::search(c, end, marker, marker + markerLength);
+    if (found == end)
+      return false;
+    c = found;
+  }
+  c += markerLength;
+  if (c >= end || *c < '0' || *c > '9')
+    return false;
+  return parseInt(c, end, poc);
+}
+
 /** The background task that parses the file and extracts the exact file positions
 * where a new frame starts. If the user then later requests this POC
 * we can directly jump there and parse the actual information. This way we don't have to
 * scan the whole file which can get very slow for large files.
 *
+* The file is split into chunks which are parsed on all cores. For every chunk, the positions where
+* the POC changes are collected. In the end, these are merged in file order.
+*
 * This function might emit the objectInformationChanged() signal if something went wrong,
 * setting the error message, or if parsing finished successfully.
 */
@@ -76,103 +139,87 @@ void playlistItemStatisticsVTMBMSFile::readFramePositionsFromFile()
 {
   try
   {
-    // Open the file (again). Since this is a background process, we open the file again to
-    // not disturb any reading from not background code.
-    fileSource inputFile;
-    if (!inputFile.openFile(file.absoluteFilePath()))
-      return;
-
-    // We perform reading using an input buffer
-    QByteArray inputBuffer;
-    bool fileAtEnd = false;
-    qint64 bufferStartPos = 0;
-
-    QString lineBuffer;
-    qint64  lineBufferStartPos = 0;
-    int     lastPOC = INT_INVALID;
-    bool    sortingFixed = false; 
-    
-    while (!fileAtEnd && !cancelBackgroundParser)
+    // The position of the first line of a run of lines with the same POC
+    struct pocStart
     {
-      // Fill the buffer
-      int bufferSize = inputFile.readBytes(inputBuffer, bufferStartPos, STAT_PARSING_BUFFER_SIZE);
-      if (bufferSize < STAT_PARSING_BUFFER_SIZE)
-        // Less bytes than the maximum buffer size were read. The file is at the end.
-        // This is the last run of the loop.
-        fileAtEnd = true;
-      // a corrupted file may contain an arbitrary amount of non-\n symbols
-      // prevent lineBuffer overflow by dumping it for such cases
-      if (lineBuffer.size() > STAT_MAX_STRING_SIZE)
-        lineBuffer.clear(); // prevent an overflow here
-      for (int i = 0; i < bufferSize; i++)
+      int poc;
+      qint64 pos;
+    };
+
+    const QList<fileChunk> chunks = getParsingChunks(file.getFileSize());
+    QVector<QVector<pocStart>> chunkPOCStarts(chunks.count());
+    QVector<int> chunkIndices;
+    for (int i = 0; i < chunks.count(); i++)
+      chunkIndices.append(i);
+    backgroundParserBytesParsed = 0;
+
+    // Written from the worker threads of blockingMap
+    QAtomicInt parsingOk(1);
+    QtConcurrent::blockingMap(chunkIndices, [&](int chunkIdx)
+    {
+      QVector<pocStart> &pocStarts = chunkPOCStarts[chunkIdx];
+      int lastPOC = INT_INVALID;
+      const bool ok = parseLinesInChunk(chunks[chunkIdx], [&](const char *line, int length, int64_t filePos)
       {
-        // Search for '\n' newline characters
-        if (inputBuffer.at(i) == 10)
+        // need to match this:
+        // BlockStat: POC 1 @( 120,  80) [ 8x 8] MVL0={ -24,  -2}
+        // BlockStat: POC 1 @( 112,  88) [ 8x 8] PredMode=0
+        const char *c = line;
+        int poc;
+        if (!parsePOC(c, line + length, poc) || poc == lastPOC)
+          return;
+
+        lastPOC = poc;
+        pocStarts.append({poc, filePos});
+
+        // While parsing, we already make the first start position of each POC available so that it can be drawn.
+        // The final positions are set when all chunks were parsed.
+        QMutexLocker locker(&pocStartListMutex);
+        bool redraw = false;
+        if (!pocStartList.contains(poc))
         {
-          // We found a newline character
-          if (lineBuffer.size() > 0)
-          {
-            // Parse the previous line
-            // get components of this line
-            // get poc using regular expression
-            // need to match this:
-            // BlockStat: POC 1 @( 120,  80) [ 8x 8] MVL0={ -24,  -2}
-            // BlockStat: POC 1 @( 112,  88) [ 8x 8] PredMode=0
-            QRegularExpression pocRegex("BlockStat: POC ([0-9]+)");
-
-            QRegularExpressionMatch match = pocRegex.match(lineBuffer);
-            // ignore not matching lines
-            if (match.hasMatch())
-            {
-              int poc = match.captured(1).toInt();
-
-              if (lastPOC == -1)
-              {
-                // First POC
-                pocStartList[poc] = lineBufferStartPos;
-                if (poc == currentDrawnFrameIdx)
-                  // We added a start position for the frame index that is currently drawn. We might have to redraw.
-                  emit signalItemChanged(true, RECACHE_NONE);
-
-                lastPOC = poc;
-
-                // update number of frames
-                if (poc > maxPOC)
-                  maxPOC = poc;
-              }
-              else if (poc != lastPOC)
-              {
-                // this is apparently not sorted by POCs and we will not check it further
-                if(!sortingFixed)
-                  sortingFixed = true;
-
-                lastPOC = poc;                
-                pocStartList[poc] = lineBufferStartPos;
-                if (poc == currentDrawnFrameIdx)
-                  // We added a start position for the frame index that is currently drawn. We might have to redraw.
-                  emit signalItemChanged(true, RECACHE_NONE);
-
-                // update number of frames
-                if (poc > maxPOC)
-                  maxPOC = poc;
-
-                // Update percent of file parsed
-                backgroundParserProgress = ((double)lineBufferStartPos * 100 / (double)inputFile.getFileSize());
-              }
-            }
-          }
-
-          lineBuffer.clear();
-          lineBufferStartPos = bufferStartPos + i + 1;
-        }
-        else
-        {
-          // No newline character found
-          lineBuffer.append(inputBuffer.at(i));
+          pocStartList[poc] = filePos;
+          if (poc > maxPOC)
+            maxPOC = poc;
+          // We added a start position for the frame index that is currently drawn. We might have to redraw.
+          redraw = (poc == currentDrawnFrameIdx);
         }
+        locker.unlock();
+
+        // Do not hold the lock while emitting. A slot connected directly may need it.
+        if (redraw)
+          emit signalItemChanged(true, RECACHE_NONE);
+      });
+      if (!ok)
+        parsingOk.store(0);
+    });
+
+    if (!parsingOk.load())
+      // Parsing was canceled
+      return;
+
+    // Merge the results of the chunks. The last run of lines for a POC in the file is used.
+    // A run which continues from the previous chunk is not a new start position.
+    QMap<int, qint64> newPOCStartList;
+    int lastPOC = INT_INVALID;
+    int newMaxPOC = 0;
+    for (const QVector<pocStart> &pocStarts : chunkPOCStarts)
+    {
+      for (const pocStart &p : pocStarts)
+      {
+        if (p.poc == lastPOC)
+          continue;
+        lastPOC = p.poc;
+        newPOCStartList[p.poc] = p.pos;
+        if (p.poc > newMaxPOC)
+          newMaxPOC = p.poc;
       }
+    }
 
-      bufferStartPos += bufferSize;
+    {
+      QMutexLocker locker(&pocStartListMutex);
+      pocStartList = newPOCStartList;
+      maxPOC = newMaxPOC;
     }
 
     // Parsing complete
@@ -366,199 +413,181 @@ void playlistItemStatisticsVTMBMSFile::loadStatisticToCache(int frameIdxInternal
     if (!file.isOk())
       return;
 
-    QTextStream in(file.getQFile());
-
-    if (!pocStartList.contains(frameIdxInternal))
+    qint64 startPos;
     {
-      // There are no statistics in the file for the given frame and index.
-      statSource.statsCache.insert(typeID, statisticsData());
-      return;
+      QMutexLocker locker(&pocStartListMutex);
+      if (!pocStartList.contains(frameIdxInternal))
+      {
+        // There are no statistics in the file for the given frame and index.
+        statSource.statsCache.insert(typeID, statisticsData());
+        return;
+      }
+      startPos = pocStartList[frameIdxInternal];
     }
 
-
-    qint64 startPos = pocStartList[frameIdxInternal];
-
-    // fast forward
-    in.seek(startPos);
-
-    QRegularExpression pocRegex("BlockStat: POC ([0-9]+)");
-
-    // prepare regex for selected type
     StatisticsType *aType = statSource.getStatisticsType(typeID);
     Q_ASSERT_X(aType != nullptr, "StatisticsObject::readStatisticsFromFile", "Stat type not found.");
-    QRegularExpression typeRegex(" " + aType->typeName + "="); // for catching lines of the type
+    const QByteArray typeName = aType->typeName.toLatin1();
+    const QSize frameSize = statSource.getFrameSize();
 
-    // for extracting scalar value statistics, need to match:
+    // Parse one line. Return false if a line of another POC was found.
+    // The lines look like this:
     // BlockStat: POC 1 @( 112,  88) [ 8x 8] PredMode=0
-    QRegularExpression scalarRegex("POC ([0-9]+) @\\( *([0-9]+), *([0-9]+)\\) *\\[ *([0-9]+)x *([0-9]+)\\] *\\w+=([0-9\\-]+)");
-    // for extracting vector value statistics, need to match:
     // BlockStat: POC 1 @( 120,  80) [ 8x 8] MVL0={ -24,  -2}
-    QRegularExpression vectorRegex("POC ([0-9]+) @\\( *([0-9]+), *([0-9]+)\\) *\\[ *([0-9]+)x *([0-9]+)\\] *\\w+={ *([0-9\\-]+), *([0-9\\-]+)}");
-    // for extracting affine transform value statistics, need to match:
     // BlockStat: POC 2 @( 192,  96) [64x32] AffineMVL0={-324,-116,-276,-116,-324, -92}
-    QRegularExpression affineTFRegex("POC ([0-9]+) @\\( *([0-9]+), *([0-9]+)\\) *\\[ *([0-9]+)x *([0-9]+)\\] *\\w+={ *([0-9\\-]+), *([0-9\\-]+), *([0-9\\-]+), *([0-9\\-]+), *([0-9\\-]+), *([0-9\\-]+)}");
-    // for extracting scalar polygon  statistics, need to match:
+    // BlockStat: POC 2 @( 192,  96) [64x32] Line={0,0,31,31}
     // BlockStat: POC 2 @[(505, 384)--(511, 384)--(511, 415)--] GeoPUInterIntraFlag=0
     // BlockStat: POC 2 @[(416, 448)--(447, 448)--(447, 478)--(416, 463)--] GeoPUInterIntraFlag=0
-    // will capture 3-5 points. other polygons are not supported
-    QRegularExpression scalarPolygonRegex("POC ([0-9]+) @\\[((?:\\( *[0-9]+, *[0-9]+\\)--){3,5})\\] *\\w+=([0-9\\-]+)");
-    // for extracting vector polygon statistics:
-    QRegularExpression vectorPolygonRegex("POC ([0-9]+) @\\[((?:\\( *[0-9]+, *[0-9]+\\)--){3,5})\\] *\\w+={ *([0-9\\-]+), *([0-9\\-]+)}");
-    // for extracting the partitioning line, we extract
-    // BlockStat: POC 2 @( 192,  96) [64x32] Line={0,0,31,31}
-    QRegularExpression lineRegex("POC ([0-9]+) @\\( *([0-9]+), *([0-9]+)\\) *\\[ *([0-9]+)x *([0-9]+)\\] *\\w+={ *([0-9\\-]+), *([0-9\\-]+), *([0-9\\-]+), *([0-9\\-]+)}");
-
-    while (!in.atEnd())
+    auto parseLine = [&](const char *line, const char *end) -> bool
     {
-      // read one line
-      QString aLine = in.readLine();
-
-
-      QRegularExpressionMatch pocMatch = pocRegex.match(aLine);
-      // ignore not matching lines
-      if (pocMatch.hasMatch())
+      const char *c = line;
+      int poc;
+      if (!parsePOC(c, end, poc))
+        // ignore not matching lines
+        return true;
+      if (poc != frameIdxInternal)
+        return false;
+
+      // filter lines of different types. The type name is in front of the first '='.
+      const char *equal = (const char*)memchr(c, '=', end - c);
+      if (equal == nullptr)
+        return true;
+      const char *nameStart = equal;
+      while (nameStart > c && (isalnum((unsigned char)nameStart[-1]) || nameStart[-1] == '_'))
+        nameStart--;
+      if (nameStart == c || nameStart[-1] != ' ' || equal - nameStart != typeName.size() || memcmp(nameStart, typeName.constData(), typeName.size()) != 0)
+        return true;
+
+      bool ok = parseChar(c, nameStart, '@');
+      int posX = 0, posY = 0, width = 0, height = 0;
+      QVector<QPoint> points;
+      if (!aType->isPolygon)
+      {
+        // process block statistics
+        ok = ok && parseChar(c, nameStart, '(') && parseInt(c, nameStart, posX) && parseChar(c, nameStart, ',') && parseInt(c, nameStart, posY) && parseChar(c, nameStart, ')');
+        ok = ok && parseChar(c, nameStart, '[') && parseInt(c, nameStart, width) && parseChar(c, nameStart, 'x') && parseInt(c, nameStart, height) && parseChar(c, nameStart, ']');
+      }
+      else
       {
-        int poc = pocMatch.captured(1).toInt();
-        if (poc != frameIdxInternal)
+        // process polygon statistics. Polygons with 3 to 5 corners are supported.
+        ok = ok && parseChar(c, nameStart, '[');
+        while (ok && !parseChar(c, nameStart, ']'))
         {
-          break;
+          int x, y;
+          ok = parseChar(c, nameStart, '(') && parseInt(c, nameStart, x) && parseChar(c, nameStart, ',') && parseInt(c, nameStart, y) && parseChar(c, nameStart, ')');
+          ok = ok && parseChar(c, nameStart, '-') && parseChar(c, nameStart, '-');
+          if (ok)
+            points << QPoint(x, y);
         }
+        ok = ok && points.count() >= 3 && points.count() <= 5;
+      }
 
-        // filter lines of different types
-        QRegularExpressionMatch typeMatch = typeRegex.match(aLine);
-        if (typeMatch.hasMatch())
+      // Parse the value(s) behind the '='
+      c = equal + 1;
+      int values[6];
+      int nrValues = 0;
+      if (parseChar(c, end, '{'))
+      {
+        do
         {
-          int poc, posX, posY, width, height, scalar, vecX, vecY;
-
-          QRegularExpressionMatch statisitcMatch;
-          // extract statistics info
-          // try block types
-          if (aType->isPolygon == false)
-          {
-            if (aType->hasValueData)
-            {
-              statisitcMatch = scalarRegex.match(aLine);
-            }
-            else if (aType->hasVectorData)
-            {
-              statisitcMatch = vectorRegex.match(aLine);
-              if (!statisitcMatch.hasMatch())
-              {
-                statisitcMatch = lineRegex.match(aLine);
-              }
-            }
-            else if (aType->hasAffineTFData)
-            {
-              statisitcMatch = affineTFRegex.match(aLine);
-            }
-          }
-          else
-          // try polygons
-          {
-            if (aType->hasValueData)
-            {
-              statisitcMatch = scalarPolygonRegex.match(aLine);
-            }
-            else if (aType->hasVectorData)
-            {
-              statisitcMatch = vectorPolygonRegex.match(aLine);
-            }
-          }
-          if (!statisitcMatch.hasMatch())
-          {
-            parsingError = QString("Error while parsing statistic: ") + QString(aLine);
-            continue;
-          }
+          ok = ok && nrValues < 6 && parseInt(c, end, values[nrValues++]);
+        } while (ok && parseChar(c, end, ','));
+        ok = ok && parseChar(c, end, '}');
+      }
+      else
+        ok = ok && parseInt(c, end, values[nrValues++]);
 
-          // useful for debugging:
-  //        QStringList all_captured = statisitcMatch.capturedTexts();
+      // Check if the values match the type
+      if (ok)
+      {
+        if (aType->hasValueData)
+          ok = (nrValues == 1);
+        else if (aType->hasVectorData)
+          ok = (nrValues == 2 || (nrValues == 4 && !aType->isPolygon));
+        else if (aType->hasAffineTFData)
+          ok = (nrValues == 6 && !aType->isPolygon);
+        else
+          ok = false;
+      }
+      if (!ok)
+      {
+        parsingError = QString("Error while parsing statistic: ") + QString::fromLatin1(line, int(end - line));
+        return true;
+      }
 
-          poc = statisitcMatch.captured(1).toInt();
-          width = statisitcMatch.captured(4).toInt();
-          height = statisitcMatch.captured(5).toInt();
-          // if there is a new POC, we are done here!
-          if (poc != frameIdxInternal)
-            break;
+      if (!aType->isPolygon)
+      {
+        // Check if block is within the image range
+        if (blockOutsideOfFrame_idx == -1 && (posX + width > frameSize.width() || posY + height > frameSize.height()))
+          // Block not in image. Warn about this.
+          blockOutsideOfFrame_idx = frameIdxInternal;
+
+        if (aType->hasVectorData && nrValues == 4)
+          statSource.statsCache[typeID].addLine(posX, posY, width, height, values[0], values[1], values[2], values[3]);
+        else if (aType->hasVectorData)
+          statSource.statsCache[typeID].addBlockVector(posX, posY, width, height, values[0], values[1]);
+        else if (aType->hasAffineTFData)
+          statSource.statsCache[typeID].addBlockAffineTF(posX, posY, width, height, values[0], values[1], values[2], values[3], values[4], values[5]);
+        else
+          statSource.statsCache[typeID].addBlockValue(posX, posY, width, height, values[0]);
+      }
+      else
+      {
+        // Check if polygon is within the image range
+        for (const QPoint &p : points)
+          if (blockOutsideOfFrame_idx == -1 && (p.x() > frameSize.width() || p.y() > frameSize.height()))
+            // Block not in image. Warn about this.
+            blockOutsideOfFrame_idx = frameIdxInternal;
+
+        if (aType->hasVectorData)
+          statSource.statsCache[typeID].addPolygonVector(points, values[0], values[1]);
+        else
+          statSource.statsCache[typeID].addPolygonValue(points, values[0]);
+      }
+      return true;
+    };
 
-          // process block statistics
-          if (aType->isPolygon == false)
-          {
-            posX = statisitcMatch.captured(2).toInt();
-            posY = statisitcMatch.captured(3).toInt();
-
-            // Check if block is within the image range
-            if (blockOutsideOfFrame_idx == -1 && (posX + width > statSource.getFrameSize().width() || posY + height > statSource.getFrameSize().height()))
-              // Block not in image. Warn about this.
-              blockOutsideOfFrame_idx = frameIdxInternal;
-
-            if (aType->hasVectorData)
-            {
-              vecX = statisitcMatch.captured(6).toInt();
-              vecY = statisitcMatch.captured(7).toInt();
-              if (statisitcMatch.lastCapturedIndex()>7)
-              {
-                int vecX1 = statisitcMatch.captured(8).toInt();
-                int vecY1 = statisitcMatch.captured(9).toInt();
-                statSource.statsCache[typeID].addLine(posX, posY, width, height, vecX, vecY,vecX1,vecY1);
-              }
-              else
-              {
-                statSource.statsCache[typeID].addBlockVector(posX, posY, width, height, vecX, vecY);
-              }
-            }
-            else if (aType->hasAffineTFData)
-            {
-              int vecX0 = statisitcMatch.captured(6).toInt();
-              int vecY0 = statisitcMatch.captured(7).toInt();
-              int vecX1 = statisitcMatch.captured(8).toInt();
-              int vecY1 = statisitcMatch.captured(9).toInt();
-              int vecX2 = statisitcMatch.captured(10).toInt();
-              int vecY2 = statisitcMatch.captured(11).toInt();
-              statSource.statsCache[typeID].addBlockAffineTF(posX, posY, width, height, vecX0, vecY0, vecX1, vecY1, vecX2, vecY2);
-            }
-            else
-            {
-              scalar = statisitcMatch.captured(6).toInt();
-              statSource.statsCache[typeID].addBlockValue(posX, posY, width, height, scalar);
-            }
-          }
-          else
-          // process polygon statistics
-          {
-            QString corners = statisitcMatch.captured(2);
-            QStringList cornerList = corners.split("--");
-            QRegularExpression cornerRegex("\\( *([0-9]+), *([0-9]+)\\)");
-            QVector<QPoint> points;
-            for (const auto &corner : cornerList)
-            {
-              QRegularExpressionMatch cornerMatch = cornerRegex.match(corner);
-              if( cornerMatch.hasMatch())
-              {
-                int x = cornerMatch.captured(1).toInt();
-                int y = cornerMatch.captured(2).toInt();
-                points << QPoint(x,y);
-
-                // Check if polygon is within the image range
-                if (blockOutsideOfFrame_idx == -1 && (x + width > statSource.getFrameSize().width() || y + height > statSource.getFrameSize().height()))
-                  // Block not in image. Warn about this.
-                  blockOutsideOfFrame_idx = frameIdxInternal;
-              }
-            }
-
-            if (aType->hasVectorData)
-            {
-              vecX = statisitcMatch.captured(3).toInt();
-              vecY = statisitcMatch.captured(4).toInt();
-              statSource.statsCache[typeID].addPolygonVector(points, vecX, vecY);
-            }
-            else if(aType->hasValueData)
-            {
-              scalar = statisitcMatch.captured(3).toInt();
-              statSource.statsCache[typeID].addPolygonValue(points, scalar);
-            }
-          }
+    // Read the file in blocks starting at the first line of the POC until a line of another POC is found
+    QByteArray inputBuffer;
+    QByteArray lineBuffer;
+    qint64 bufferStartPos = startPos;
+    bool pocEnd = false;
+    while (!pocEnd)
+    {
+      const int bufferSize = int(file.readBytes(inputBuffer, bufferStartPos, STAT_PARSING_BUFFER_SIZE));
+      const char *data = inputBuffer.constData();
+      int i = 0;
+      while (!pocEnd && i < bufferSize)
+      {
+        const char *newline = (const char*)memchr(data + i, '\n', bufferSize - i);
+        if (newline == nullptr)
+        {
+          // The line continues in the next buffer
+          if (lineBuffer.size() > STAT_MAX_STRING_SIZE)
+            lineBuffer.clear();
+          lineBuffer.append(data + i, bufferSize - i);
+          break;
+        }
+        const int lineEnd = int(newline - data);
+        if (lineBuffer.isEmpty())
+          pocEnd = !parseLine(data + i, data + lineEnd);
+        else
+        {
+          lineBuffer.append(data + i, lineEnd - i);
+          pocEnd = !parseLine(lineBuffer.constData(), lineBuffer.constData() + lineBuffer.size());
+          lineBuffer.clear();
         }
+        i = lineEnd + 1;
+      }
+
+      if (bufferSize < STAT_PARSING_BUFFER_SIZE)
+      {
+        // The end of the file was reached. The last line may not have a newline character.
+        if (!pocEnd && !lineBuffer.isEmpty())
+          parseLine(lineBuffer.constData(), lineBuffer.constData() + lineBuffer.size());
+        break;
       }
+      bufferStartPos += bufferSize;
     }
 
     if(!statSource.statsCache.contains(typeID))
@@ -633,9 +662,11 @@ void playlistItemStatisticsVTMBMSFile::reloadItemSource()
   }
 
   // Clear the parsed data
-  pocStartList.clear();
-  statSource.statsCache.clear();
-  statSource.statsCacheFrameIdx = -1;
+  {
+    QMutexLocker locker(&pocStartListMutex);
+    pocStartList.clear();
+  }
+  statSource.clearStatisticsCache();
 
   // Reopen the file
   file.openFile(plItemNameOrFileName);
@@ -650,6 +681,6 @@ void playlistItemStatisticsVTMBMSFile::reloadItemSource()
   // Run the parsing of the file in the background
   cancelBackgroundParser = false;
   timer.start(1000, this);
-  backgroundParserFuture = QtConcurrent::run(this, &playlistItemStatisticsVTMBMSFile::readFramePositionsFromFile);
+  backgroundParserFuture = QtConcurrent::run(&backgroundParserPool, this, &playlistItemStatisticsVTMBMSFile::readFramePositionsFromFile);
 }
 
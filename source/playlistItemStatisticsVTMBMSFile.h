@@ -35,6 +35,7 @@
 
 #include <QBasicTimer>
 #include <QFuture>
+#include <QMutex>
 #include <QRegularExpression>
 #include "fileSource.h"
 #include "playlistItemStatisticsFile.h"
@@ -77,8 +78,9 @@ private:
   //! Scan the header: What types are saved in this file?
   void readHeaderFromFile();
   
-  // A list of file positions where each POC starts
+  // A list of file positions where each POC starts. This is filled by the background parser.
   QMap<int, qint64> pocStartList;
+  QMutex pocStartListMutex;
 
   // --------------- background parsing ---------------
   //! Parser the whole file and get the positions where a new POC/type starts. Save this position in p_pocTypeStartList.
@@ -81,7 +81,9 @@ void playlistItemWithVideo::loadFrame(int frameIdx, bool playing, bool loadRawDa
     // Load the requested current frame
     DEBUG_PLVIDEO("playlistItemWithVideo::loadFrame loading frame %d%s%s", frameIdxInternal, playing ? " playing" : "", loadRawData ? " raw" : "");
     isFrameLoading = true;
-    video->loadFrame(frameIdxInternal);
+    // If the raw values are not needed, the frame might be in the disk cache
+    if (loadRawData || !video->loadFrameFromDiskCache(frameIdxInternal))
+      video->loadFrame(frameIdxInternal);
     isFrameLoading = false;
     if (emitSignals)
       emit signalItemChanged(true, RECACHE_NONE);
@@ -95,7 +97,8 @@ void playlistItemWithVideo::loadFrame(int frameIdx, bool playing, bool loadRawDa
     {
       DEBUG_PLVIDEO("playlistItemWithVideo::loadFrame loading frame into double buffer %d%s%s", nextFrameIdx, playing ? " playing" : "", loadRawData ? " raw" : "");
       isFrameLoadingDoubleBuffer = true;
-      video->loadFrame(nextFrameIdx, true);
+      if (!video->loadFrameFromDiskCache(nextFrameIdx, true))
+        video->loadFrame(nextFrameIdx, true);
       isFrameLoadingDoubleBuffer = false;
       if (emitSignals)
         emit signalItemDoubleBufferLoaded();
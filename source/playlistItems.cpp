@@ -93,8 +93,11 @@ namespace playlistItems
     return nameFilters;
   }
 
-  playlistItem *createPlaylistItemFromFile(QWidget *parent, const QString &fileName)
+  playlistItem *createPlaylistItemFromFile(QWidget *parent, const QString &fileName, bool *canceled)
   {
+    if (canceled)
+      *canceled = false;
+
     QFileInfo fi(fileName);
     QString ext = fi.suffix().toLower();
 
@@ -140,7 +143,11 @@ namespace playlistItems
           else if (choice == QMessageBox::No)
             openAsImageSequence = false;
           else
+          {
+            if (canceled)
+              *canceled = true;
             return nullptr;
+          }
         }
 
         if (openAsImageSequence)
@@ -213,6 +220,8 @@ namespace playlistItems
         return newStatFile;
       }
     }
+    else if (!ok && canceled)
+      *canceled = true;
 
     return nullptr;
   }
@@ -55,8 +55,9 @@ namespace playlistItems
   // Get a list of all supported file extensions (["*.csv", "*.yuv" ...])
   QStringList getSupportedNameFilters();
 
-  // When given a file, this function will create the correct playlist item (depending on the file extension)
-  playlistItem *createPlaylistItemFromFile(QWidget *parent, const QString &fileName);
+  // When given a file, this function will create the correct playlist item (depending on the file extension).
+  // If the user cancels one of the questions (how to open the file), nullptr is returned and canceled is set.
+  playlistItem *createPlaylistItemFromFile(QWidget *parent, const QString &fileName, bool *canceled=nullptr);
 
   // Load a playlist item (and all of it's children) from the playlist
   // Append all loaded playlist items to the list plItemAndIDList (alongside the IDs that were saved in the playlist file)
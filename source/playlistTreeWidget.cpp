@@ -33,6 +33,7 @@
 #include "playlistTreeWidget.h"
 
 #include <QBuffer>
+#include <QElapsedTimer>
 #include <QFileDialog>
 #include <QHeaderView>
 #include <QInputDialog>
@@ -43,6 +44,9 @@
 #include <QScopedValueRollback>
 #include <QSettings>
 #include <QHeaderView>
+#include <QtConcurrent>
+#include <QUrl>
+#include "fileSource.h"
 #include "playlistItems.h"
 
 // Activate this if you want to know when which signals/slots are handled
@@ -53,6 +57,35 @@
 #define DEBUG_TREE_WIDGET(fmt,...) ((void)0)
 #endif
 
+// When loading files or a playlist, the first bytes of every file are read in the background so that they are
+// in the file system cache when the item is opened.
+#define PLAYLIST_LOADING_PREFETCH_BYTES (4*1024*1024)
+// The number of files that are prefetched at the same time
+#define PLAYLIST_LOADING_PREFETCH_THREADS 4
+// The maximum time (in ms) that is spent opening items in one timer event before the GUI gets control back.
+#define PLAYLIST_LOADING_MAX_TIME_PER_EVENT_MS 50
+
+namespace
+{
+  void prefetchItemFile(const QString &filePath)
+  {
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly))
+      return;
+
+    QByteArray buffer;
+    buffer.resize(64*1024);
+    qint64 remaining = PLAYLIST_LOADING_PREFETCH_BYTES;
+    while (remaining > 0)
+    {
+      qint64 nrBytesRead = file.read(buffer.data(), qMin<qint64>(remaining, buffer.size()));
+      if (nrBytesRead <= 0)
+        break;
+      remaining -= nrBytesRead;
+    }
+  }
+}
+
 class bufferStatusWidget : public QWidget
 {
 public:
@@ -132,6 +165,8 @@ PlaylistTreeWidget::PlaylistTreeWidget(QWidget *parent) : QTreeWidget(parent)
 
   connect(this, &PlaylistTreeWidget::itemSelectionChanged, this, &PlaylistTreeWidget::slotSelectionChanged);
   connect(&autosaveTimer, &QTimer::timeout, this, &PlaylistTreeWidget::autoSavePlaylist);
+
+  itemLoadingPrefetchPool.setMaxThreadCount(PLAYLIST_LOADING_PREFETCH_THREADS);
 }
 
 PlaylistTreeWidget::~PlaylistTreeWidget()
@@ -141,6 +176,9 @@ PlaylistTreeWidget::~PlaylistTreeWidget()
   QSettings settings;
   if (settings.contains("Autosaveplaylist"))
     settings.remove("Autosaveplaylist");
+
+  // Do not start prefetching files that will not be opened anymore
+  itemLoadingPrefetchPool.clear();
 }
 
 playlistItem* PlaylistTreeWidget::getDropTarget(const QPoint &pos) const
@@ -590,6 +628,14 @@ void PlaylistTreeWidget::deletePlaylistItems(bool selectionOnly)
     // Get all top level items
     for (int i = 0; i < topLevelItemCount(); i++)
       itemList.append(dynamic_cast<playlistItem*>(topLevelItem(i)));
+
+    // Items that are still queued for loading belong to the playlist as well. Drop them (and the view states
+    // of a playlist that is still loading) so that they do not appear after the playlist was cleared.
+    itemLoadingQueue.clear();
+    itemLoadingPrefetchPool.clear();
+    itemLoadingTimer.stop();
+    itemLoadingFailedFiles.clear();
+    itemLoadingLastAddedItem.clear();
   }
     
   // For all items, expand the items that contain children. However, do not add an item twice.
@@ -650,9 +696,6 @@ void PlaylistTreeWidget::loadFiles(const QStringList &files)
 {
   //qDebug() << QTime::currentTime().toString("hh:mm:ss.zzz") << "MainWindow::loadFiles()";
 
-  // this might be used to associate a statistics item with a video item
-  playlistItem* lastAddedItem = nullptr;
-
   QStringList filesToOpen;
 
   for (auto &fileName : files)
@@ -683,6 +726,7 @@ void PlaylistTreeWidget::loadFiles(const QStringList &files)
   }
 
   // Open all files that are in filesToOpen
+  bool itemsQueued = false;
   for (auto filePath : filesToOpen)
   {
     QFileInfo fi(filePath);
@@ -697,28 +741,123 @@ void PlaylistTreeWidget::loadFiles(const QStringList &files)
     }
     else
     {
-      // Try to open the file
-      playlistItem *newItem = playlistItems::createPlaylistItemFromFile(this, filePath);
+      // Queue the file. It is opened in the background (processItemLoadingQueue).
+      itemLoadingJob job;
+      job.type = itemLoadingJob::loadFile;
+      job.itemFilePath = filePath;
+      queueItemLoadingJob(job);
+      itemsQueued = true;
+    }
+  }
+
+  if (itemsQueued)
+  {
+    // After all files were opened, select the last added item
+    itemLoadingJob job;
+    job.type = itemLoadingJob::finishLoadFiles;
+    queueItemLoadingJob(job);
+  }
+}
+
+void PlaylistTreeWidget::queueItemLoadingJob(itemLoadingJob job)
+{
+  if (!job.itemFilePath.isEmpty())
+    QtConcurrent::run(&itemLoadingPrefetchPool, prefetchItemFile, job.itemFilePath);
+  itemLoadingQueue.enqueue(job);
+
+  if (!itemLoadingTimer.isActive())
+    itemLoadingTimer.start(10, this);
+}
+
+void PlaylistTreeWidget::timerEvent(QTimerEvent *event)
+{
+  if (event->timerId() != itemLoadingTimer.timerId())
+    return QTreeWidget::timerEvent(event);
+
+  processItemLoadingQueue();
+}
+
+void PlaylistTreeWidget::processItemLoadingQueue()
+{
+  // Opening an item may show a dialog (e.g. the question if an image sequence should be opened). The
+  // dialog runs its own event loop in which the timer fires again.
+  if (itemLoadingRunning)
+    return;
+  QScopedValueRollback<bool> itemLoadingRunningRollback(itemLoadingRunning, true);
+
+  bool itemsAppended = false;
+  QElapsedTimer elapsedTimer;
+  elapsedTimer.start();
+  while (!itemLoadingQueue.isEmpty() && elapsedTimer.elapsed() < PLAYLIST_LOADING_MAX_TIME_PER_EVENT_MS)
+  {
+    // The items are opened in the order in which they were queued
+    itemLoadingJob job = itemLoadingQueue.dequeue();
+    if (job.type == itemLoadingJob::loadFile)
+    {
+      bool canceled;
+      playlistItem *newItem = playlistItems::createPlaylistItemFromFile(this, job.itemFilePath, &canceled);
       if (newItem)
       {
         appendNewItem(newItem, false);
-        lastAddedItem = newItem;
+        itemLoadingLastAddedItem = newItem;
+        itemsAppended = true;
 
         // Add the file as one of the recently openend files.
-        addFileToRecentFileSetting(filePath);
+        addFileToRecentFileSetting(job.itemFilePath);
         isSaved = false;
       }
+      else if (!canceled)
+        // Files that the user chose not to open are not reported as errors
+        itemLoadingFailedFiles.append(job.itemFilePath);
+    }
+    else if (job.type == itemLoadingJob::loadPlaylistElement)
+    {
+      playlistItem *newItem = playlistItems::loadPlaylistItem(job.element, job.playlistFilePath);
+      if (newItem)
+      {
+        appendNewItem(newItem, false);
+        itemsAppended = true;
+      }
+      else
+        itemLoadingFailedFiles.append(job.itemFilePath.isEmpty() ? QString("Playlist entry %1").arg(job.element.tagName()) : job.itemFilePath);
+    }
+    else if (job.type == itemLoadingJob::finishLoadFiles)
+    {
+      if (itemLoadingLastAddedItem)
+        // Something was added. Select the last added item.
+        // The signal playlistChanged must not be emitted again because the setCurrentItem(...) function already does.
+        setCurrentItem(itemLoadingLastAddedItem.data(), 0, QItemSelectionModel::ClearAndSelect);
+      itemLoadingLastAddedItem.clear();
+    }
+    else if (job.type == itemLoadingJob::finishLoadPlaylist)
+    {
+      // All items of the playlist were opened. Now the view states (which refer to the items) can be loaded.
+      if (!job.element.isNull())
+        stateHandler->loadPlaylist(job.element);
+
+      if (topLevelItemCount() != 0 && selectedItems().count() == 0)
+      {
+        // There are items in the playlist, but no item is currently selected.
+        // Select the first item in the playlist.
+        setCurrentItem(0);
+      }
     }
   }
 
-  // Open all files
+  // The new items are live right away. They do not have to wait for the rest of the items.
+  if (itemsAppended)
+    emit playlistChanged();
 
-  if (lastAddedItem)
+  if (itemLoadingQueue.isEmpty())
   {
-    // Something was added. Select the last added item.
-    setCurrentItem(lastAddedItem, 0, QItemSelectionModel::ClearAndSelect);
+    itemLoadingTimer.stop();
 
-    // The signal playlistChanged mus not be emitted again here because the setCurrentItem(...) function already did
+    if (!itemLoadingFailedFiles.isEmpty())
+    {
+      const QString failedFiles = itemLoadingFailedFiles.join("\n");
+      itemLoadingFailedFiles.clear();
+      QMessageBox::warning(this, "Error opening files", "The following items could not be opened:\n" + failedFiles);
+    }
   }
 }
 
@@ -732,6 +871,7 @@ void PlaylistTreeWidget::addFileToRecentFileSetting(const QString &fileName)
     files.removeLast();
 
   settings.setValue("recentFileList", files);
+  emit recentFileListChanged();
 }
 
 QString PlaylistTreeWidget::getPlaylistString(QDir dirName)
@@ -855,45 +995,35 @@ bool PlaylistTreeWidget::loadPlaylistFromByteArray(QByteArray data, QString file
     return false;
   }
 
-  // Iterate over all items in the playlist
+  // Iterate over all items in the playlist and queue them for loading (processItemLoadingQueue).
+  // The elements keep the document alive until they were loaded.
+  itemLoadingJob finishJob;
+  finishJob.type = itemLoadingJob::finishLoadPlaylist;
   QDomNode n = root.firstChild();
   while (!n.isNull())
   {
-    QDomElement elem = n.toElement();
-    if (n.isElement())
-    {
-      playlistItem *newItem = playlistItems::loadPlaylistItem(elem, filePath);
-      if (newItem)
-        appendNewItem(newItem, false);
-    }
-    n = n.nextSibling();
-  }
-
-  // Iterate over the playlist again and load the view states
-  n = root.firstChild();
-  while (!n.isNull())
-  {
-    QDomElement elem = n.toElement();
+    QDomElementYUView elem = n.toElement();
     if (n.isElement())
     {
       if (elem.tagName() == "viewStates")
+        // These are the view states. They are loaded after all items were loaded.
+        finishJob.element = elem;
+      else
       {
-        // These are the view states. Load them
-        stateHandler->loadPlaylist(elem);
+        itemLoadingJob job;
+        job.type = itemLoadingJob::loadPlaylistElement;
+        job.playlistFilePath = filePath;
+        job.element = elem;
+        // Items that are not based on a file (e.g. text items) have no path
+        QString absolutePath = QUrl(elem.findChildValue("absolutePath")).toLocalFile();
+        job.itemFilePath = fileSource::getAbsPathFromAbsAndRel(filePath, absolutePath, elem.findChildValue("relativePath"));
+        queueItemLoadingJob(job);
       }
     }
     n = n.nextSibling();
   }
+  queueItemLoadingJob(finishJob);
 
-  if (topLevelItemCount() != 0 && selectedItems().count() == 0)
-  {
-    // There are items in the playlist, but no item is currently selected.
-    // Select the first item in the playlist.
-    setCurrentItem(0);
-  }
-
-  // A new item was appended. The playlist changed.
-  emit playlistChanged();
   return true;
 }
 
@@ -34,7 +34,10 @@
 #define PLAYLISTTREEWIDGET_H
 
 #include <array>
+#include <QBasicTimer>
 #include <QPointer>
+#include <QQueue>
+#include <QThreadPool>
 #include <QTimer>
 #include <QTreeWidget>
 
@@ -60,7 +63,7 @@ public:
   // If the playlist is empty, this will always return true.
   bool getIsSaved() { return (topLevelItemCount() == 0) ? true : isSaved; }
 
-  // load the given files into the playlist
+  // load the given files into the playlist. The items are created asynchronously (see itemLoadingQueue).
   void loadFiles(const QStringList &files);
 
   // Remove the selected / all items from the playlist tree widget and delete them
@@ -146,6 +149,9 @@ signals:
   // The selected item finished loading the double buffer.
   void selectedItemDoubleBufferLoad(int itemID);
 
+  // A file was added to the list of recently opened files
+  void recentFileListChanged();
+
 protected:
   // Overload from QWidget to create a custom context menu
   virtual void contextMenuEvent(QContextMenuEvent *event) Q_DECL_OVERRIDE;
@@ -198,6 +204,31 @@ private:
   // In the QSettings we keep a list of recent files. Add the given file.
   void addFileToRecentFileSetting(const QString &file);
 
+  // Opening an item can take a while (parsing the bitstream, scanning the file, ...). So the items are not
+  // opened right away when files or a playlist are loaded. A job is queued for every item instead and the first
+  // bytes of all files are read in parallel in the background (in a pool of their own) so that they are in the file
+  // system cache. The timer then opens the items in the given order (only for a limited time per timer event so that
+  // the GUI stays responsive). The prefetching is only a hint: An item is opened without waiting for it. Every item
+  // is usable as soon as it was appended to the playlist. Items that could not be opened are reported at the end
+  // without stopping the other items from loading.
+  struct itemLoadingJob
+  {
+    enum jobType { loadFile, loadPlaylistElement, finishLoadFiles, finishLoadPlaylist };
+    jobType type;
+    QString itemFilePath;     //< The file of the item (if known). It is prefetched and reported if opening fails.
+    QString playlistFilePath; //< The playlist file (loadPlaylistElement)
+    QDomElement element;      //< The playlist element of the item (loadPlaylistElement) or the view states (finishLoadPlaylist)
+  };
+  void queueItemLoadingJob(itemLoadingJob job);
+  void processItemLoadingQueue();
+  QQueue<itemLoadingJob> itemLoadingQueue;
+  QBasicTimer itemLoadingTimer;
+  QThreadPool itemLoadingPrefetchPool;
+  bool itemLoadingRunning {false};
+  QPointer<playlistItem> itemLoadingLastAddedItem;
+  QStringList itemLoadingFailedFiles;
+  virtual void timerEvent(QTimerEvent *event) Q_DECL_OVERRIDE; // Overloaded from QObject. Called when the timer fires.
+
   // Append the new item at the end of the playlist and connect signals/slots
   void appendNewItem(playlistItem *item, bool emitplaylistChanged = true);
 
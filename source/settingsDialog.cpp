@@ -36,12 +36,14 @@
 #include <QFileDialog>
 #include <QMessageBox>
 #include <QSettings>
+#include <QStandardPaths>
 #include <QTextStream>
 #include "typedef.h"
 #include "decoderDav1d.h"
 #include "decoderHM.h"
 #include "decoderLibde265.h"
 #include "FFMpegLibrariesHandling.h"
+#include "videoHandler.h"
 
 #define MIN_CACHE_SIZE_IN_MB (20u)
 
@@ -109,6 +111,7 @@ SettingsDialog::SettingsDialog(QWidget *parent) :
   settings.beginGroup("VideoCache");
   ui.groupBoxCaching->setChecked(settings.value("Enabled", true).toBool());
   ui.sliderThreshold->setValue(settings.value("ThresholdValue", 49).toInt());
+  ui.checkBoxAdaptiveThreshold->setChecked(settings.value("AdaptiveThreshold", false).toBool());
   ui.checkBoxNrThreads->setChecked(settings.value("SetNrThreads", false).toBool());
   if (ui.checkBoxNrThreads->isChecked())
     ui.spinBoxNrThreads->setValue(settings.value("NrThreads", getOptimalThreadCount()).toInt());
@@ -121,6 +124,11 @@ SettingsDialog::SettingsDialog(QWidget *parent) :
   ui.checkBoxEnablePlaybackCaching->setChecked(playbackCaching);
   ui.spinBoxThreadLimit->setValue(settings.value("PlaybackCachingThreadLimit", 1).toInt());
   ui.spinBoxThreadLimit->setEnabled(playbackCaching);
+  // Disk cache
+  ui.groupBoxDiskCache->setChecked(settings.value("DiskCacheEnabled", false).toBool());
+  ui.lineEditDiskCacheDirectory->setText(settings.value("DiskCacheDirectory", QStandardPaths::writableLocation(QStandardPaths::CacheLocation)).toString());
+  ui.spinBoxDiskCacheThreshold->setValue(settings.value("DiskCacheThresholdValueMB", VIDEOHANDLER_DISK_CACHE_DEFAULT_SIZE_MB).toInt());
+  ui.checkBoxDiskCacheCompression->setChecked(settings.value("DiskCacheCompression", false).toBool());
   settings.endGroup();
 
   // "Decoders" tab
@@ -165,6 +173,25 @@ void SettingsDialog::on_checkBoxEnablePlaybackCaching_stateChanged(int state)
   ui.spinBoxThreadLimit->setEnabled(state != Qt::Unchecked);
 }
 
+void SettingsDialog::on_pushButtonDiskCacheSelectDirectory_clicked()
+{
+  // Use the currently selected dir or the dir to YUView if this one does not exist.
+  QDir curDir = QDir(ui.lineEditDiskCacheDirectory->text());
+  if (!curDir.exists())
+    curDir = QDir::currentPath();
+
+  QFileDialog pathDialog(this);
+  pathDialog.setDirectory(curDir);
+  pathDialog.setFileMode(QFileDialog::Directory);
+  pathDialog.setOption(QFileDialog::ShowDirsOnly);
+
+  if (pathDialog.exec())
+  {
+    QString path = pathDialog.selectedFiles()[0];
+    ui.lineEditDiskCacheDirectory->setText(path);
+  }
+}
+
 void SettingsDialog::on_pushButtonEditBackgroundColor_clicked()
 {
   QColor currentColor = ui.frameBackgroundColor->getPlainColor();
@@ -370,11 +397,16 @@ void SettingsDialog::on_pushButtonSave_clicked()
   settings.setValue("Enabled", ui.groupBoxCaching->isChecked());
   settings.setValue("ThresholdValue", ui.sliderThreshold->value());
   settings.setValue("ThresholdValueMB", getCacheSizeInMB());
+  settings.setValue("AdaptiveThreshold", ui.checkBoxAdaptiveThreshold->isChecked());
   settings.setValue("SetNrThreads", ui.checkBoxNrThreads->isChecked());
   settings.setValue("NrThreads", ui.spinBoxNrThreads->value());
   settings.setValue("PlaybackPauseCaching", ui.checkBoxPausPlaybackForCaching->isChecked());
   settings.setValue("PlaybackCachingEnabled", ui.checkBoxEnablePlaybackCaching->isChecked());
   settings.setValue("PlaybackCachingThreadLimit", ui.spinBoxThreadLimit->value());
+  settings.setValue("DiskCacheEnabled", ui.groupBoxDiskCache->isChecked());
+  settings.setValue("DiskCacheDirectory", ui.lineEditDiskCacheDirectory->text());
+  settings.setValue("DiskCacheThresholdValueMB", ui.spinBoxDiskCacheThreshold->value());
+  settings.setValue("DiskCacheCompression", ui.checkBoxDiskCacheCompression->isChecked());
   settings.endGroup();
 
   // "Decoders" tab
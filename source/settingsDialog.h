@@ -53,6 +53,8 @@ private slots:
   // Caching threads check box
   void on_checkBoxNrThreads_stateChanged(int newState);
   void on_checkBoxEnablePlaybackCaching_stateChanged(int state);
+  // Disk cache directory
+  void on_pushButtonDiskCacheSelectDirectory_clicked();
 
   // Colors buttons
   void on_pushButtonEditBackgroundColor_clicked();
@@ -34,6 +34,8 @@
 
 #include <cmath>
 #include <QPainter>
+#include <QPainterPath>
+#include <QSettings>
 #include <QtMath>
 
 // Activate this if you want to know when what is loaded.
@@ -44,6 +46,20 @@
 #define DEBUG_STAT(fmt,...) ((void)0)
 #endif
 
+// The default size of the cache for the statistics of multiple frames (in MB). Can be changed in the settings.
+#define STATISTICS_CACHE_DEFAULT_SIZE_MB 200
+// Only this percentage of the cache budget is planned for prefetching because the statistics of the frames
+// differ in size. The remainder keeps the cache from evicting prefetched frames that were estimated too small.
+#define STATISTICS_CACHE_PREFETCH_PERCENT 80
+// The number of frames that are prefetched as long as no frame was loaded (so that there is no size estimate yet)
+#define STATISTICS_CACHE_PREFETCH_FRAMES_WITHOUT_ESTIMATE 8
+
+// When drawing vectors in batches, the vectors of blocks that are smaller than this (in pixels on screen) are averaged
+// so that there is only one vector per cell of this size.
+#define STATISTICS_VECTOR_MIN_SPACING 8
+// When drawing vectors in batches and the vector color depends on the direction, the hue is quantized to this many steps.
+#define STATISTICS_VECTOR_HUE_STEPS 64
+
 QPoint getPolygonCenter(const QPolygon& polygon)
 {
   QPoint p = QPoint(0, 0);
@@ -58,6 +74,8 @@ QPoint getPolygonCenter(const QPolygon& polygon)
 statisticHandler::statisticHandler()
 {
   statsCacheFrameIdx = -1;
+  statsFrameCacheSize = 0;
+  updateCacheSettings();
 
   spacerItems[0] = nullptr;
   spacerItems[1] = nullptr;
@@ -72,7 +90,12 @@ itemLoadingState statisticHandler::needsLoading(int frameIdx)
     for (StatisticsType t : statsTypeList)
       if(t.render)
       {
-        // At least one statistic type is drawn. We need to load it.
+        // At least one statistic type is drawn. If it is in the cache, paintStatistics() will get it from there.
+        if (isFrameCached(frameIdx))
+        {
+          DEBUG_STAT("statisticHandler::needsLoading %d LoadingNotNeeded (cached)", frameIdx);
+          return LoadingNotNeeded;
+        }
         DEBUG_STAT("statisticHandler::needsLoading %d LoadingNeeded", frameIdx);
         return LoadingNeeded;
       }
@@ -86,7 +109,7 @@ itemLoadingState statisticHandler::needsLoading(int frameIdx)
     int typeIdx = statsTypeList[i].typeID;
     if (statsTypeList[i].render)
     {
-      if (!statsCache.contains(typeIdx))
+      if (!currentStats.contains(typeIdx))
       {
         // Return that loading is needed before we can render the statitics.
         DEBUG_STAT("statisticHandler::needsLoading %d LoadingNeeded", frameIdx);
@@ -104,35 +127,184 @@ void statisticHandler::loadStatistics(int frameIdx)
 {
   DEBUG_STAT("statisticHandler::loadStatistics frame %d", frameIdx);
 
+  QHash<int, statisticsData> frameStats = loadFrameStatistics(frameIdx);
+
   QMutexLocker lock(&statsCacheAccessMutex);
-  if (frameIdx != statsCacheFrameIdx)
-    // New frame to draw. Clear the cache.
-    statsCache.clear();
+  currentStats = frameStats;
+  statsCacheFrameIdx = frameIdx;
+}
+
+void statisticHandler::cacheStatistics(int frameIdx)
+{
+  DEBUG_STAT("statisticHandler::cacheStatistics frame %d", frameIdx);
+  if (!isFrameCached(frameIdx))
+    loadFrameStatistics(frameIdx);
+}
 
-  // Request all the data for the statistics (that were not already loaded to the local cache)
-  int statTypeRenderCount = 0;
+QHash<int, statisticsData> statisticHandler::loadFrameStatistics(int frameIdx)
+{
+  // Only one thread can use the loader at a time
+  QMutexLocker loadingLock(&statsLoadingMutex);
+
+  // Start with what is already in the cache for this frame
+  {
+    QMutexLocker cacheLock(&statsFrameCacheMutex);
+    statsCache = statsFrameCache.value(frameIdx);
+  }
+
+  // Request all the data for the statistics (that were not already loaded to the cache)
   for (int i = statsTypeList.count() - 1; i >= 0; i--)
   {
-    // If the statistics for this frame index were not loaded yet but will be rendered, load them now.
     int typeIdx = statsTypeList[i].typeID;
-    if (statsTypeList[i].render)
-    {
-      statTypeRenderCount++;
-      if (!statsCache.contains(typeIdx))
-        // Load the statistics
-        emit requestStatisticsLoading(frameIdx, typeIdx);
-    }
+    if (statsTypeList[i].render && !statsCache.contains(typeIdx))
+      // Load the statistics
+      emit requestStatisticsLoading(frameIdx, typeIdx);
   }
 
-  statsCacheFrameIdx = frameIdx;
+  QHash<int, statisticsData> frameStats = statsCache;
+  statsCache.clear();
+  addFrameToCache(frameIdx, frameStats);
+  return frameStats;
+}
+
+bool statisticHandler::isFrameCached(int frameIdx) const
+{
+  QMutexLocker cacheLock(&statsFrameCacheMutex);
+  if (!statsFrameCache.contains(frameIdx))
+    return false;
+
+  // All the rendered types must be in the cache
+  const QHash<int, statisticsData> &frameStats = statsFrameCache[frameIdx];
+  for (const StatisticsType &t : statsTypeList)
+    if (t.render && !frameStats.contains(t.typeID))
+      return false;
+  return true;
+}
+
+// Get the approximate number of bytes that are needed to store the statistics data
+static int64_t getStatisticsDataSize(const QHash<int, statisticsData> &frameStats)
+{
+  int64_t size = 0;
+  for (const statisticsData &d : frameStats)
+  {
+    size += d.valueBlocks.count() * (4 * sizeof(unsigned short) + sizeof(int));
+    size += d.vectorBlocks.count() * (4 * sizeof(unsigned short) + 2 * sizeof(QPoint) + sizeof(bool));
+    size += d.affineTFBlocks.count() * (4 * sizeof(unsigned short) + 3 * sizeof(QPoint));
+    for (const statisticsItemPolygon_Value &p : d.polygonValueData)
+      size += sizeof(statisticsItemPolygon_Value) + p.corners.count() * sizeof(QPoint);
+    for (const statisticsItemPolygon_Vector &p : d.polygonVectorData)
+      size += sizeof(statisticsItemPolygon_Vector) + p.corners.count() * sizeof(QPoint);
+  }
+  return size;
+}
+
+void statisticHandler::addFrameToCache(int frameIdx, const QHash<int, statisticsData> &frameStats)
+{
+  QMutexLocker cacheLock(&statsFrameCacheMutex);
+
+  // Add the types to the types that may already be cached for the frame
+  QHash<int, statisticsData> &cachedStats = statsFrameCache[frameIdx];
+  statsFrameCacheSize -= getStatisticsDataSize(cachedStats);
+  statsFrameCacheLRU.removeOne(frameIdx);
+  for (auto it = frameStats.constBegin(); it != frameStats.constEnd(); it++)
+    cachedStats[it.key()] = it.value();
+  statsFrameCacheSize += getStatisticsDataSize(cachedStats);
+  statsFrameCacheLRU.append(frameIdx);
+
+  // Remove the least recently used frames until the cache is within its budget. The new frame always stays.
+  while (statsFrameCacheSize > statsFrameCacheSizeMax && statsFrameCacheLRU.count() > 1)
+  {
+    int removeIdx = statsFrameCacheLRU.takeFirst();
+    statsFrameCacheSize -= getStatisticsDataSize(statsFrameCache.take(removeIdx));
+    DEBUG_STAT("statisticHandler::addFrameToCache removed frame %d", removeIdx);
+  }
+}
+
+void statisticHandler::addStatisticsToCache(int frameIdx, QHash<int, statisticsData> frameStats)
+{
+  // All the types that are not in frameStats have no data for this frame
+  for (const StatisticsType &t : statsTypeList)
+    if (!frameStats.contains(t.typeID))
+      frameStats.insert(t.typeID, statisticsData());
+  addFrameToCache(frameIdx, frameStats);
+}
+
+QList<int> statisticHandler::getCachedFrames() const
+{
+  QMutexLocker cacheLock(&statsFrameCacheMutex);
+  return statsFrameCache.keys();
+}
+
+int statisticHandler::getNumberCachedFrames() const
+{
+  QMutexLocker cacheLock(&statsFrameCacheMutex);
+  return statsFrameCache.count();
+}
+
+int statisticHandler::getCacheFrameLimit() const
+{
+  int64_t frameSize = 0;
+  {
+    QMutexLocker cacheLock(&statsFrameCacheMutex);
+    if (!statsFrameCache.isEmpty())
+      frameSize = statsFrameCacheSize / statsFrameCache.count();
+  }
+  if (frameSize == 0)
+  {
+    // Nothing was cached yet. Use the size of the statistics that are currently drawn (if any).
+    QMutexLocker lock(&statsCacheAccessMutex);
+    frameSize = getStatisticsDataSize(currentStats);
+  }
+  if (frameSize == 0)
+    return STATISTICS_CACHE_PREFETCH_FRAMES_WITHOUT_ESTIMATE;
+
+  int64_t limit = statsFrameCacheSizeMax * STATISTICS_CACHE_PREFETCH_PERCENT / 100 / frameSize;
+  return int(clip(limit, int64_t(1), int64_t(INT_MAX)));
+}
+
+void statisticHandler::removeFrameFromCache(int frameIdx)
+{
+  QMutexLocker cacheLock(&statsFrameCacheMutex);
+  if (statsFrameCache.contains(frameIdx))
+  {
+    statsFrameCacheSize -= getStatisticsDataSize(statsFrameCache.take(frameIdx));
+    statsFrameCacheLRU.removeOne(frameIdx);
+  }
+}
+
+void statisticHandler::clearStatisticsCache()
+{
+  {
+    QMutexLocker cacheLock(&statsFrameCacheMutex);
+    statsFrameCache.clear();
+    statsFrameCacheLRU.clear();
+    statsFrameCacheSize = 0;
+  }
+
+  QMutexLocker lock(&statsCacheAccessMutex);
+  currentStats.clear();
+  statsCacheFrameIdx = -1;
 }
 
 void statisticHandler::paintStatistics(QPainter *painter, int frameIdx, double zoomFactor)
 {
   if (statsCacheFrameIdx != frameIdx)
-    // If the internal statistics cache is not up to date, do not display the statistics.
-    // The statistics for the new frame index should be loading the background.
-    return;
+  {
+    // The statistics for this frame may be in the cache
+    if (isFrameCached(frameIdx))
+    {
+      QMutexLocker cacheLock(&statsFrameCacheMutex);
+      QMutexLocker lock(&statsCacheAccessMutex);
+      currentStats = statsFrameCache.value(frameIdx);
+      statsCacheFrameIdx = frameIdx;
+      statsFrameCacheLRU.removeOne(frameIdx);
+      statsFrameCacheLRU.append(frameIdx);
+    }
+    else
+      // If the internal statistics cache is not up to date, do not display the statistics.
+      // The statistics for the new frame index should be loading the background.
+      return;
+  }
 
   // Save the state of the painter. This is restored when the function is done.
   painter->save();
@@ -180,28 +352,29 @@ void statisticHandler::paintStatistics(QPainter *painter, int frameIdx, double z
   for (int i = statsTypeList.count() - 1; i >= 0; i--)
   {
     int typeIdx = statsTypeList[i].typeID;
-    if (!statsTypeList[i].render || !statsCache.contains(typeIdx))
+    if (!statsTypeList[i].render || !currentStats.contains(typeIdx))
       // This statistics type is not rendered or could not be loaded.
       continue;
 
     // Go through all the value data
-    for (const statisticsItem_Value &valueItem : statsCache[typeIdx].valueData)
+    const statisticsData &data = currentStats[typeIdx];
+    for (int b = 0; b < data.valueBlocks.count(); b++)
     {
       // Calculate the size and position of the rectangle to draw (zoomed in)
-      QRect rect = QRect(valueItem.pos[0], valueItem.pos[1], valueItem.size[0], valueItem.size[1]);
+      QRect rect = data.valueBlocks.getRect(b);
       QRect displayRect = QRect(rect.left()*zoomFactor, rect.top()*zoomFactor, rect.width()*zoomFactor, rect.height()*zoomFactor);
       // Check if the rectangle of the statistics item is even visible
       bool rectVisible = (!(displayRect.left() > xMax || displayRect.right() < xMin || displayRect.top() > yMax || displayRect.bottom() < yMin));
 
       if (rectVisible)
       {
-        int value = valueItem.value; // This value determines the color for this item
+        int value = data.values[b]; // This value determines the color for this item
         if (statsTypeList[i].renderValueData)
         {
           // Get the right color for the item and draw it.
           QColor rectColor;
           if (statsTypeList[i].scaleValueToBlockSize)
-            rectColor = statsTypeList[i].colMapper.getColor(float(value) / (valueItem.size[0] * valueItem.size[1]));
+            rectColor = statsTypeList[i].colMapper.getColor(float(value) / (rect.width() * rect.height()));
           else
             rectColor = statsTypeList[i].colMapper.getColor(value);
           rectColor.setAlpha(rectColor.alpha()*((float)statsTypeList[i].alphaFactor / 100.0));
@@ -231,7 +404,7 @@ void statisticHandler::paintStatistics(QPainter *painter, int frameIdx, double z
         {
           QString valTxt  = statsTypeList[i].getValueTxt(value);
           if (!statsTypeList[i].valMap.contains(value) && statsTypeList[i].scaleValueToBlockSize)
-            valTxt = QString("%1").arg(float(value) / (valueItem.size[0] * valueItem.size[1]));
+            valTxt = QString("%1").arg(float(value) / (rect.width() * rect.height()));
 
           QString typeTxt = statsTypeList[i].typeName;
           QString statTxt = moreThanOneBlockStatRendered ? typeTxt + ":" + valTxt : valTxt;
@@ -259,12 +432,12 @@ void statisticHandler::paintStatistics(QPainter *painter, int frameIdx, double z
   for (int i = statsTypeList.count() - 1; i >= 0; i--)
   {
     int typeIdx = statsTypeList[i].typeID;
-    if (!statsTypeList[i].render || !statsCache.contains(typeIdx))
+    if (!statsTypeList[i].render || !currentStats.contains(typeIdx))
       // This statistics type is not rendered or could not be loaded.
       continue;
 
     // Go through all the value data
-    for (const statisticsItemPolygon_Value &valueItem : statsCache[typeIdx].polygonValueData)
+    for (const statisticsItemPolygon_Value &valueItem : currentStats[typeIdx].polygonValueData)
     {
       // Calculate the size and position of the rectangle to draw (zoomed in)
       QRect boundingRect = valueItem.corners.boundingRect();
@@ -355,28 +528,33 @@ void statisticHandler::paintStatistics(QPainter *painter, int frameIdx, double z
   for (int i = statsTypeList.count() - 1; i >= 0; i--)
   {
     int typeIdx = statsTypeList[i].typeID;
-    if (!statsTypeList[i].render || !statsCache.contains(typeIdx))
+    if (!statsTypeList[i].render || !currentStats.contains(typeIdx))
       // This statistics type is not rendered or could not be loaded.
       continue;
 
-    // Go through all the vector data
-    for (const statisticsItem_Vector &vectorItem : statsCache[typeIdx].vectorData)
+    // Go through all the vector data. If the values of the vectors are not drawn, all vectors are drawn in batches
+    // after the loop. Otherwise they are drawn one by one.
+    const statisticsData &data = currentStats[typeIdx];
+    const bool drawVectorValues = zoomFactor >= STATISTICS_DRAW_VALUES_ZOOM && statsTypeList[i].renderVectorDataValues;
+    QVector<QRect> gridRects;
+    for (int b = 0; b < data.vectorBlocks.count(); b++)
     {
       // Calculate the size and position of the rectangle to draw (zoomed in)
-      const QRect rect = QRect(vectorItem.pos[0], vectorItem.pos[1], vectorItem.size[0], vectorItem.size[1]);
+      const QRect rect = data.vectorBlocks.getRect(b);
+      const bool isLine = data.vectorIsLine[b];
       const QRect displayRect = QRect(rect.left()*zoomFactor, rect.top()*zoomFactor, rect.width()*zoomFactor, rect.height()*zoomFactor);
       
-      if (statsTypeList[i].renderVectorData)
+      if (statsTypeList[i].renderVectorData && drawVectorValues)
       {
         // Calculate the start and end point of the arrow. The vector starts at center of the block.
         int x1,y1,x2,y2;
         float vx, vy;
-        if (vectorItem.isLine)
+        if (isLine)
         {
-          x1 = displayRect.left() + zoomFactor*vectorItem.point[0].x();
-          y1 = displayRect.top() + zoomFactor*vectorItem.point[0].y();
-          x2 = displayRect.left() + zoomFactor*vectorItem.point[1].x();
-          y2 = displayRect.top() + zoomFactor*vectorItem.point[1].y();
+          x1 = displayRect.left() + zoomFactor*data.vectors[b].x();
+          y1 = displayRect.top() + zoomFactor*data.vectors[b].y();
+          x2 = displayRect.left() + zoomFactor*data.lineEnds[b].x();
+          y2 = displayRect.top() + zoomFactor*data.lineEnds[b].y();
           vx = (float)(x2-x1) / statsTypeList[i].vectorScale;
           vy = (float)(y2-y1) / statsTypeList[i].vectorScale;
         }
@@ -386,8 +564,8 @@ void statisticHandler::paintStatistics(QPainter *painter, int frameIdx, double z
           y1 = displayRect.top() + displayRect.height() / 2;
 
           // The length of the vector
-          vx = (float)vectorItem.point[0].x() / statsTypeList[i].vectorScale;
-          vy = (float)vectorItem.point[0].y() / statsTypeList[i].vectorScale;
+          vx = (float)data.vectors[b].x() / statsTypeList[i].vectorScale;
+          vy = (float)data.vectors[b].y() / statsTypeList[i].vectorScale;
 
           // The end point of the vector
           x2 = x1 + zoomFactor * vx;
@@ -407,7 +585,7 @@ void statisticHandler::paintStatistics(QPainter *painter, int frameIdx, double z
           vectorPen.setColor(arrowColor);
           if (statsTypeList[i].scaleVectorToZoom)
             vectorPen.setWidthF(vectorPen.widthF() * zoomFactor / 8);
-          if (vectorItem.isLine)
+          if (isLine)
               vectorPen.setCapStyle(Qt::RoundCap);
           painter->setPen(vectorPen);
           painter->setBrush(arrowColor);
@@ -461,7 +639,7 @@ void statisticHandler::paintStatistics(QPainter *painter, int frameIdx, double z
 
             if (zoomFactor >= STATISTICS_DRAW_VALUES_ZOOM && statsTypeList[i].renderVectorDataValues)
             {
-              if (vectorItem.isLine)
+              if (isLine)
               {
                 // if we just draw a line, we want to simply see the coordinate pairs
                 QString txt1 = QString("(%1, %2)").arg(x1/zoomFactor).arg(y1/zoomFactor);
@@ -529,28 +707,30 @@ void statisticHandler::paintStatistics(QPainter *painter, int frameIdx, double z
 
       // Check if the rectangle of the statistics item is even visible
       const bool rectVisible = (!(displayRect.left() > xMax || displayRect.right() < xMin || displayRect.top() > yMax || displayRect.bottom() < yMin));
-      if (rectVisible)
-      {
-        // optionally, draw a grid around the region that the arrow is defined for
-        if (statsTypeList[i].renderGrid && rectVisible)
-        {
-          QPen gridPen = statsTypeList[i].gridPen;
-          if (statsTypeList[i].scaleGridToZoom)
-            gridPen.setWidthF(gridPen.widthF() * zoomFactor);
+      // optionally, draw a grid around the region that the arrow is defined for
+      if (statsTypeList[i].renderGrid && rectVisible)
+        gridRects.append(displayRect);
+    }
 
-          painter->setPen(gridPen);
-          painter->setBrush(QBrush(QColor(Qt::color0), Qt::NoBrush));  // no fill color
+    if (!gridRects.isEmpty())
+    {
+      QPen gridPen = statsTypeList[i].gridPen;
+      if (statsTypeList[i].scaleGridToZoom)
+        gridPen.setWidthF(gridPen.widthF() * zoomFactor);
 
-          painter->drawRect(displayRect);
-        }
-      }
+      painter->setPen(gridPen);
+      painter->setBrush(QBrush(QColor(Qt::color0), Qt::NoBrush));  // no fill color
+      painter->drawRects(gridRects);
     }
 
+    if (statsTypeList[i].renderVectorData && !drawVectorValues)
+      paintVectorsBatched(painter, statsTypeList[i], data, zoomFactor, xMin, xMax, yMin, yMax);
+
     // Go through all the affine transform data
-    for (const statisticsItem_AffineTF &affineTFItem : statsCache[typeIdx].affineTFData)
+    for (int b = 0; b < data.affineTFBlocks.count(); b++)
     {
       // Calculate the size and position of the rectangle to draw (zoomed in)
-      const QRect rect = QRect(affineTFItem.pos[0], affineTFItem.pos[1], affineTFItem.size[0], affineTFItem.size[1]);
+      const QRect rect = data.affineTFBlocks.getRect(b);
       const QRect displayRect = QRect(rect.left()*zoomFactor, rect.top()*zoomFactor, rect.width()*zoomFactor, rect.height()*zoomFactor);
       // Check if the rectangle of the statistics item is even visible
       const bool rectVisible = (!(displayRect.left() > xMax || displayRect.right() < xMin || displayRect.top() > yMax || displayRect.bottom() < yMin));
@@ -573,12 +753,12 @@ void statisticHandler::paintStatistics(QPainter *painter, int frameIdx, double z
           yLBstart = displayRect.bottom();
 
           // The length of the vectors
-          vxLT = (float)affineTFItem.point[0].x() / statsTypeList[i].vectorScale;
-          vyLT = (float)affineTFItem.point[0].y() / statsTypeList[i].vectorScale;
-          vxRT = (float)affineTFItem.point[1].x() / statsTypeList[i].vectorScale;
-          vyRT = (float)affineTFItem.point[1].y() / statsTypeList[i].vectorScale;
-          vxLB = (float)affineTFItem.point[2].x() / statsTypeList[i].vectorScale;
-          vyLB = (float)affineTFItem.point[2].y() / statsTypeList[i].vectorScale;
+          vxLT = (float)data.affineTFVectors[3*b+0].x() / statsTypeList[i].vectorScale;
+          vyLT = (float)data.affineTFVectors[3*b+0].y() / statsTypeList[i].vectorScale;
+          vxRT = (float)data.affineTFVectors[3*b+1].x() / statsTypeList[i].vectorScale;
+          vyRT = (float)data.affineTFVectors[3*b+1].y() / statsTypeList[i].vectorScale;
+          vxLB = (float)data.affineTFVectors[3*b+2].x() / statsTypeList[i].vectorScale;
+          vyLB = (float)data.affineTFVectors[3*b+2].y() / statsTypeList[i].vectorScale;
 
           // The end point of the vectors
           xLTend = xLTstart + zoomFactor * vxLT;
@@ -614,12 +794,12 @@ void statisticHandler::paintStatistics(QPainter *painter, int frameIdx, double z
   for (int i = statsTypeList.count() - 1; i >= 0; i--)
   {
     int typeIdx = statsTypeList[i].typeID;
-    if (!statsTypeList[i].render || !statsCache.contains(typeIdx))
+    if (!statsTypeList[i].render || !currentStats.contains(typeIdx))
       // This statistics type is not rendered or could not be loaded.
       continue;
 
     // Go through all the vector data
-    for (const statisticsItemPolygon_Vector &vectorItem : statsCache[typeIdx].polygonVectorData)
+    for (const statisticsItemPolygon_Vector &vectorItem : currentStats[typeIdx].polygonVectorData)
     {
       // Calculate the size and position of the rectangle to draw (zoomed in)
       QTransform trans;
@@ -766,6 +946,159 @@ void statisticHandler::paintStatistics(QPainter *painter, int frameIdx, double z
   painter->restore();
 }
 
+void statisticHandler::paintVectorsBatched(QPainter *painter, const StatisticsType &type, const statisticsData &data, double zoomFactor,
+                                           int xMin, int xMax, int yMin, int yMax)
+{
+  // The vectors (index 0) and lines (index 1) are sorted by their color. Each batch is drawn with one call.
+  struct vectorBatch
+  {
+    QVector<QLineF> lines;
+    QPainterPath heads;
+  };
+  QHash<QRgb, vectorBatch> batches[2];
+
+  // Get the color of a vector. If the color depends on the direction, the hue is quantized so that there are not too many batches.
+  auto getVectorColor = [&type](float vx, float vy)
+  {
+    QColor arrowColor = type.vectorPen.color();
+    if (type.mapVectorToColor)
+    {
+      const int hueStep = clip(int((atan2f(vy,vx)+M_PI)/(2*M_PI) * STATISTICS_VECTOR_HUE_STEPS), 0, STATISTICS_VECTOR_HUE_STEPS - 1);
+      arrowColor.setHsvF(double(hueStep) / STATISTICS_VECTOR_HUE_STEPS, 1.0, 1.0);
+    }
+    arrowColor.setAlpha(arrowColor.alpha()*((float)type.alphaFactor / 100.0));
+    return arrowColor.rgba();
+  };
+
+  // Add the (possibly) visible arrow to the batch of its color. The geometry is the same as in paintVector.
+  auto addArrow = [&](bool isLine, int x1, int y1, int x2, int y2, float vx, float vy)
+  {
+    if ((x1 < xMin && x2 < xMin) || (x1 > xMax && x2 > xMax) || (y1 < yMin && y2 < yMin) || (y1 > yMax && y2 > yMax))
+      return;
+
+    vectorBatch &batch = batches[isLine ? 1 : 0][getVectorColor(vx, vy)];
+    if (zoomFactor <= 1)
+    {
+      // No arrow head is drawn. Only draw a line.
+      batch.lines.append(QLineF(x1, y1, x2, y2));
+      return;
+    }
+    if (vx == 0 && vy == 0)
+      return;
+
+    const qreal angle = qAtan2(vy, vx);
+    const int headSize = (zoomFactor >= STATISTICS_DRAW_VALUES_ZOOM && !type.scaleVectorToZoom) ? 8 : zoomFactor/2;
+    if (type.arrowHead != StatisticsType::arrowHead_t::none)
+    {
+      // We draw an arrow head. This means that we will have to draw a shortened line
+      const int shorten = (type.arrowHead == StatisticsType::arrowHead_t::arrow) ? headSize * 2 : headSize * 0.5;
+      if (sqrt(vx*vx*zoomFactor*zoomFactor + vy*vy*zoomFactor*zoomFactor) > shorten)
+        batch.lines.append(QLineF(x1, y1, double(x2) - cos(angle) * shorten, double(y2) - sin(angle) * shorten));
+    }
+    else
+      batch.lines.append(QLineF(x1, y1, x2, y2));
+
+    if (type.arrowHead == StatisticsType::arrowHead_t::arrow)
+    {
+      // The triangle of the arrow tip rotated in the direction of the vector
+      const qreal c = cos(angle);
+      const qreal s = sin(angle);
+      QPolygonF tip;
+      tip << QPointF(x2, y2);
+      tip << QPointF(x2 - headSize*2*c + headSize*s, y2 - headSize*2*s - headSize*c);
+      tip << QPointF(x2 - headSize*2*c - headSize*s, y2 - headSize*2*s + headSize*c);
+      batch.heads.addPolygon(tip);
+      batch.heads.closeSubpath();
+    }
+    else if (type.arrowHead == StatisticsType::arrowHead_t::circle)
+      batch.heads.addEllipse(x2-headSize/2, y2-headSize/2, headSize, headSize);
+  };
+
+  // Vectors of blocks which are smaller than STATISTICS_VECTOR_MIN_SPACING on screen are averaged in a grid of cells
+  // with this size which covers the visible area. Drawing all of them would only result in an unreadable mess anyway.
+  struct vectorCell
+  {
+    float x {0}, y {0};
+    float vx {0}, vy {0};
+    int count {0};
+  };
+  QVector<vectorCell> cells;
+  const int gridWidth = (xMax - xMin) / STATISTICS_VECTOR_MIN_SPACING + 1;
+  const int gridHeight = (yMax - yMin) / STATISTICS_VECTOR_MIN_SPACING + 1;
+
+  for (int b = 0; b < data.vectorBlocks.count(); b++)
+  {
+    const QRect rect = data.vectorBlocks.getRect(b);
+    const QRect displayRect = QRect(rect.left()*zoomFactor, rect.top()*zoomFactor, rect.width()*zoomFactor, rect.height()*zoomFactor);
+
+    if (data.vectorIsLine[b])
+    {
+      const int x1 = displayRect.left() + zoomFactor*data.vectors[b].x();
+      const int y1 = displayRect.top() + zoomFactor*data.vectors[b].y();
+      const int x2 = displayRect.left() + zoomFactor*data.lineEnds[b].x();
+      const int y2 = displayRect.top() + zoomFactor*data.lineEnds[b].y();
+      addArrow(true, x1, y1, x2, y2, (float)(x2-x1) / type.vectorScale, (float)(y2-y1) / type.vectorScale);
+      continue;
+    }
+
+    // The vector starts at the center of the block
+    const int x1 = displayRect.left() + displayRect.width() / 2;
+    const int y1 = displayRect.top() + displayRect.height() / 2;
+    const float vx = (float)data.vectors[b].x() / type.vectorScale;
+    const float vy = (float)data.vectors[b].y() / type.vectorScale;
+
+    if (displayRect.width() < STATISTICS_VECTOR_MIN_SPACING && displayRect.height() < STATISTICS_VECTOR_MIN_SPACING &&
+        x1 >= xMin && x1 <= xMax && y1 >= yMin && y1 <= yMax)
+    {
+      if (cells.isEmpty())
+        cells.resize(gridWidth * gridHeight);
+      vectorCell &cell = cells[(y1 - yMin) / STATISTICS_VECTOR_MIN_SPACING * gridWidth + (x1 - xMin) / STATISTICS_VECTOR_MIN_SPACING];
+      cell.x += x1;
+      cell.y += y1;
+      cell.vx += vx;
+      cell.vy += vy;
+      cell.count++;
+      continue;
+    }
+
+    addArrow(false, x1, y1, x1 + zoomFactor * vx, y1 + zoomFactor * vy, vx, vy);
+  }
+
+  for (const vectorCell &cell : cells)
+  {
+    if (cell.count == 0)
+      continue;
+    const int x1 = cell.x / cell.count;
+    const int y1 = cell.y / cell.count;
+    const float vx = cell.vx / cell.count;
+    const float vy = cell.vy / cell.count;
+    addArrow(false, x1, y1, x1 + zoomFactor * vx, y1 + zoomFactor * vy, vx, vy);
+  }
+
+  // Draw all batches
+  QPen vectorPen = type.vectorPen;
+  if (type.scaleVectorToZoom)
+    vectorPen.setWidthF(vectorPen.widthF() * zoomFactor / 8);
+  for (int l = 0; l < 2; l++)
+  {
+    if (l == 1)
+      vectorPen.setCapStyle(Qt::RoundCap);
+    for (auto it = batches[l].begin(); it != batches[l].end(); it++)
+    {
+      const QColor arrowColor = QColor::fromRgba(it.key());
+      vectorPen.setColor(arrowColor);
+      painter->setPen(vectorPen);
+      painter->setBrush(arrowColor);
+      painter->drawLines(it->lines);
+      if (!it->heads.isEmpty())
+      {
+        it->heads.setFillRule(Qt::WindingFill);
+        painter->drawPath(it->heads);
+      }
+    }
+  }
+}
+
 void statisticHandler::paintVector(QPainter *painter, const int& statTypeIdx, const double& zoomFactor,
                                    const int& x1, const int& y1, const int& x2, const int& y2,
                                    const float& vx, const float& vy, bool isLine,
@@ -932,35 +1265,36 @@ QStringPairList statisticHandler::getValuesAt(const QPoint &pos)
 
       // Get all value data entries
       bool foundStats = false;
-      for (const statisticsItem_Value &valueItem : statsCache[typeID].valueData)
+      const statisticsData &data = currentStats[typeID];
+      for (int b = 0; b < data.valueBlocks.count(); b++)
       {
-        QRect rect = QRect(valueItem.pos[0], valueItem.pos[1], valueItem.size[0], valueItem.size[1]);
+        QRect rect = data.valueBlocks.getRect(b);
         if (rect.contains(pos))
         {
-          int value = valueItem.value;
+          int value = data.values[b];
           QString valTxt  = statsTypeList[i].getValueTxt(value);
           if (!statsTypeList[i].valMap.contains(value) && statsTypeList[i].scaleValueToBlockSize)
-            valTxt = QString("%1").arg(float(value) / (valueItem.size[0] * valueItem.size[1]));
+            valTxt = QString("%1").arg(float(value) / (rect.width() * rect.height()));
           valueList.append(QStringPair(aType->typeName, valTxt));
           foundStats = true;
         }
       }
 
-      for (const statisticsItem_Vector &vectorItem : statsCache[typeID].vectorData)
+      for (int b = 0; b < data.vectorBlocks.count(); b++)
       {
-        QRect rect = QRect(vectorItem.pos[0], vectorItem.pos[1], vectorItem.size[0], vectorItem.size[1]);
+        QRect rect = data.vectorBlocks.getRect(b);
         if (rect.contains(pos))
         {
           float vectorValue1, vectorValue2;
-          if (vectorItem.isLine)
+          if (data.vectorIsLine[b])
           {
-           vectorValue1 = (float)(vectorItem.point[1].x() - vectorItem.point[0].x()) / statsTypeList[i].vectorScale;
-           vectorValue2 = (float)(vectorItem.point[1].y() - vectorItem.point[0].y()) / statsTypeList[i].vectorScale;
+           vectorValue1 = (float)(data.lineEnds[b].x() - data.vectors[b].x()) / statsTypeList[i].vectorScale;
+           vectorValue2 = (float)(data.lineEnds[b].y() - data.vectors[b].y()) / statsTypeList[i].vectorScale;
           }
           else
           {
-            vectorValue1 = (float)vectorItem.point[0].x() / statsTypeList[i].vectorScale;
-            vectorValue2 = (float)vectorItem.point[0].y() / statsTypeList[i].vectorScale;
+            vectorValue1 = (float)data.vectors[b].x() / statsTypeList[i].vectorScale;
+            vectorValue2 = (float)data.vectors[b].y() / statsTypeList[i].vectorScale;
           }
           valueList.append(QStringPair(QString("%1[x]").arg(aType->typeName), QString::number(vectorValue1)));
           valueList.append(QStringPair(QString("%1[y]").arg(aType->typeName), QString::number(vectorValue2)));
@@ -1210,8 +1544,19 @@ void statisticHandler::loadPlaylist(const QDomElementYUView &root)
     statsTypeList[row].loadPlaylist(root);
 }
 
+void statisticHandler::updateCacheSettings()
+{
+  // The statistics cache has its own budget which is independent of the video cache
+  QSettings settings;
+  settings.beginGroup("VideoCache");
+  statsFrameCacheSizeMax = (int64_t)settings.value("StatisticsThresholdValueMB", STATISTICS_CACHE_DEFAULT_SIZE_MB).toUInt() * 1000 * 1000;
+  settings.endGroup();
+}
+
 void statisticHandler::updateSettings()
 {
+  updateCacheSettings();
+
   for (int row = 0; row < statsTypeList.length(); ++row)
   {
     itemStyleButtons[0][row]->setIcon(convertIcon(":img_edit.png"));
@@ -1362,6 +1707,9 @@ void statisticHandler::clearStatTypes()
 
   // Clear the old list. New items can be added now.
   statsTypeList.clear();
+
+  // The cached statistics belong to the old types
+  clearStatisticsCache();
 }
 
 void statisticHandler::onStyleButtonClicked(int id)
@@ -90,6 +90,23 @@ public:
   // data that is needed to render the statistics for the given frame.
   void loadStatistics(int frameIdx);
 
+  // --- Caching ---
+  // The statistics of multiple frames are kept in a cache with its own size limit (independent of the video cache).
+  // Revisiting a frame that is in the cache does not need any loading. These functions are thread-safe.
+  // Load the statistics of the given frame into the cache without changing what is currently drawn.
+  void cacheStatistics(int frameIdx);
+  // Add the statistics of all types for the given frame to the cache (e.g. statistics that a decoder
+  // extracted while decoding). Types that are not in frameStats have no data in this frame.
+  void addStatisticsToCache(int frameIdx, QHash<int, statisticsData> frameStats);
+  bool isFrameCached(int frameIdx) const;
+  QList<int> getCachedFrames() const;
+  int getNumberCachedFrames() const;
+  // Estimate how many frames fit into the cache budget (from the size of the frames that were already loaded)
+  int getCacheFrameLimit() const;
+  void removeFrameFromCache(int frameIdx);
+  // Clear the cache and the currently drawn statistics. Everything will be loaded again.
+  void clearStatisticsCache();
+
   // Get the statisticsType with the given typeID from p_statsTypeList
   StatisticsType *getStatisticsType(int typeID);
 
@@ -108,7 +125,9 @@ public:
   void savePlaylist(QDomElementYUView &root) const;
   void loadPlaylist(const QDomElementYUView &root);
 
-  QHash<int, statisticsData> statsCache; // cache of the statistics for the current POC [statsTypeID]
+  // When requestStatisticsLoading() is emitted, the requested statistics must be put in here [statsTypeID]
+  QHash<int, statisticsData> statsCache;
+  // The frame index of the statistics that are currently drawn
   int statsCacheFrameIdx;
 
   // Update the settings. For the statistics this means updating the icons for editing statistic.
@@ -125,8 +144,31 @@ private:
   // The frame size of the statistics. Needed for drawing the statistics at the right position.
   QSize statFrameSize;
 
+  // The statistics that are currently drawn (of frame statsCacheFrameIdx) [statsTypeID]
+  QHash<int, statisticsData> currentStats;
+
+  // Draw all vectors of the given type in batches (one draw call per color). Vectors of small blocks are averaged
+  // (see STATISTICS_VECTOR_MIN_SPACING). This does not draw the vector values.
+  void paintVectorsBatched(QPainter *painter, const StatisticsType &type, const statisticsData &data, double zoomFactor,
+                           int xMin, int xMax, int yMin, int yMax);
   // Make sure that nothing is read from the stats cache while it is being changed.
-  QMutex statsCacheAccessMutex;
+  QMutex mutable statsCacheAccessMutex;
+
+  // Load the rendered statistics of the given frame (from the cache or using requestStatisticsLoading) and add them to the cache.
+  QHash<int, statisticsData> loadFrameStatistics(int frameIdx);
+  // Only one thread at a time can request statistics to be loaded.
+  QMutex statsLoadingMutex;
+
+  // The cache of the statistics of multiple frames [frameIdx][statsTypeID]. If the cache gets too big, the least
+  // recently used frames (at the front of statsFrameCacheLRU) are removed. Adding a frame that is already in
+  // the cache adds the given types to it.
+  void addFrameToCache(int frameIdx, const QHash<int, statisticsData> &frameStats);
+  void updateCacheSettings();
+  QMap<int, QHash<int, statisticsData> > statsFrameCache;
+  QList<int> statsFrameCacheLRU;
+  int64_t statsFrameCacheSize;
+  int64_t statsFrameCacheSizeMax;
+  QMutex mutable statsFrameCacheMutex;
 
   // The list of all statistics that this class can provide (and a backup for updating the list)
   StatisticsTypeList statsTypeList;
@@ -309,60 +309,101 @@ QString StatisticsType::getValueTxt(int val)
   return QString("%1").arg(val);
 }
 
+void statisticsBlockList::reserve(int size)
+{
+  posX.reserve(size);
+  posY.reserve(size);
+  width.reserve(size);
+  height.reserve(size);
+}
+
+void statisticsBlockList::append(unsigned short x, unsigned short y, unsigned short w, unsigned short h)
+{
+  posX.append(x);
+  posY.append(y);
+  width.append(w);
+  height.append(h);
+}
+
+void statisticsBlockList::append(const statisticsBlockList &blocks)
+{
+  posX += blocks.posX;
+  posY += blocks.posY;
+  width += blocks.width;
+  height += blocks.height;
+}
+
 void statisticsData::addBlockValue(unsigned short x, unsigned short y, unsigned short w, unsigned short h, int val)
 {
-  statisticsItem_Value value;
-  value.pos[0] = x;
-  value.pos[1] = y;
-  value.size[0] = w;
-  value.size[1] = h;
-  value.value = val;
+  valueBlocks.append(x, y, w, h);
+  values.append(val);
 
   // Always keep the biggest block size updated.
   unsigned int wh = w*h;
   if (wh > maxBlockSize)
     maxBlockSize = wh;
+}
 
-  valueData.append(value);
+void statisticsData::reserveBlockValues(int size)
+{
+  valueBlocks.reserve(size);
+  values.reserve(size);
+}
+
+void statisticsData::reserveBlockVectors(int size)
+{
+  vectorBlocks.reserve(size);
+  vectors.reserve(size);
+  lineEnds.reserve(size);
+  vectorIsLine.reserve(size);
+}
+
+void statisticsData::addBlockValues(const statisticsBlockList &blocks, const QVector<int> &vals)
+{
+  Q_ASSERT_X(blocks.count() == vals.count(), "statisticsData::addBlockValues", "The number of blocks and values must match");
+  valueBlocks.append(blocks);
+  values += vals;
+
+  // Always keep the biggest block size updated.
+  for (int i = 0; i < blocks.count(); i++)
+  {
+    unsigned int wh = blocks.width[i] * blocks.height[i];
+    if (wh > maxBlockSize)
+      maxBlockSize = wh;
+  }
+}
+
+void statisticsData::addBlockVectors(const statisticsBlockList &blocks, const QVector<QPoint> &vecs)
+{
+  Q_ASSERT_X(blocks.count() == vecs.count(), "statisticsData::addBlockVectors", "The number of blocks and vectors must match");
+  vectorBlocks.append(blocks);
+  vectors += vecs;
+  lineEnds.resize(lineEnds.count() + vecs.count());
+  vectorIsLine.resize(vectorIsLine.count() + vecs.count());
 }
 
 void statisticsData::addBlockVector(unsigned short x, unsigned short y, unsigned short w, unsigned short h, int vecX, int vecY)
 {
-  statisticsItem_Vector vec;
-  vec.pos[0] = x;
-  vec.pos[1] = y;
-  vec.size[0] = w;
-  vec.size[1] = h;
-  vec.point[0] = QPoint(vecX,vecY);
-  vec.isLine = false;
-  vectorData.append(vec);
+  vectorBlocks.append(x, y, w, h);
+  vectors.append(QPoint(vecX,vecY));
+  lineEnds.append(QPoint());
+  vectorIsLine.append(false);
 }
 
 void statisticsData::addBlockAffineTF(unsigned short x, unsigned short y, unsigned short w, unsigned short h, int vecX0, int vecY0, int vecX1, int vecY1, int vecX2, int vecY2)
 {
-  statisticsItem_AffineTF affineTF;
-  affineTF.pos[0] = x;
-  affineTF.pos[1] = y;
-  affineTF.size[0] = w;
-  affineTF.size[1] = h;
-  affineTF.point[0] = QPoint(vecX0,vecY0);
-  affineTF.point[1] = QPoint(vecX1,vecY1);
-  affineTF.point[2] = QPoint(vecX2,vecY2);
-  affineTFData.append(affineTF);
+  affineTFBlocks.append(x, y, w, h);
+  affineTFVectors.append(QPoint(vecX0,vecY0));
+  affineTFVectors.append(QPoint(vecX1,vecY1));
+  affineTFVectors.append(QPoint(vecX2,vecY2));
 }
 
-
 void statisticsData::addLine(unsigned short x, unsigned short y, unsigned short w, unsigned short h, int x1, int y1, int x2, int y2)
 {
-  statisticsItem_Vector vec;
-  vec.pos[0] = x;
-  vec.pos[1] = y;
-  vec.size[0] = w;
-  vec.size[1] = h;
-  vec.point[0] = QPoint(x1,y1);
-  vec.point[1] = QPoint(x2,y2);
-  vec.isLine = true;
-  vectorData.append(vec);
+  vectorBlocks.append(x, y, w, h);
+  vectors.append(QPoint(x1,y1));
+  lineEnds.append(QPoint(x2,y2));
+  vectorIsLine.append(true);
 }
 
 void statisticsData::addPolygonValue(const QVector<QPoint> &points, int val)
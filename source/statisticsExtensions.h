@@ -36,6 +36,9 @@
 #include <QColor>
 #include <QMap>
 #include <QPen>
+#include <QPolygon>
+#include <QRect>
+#include <QVector>
 
 class QDomElementYUView;
 
@@ -180,36 +183,19 @@ private:
   initialState init;
 };
 
-struct statisticsItem_Value
+// The positions and sizes (max 65535) of a list of blocks. Each property is stored in its own contiguous array
+// so that adding blocks needs no allocation per block and going through all blocks is cache friendly.
+class statisticsBlockList
 {
-  // The position and size of the item. (max 65535)
-  unsigned short pos[2];
-  unsigned short size[2];
-
-  // The actual value
-  int value;
-};
-
-struct statisticsItem_Vector
-{
-  // The position and size of the item. (max 65535)
-  unsigned short pos[2];
-  unsigned short size[2];
-
-  bool isLine; // the vector is specified by two points
-  // The actual vector value
-  QPoint point[2];
-};
-
-struct statisticsItem_AffineTF
-{
-  // The position and size of the item. (max 65535)
-  unsigned short pos[2];
-  unsigned short size[2];
-
-  // the vector is specified by two points
-  // The actual vector value
-  QPoint point[3];
+public:
+  int count() const { return posX.count(); }
+  void reserve(int size);
+  void append(unsigned short x, unsigned short y, unsigned short w, unsigned short h);
+  void append(const statisticsBlockList &blocks);
+  QRect getRect(int i) const { return QRect(posX[i], posY[i], width[i], height[i]); }
+
+  QVector<unsigned short> posX, posY;
+  QVector<unsigned short> width, height;
 };
 
 struct statisticsItemPolygon_Value
@@ -230,8 +216,8 @@ struct statisticsItemPolygon_Vector
   QPoint point[2];
 };
 
-
 // A collection of statistics data (value and vector) for a certain context (for example for a certain type and a certain POC).
+// The block data is stored as a structure of arrays. Entry i of the value/vector arrays belongs to block i of the block list.
 class statisticsData
 {
 public:
@@ -243,11 +229,32 @@ public:
   void addPolygonVector(const QVector<QPoint> &points, int vecX, int vecY);
   void addPolygonValue(const QVector<QPoint> &points, int val);
 
-  QList<statisticsItem_Value> valueData;
-  QList<statisticsItem_Vector> vectorData;
-  QList<statisticsItem_AffineTF> affineTFData;
-  QList<statisticsItemPolygon_Value> polygonValueData;
-  QList<statisticsItemPolygon_Vector> polygonVectorData;
+  // If the number of blocks is known in advance, reserve the memory for them at once. Adding the blocks will then not
+  // allocate any more memory.
+  void reserveBlockValues(int size);
+  void reserveBlockVectors(int size);
+  // Add a batch of blocks at once (vals[i]/vecs[i] belongs to block i). The arrays grow geometrically so adding
+  // many batches one after another does not copy the data over and over again.
+  void addBlockValues(const statisticsBlockList &blocks, const QVector<int> &vals);
+  void addBlockVectors(const statisticsBlockList &blocks, const QVector<QPoint> &vecs);
+
+  // Block value data. values[i] is the value of block i.
+  statisticsBlockList valueBlocks;
+  QVector<int> values;
+
+  // Block vector data. For a vector, vectors[i] is the vector of block i. For a line, vectors[i]
+  // is the start and lineEnds[i] the end point of the line (relative to the block position).
+  statisticsBlockList vectorBlocks;
+  QVector<QPoint> vectors;
+  QVector<QPoint> lineEnds;
+  QVector<bool> vectorIsLine;
+
+  // Affine transform data. There are 3 vectors per block (affineTFVectors[3*i] to affineTFVectors[3*i+2]).
+  statisticsBlockList affineTFBlocks;
+  QVector<QPoint> affineTFVectors;
+
+  QVector<statisticsItemPolygon_Value> polygonValueData;
+  QVector<statisticsItemPolygon_Vector> polygonVectorData;
 
   // What is the size (area) of the biggest block)? This is needed for scaling the blocks according to their size.
   unsigned int maxBlockSize;
@@ -42,8 +42,13 @@
 #endif
 #include <QApplication>
 #include <QColor>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QHash>
 #include <QIcon>
 #include <QLayout>
+#include <QMutex>
 #include <QSettings>
 #include <QThread>
 #include <QWidget>
@@ -168,6 +173,89 @@ unsigned int systemMemorySizeInMB()
   return memorySizeInMB;
 }
 
+namespace
+{
+  // The library files that were found in this process [libraryName] -> (searchKey, files)
+  QMutex libraryDiscoveryCacheMutex;
+  QHash<QString, QPair<QString, QStringList>> libraryDiscoveryCache;
+
+  qint64 getLibraryFileModificationTime(const QString &libraryFile)
+  {
+    QFileInfo fileInfo(libraryFile);
+    return fileInfo.exists() ? fileInfo.lastModified().toMSecsSinceEpoch() : -1;
+  }
+}
+
+QString getLibrarySearchKey(const QStringList &candidates, const QStringList &directories)
+{
+  QStringList key = candidates;
+  for (auto &directory : directories)
+    key.append(QString::number(getLibraryFileModificationTime(QDir::cleanPath(directory))));
+  return key.join(";");
+}
+
+QStringList getCachedLibraryFiles(const QString &libraryName, const QString &searchKey)
+{
+  QMutexLocker locker(&libraryDiscoveryCacheMutex);
+  if (libraryDiscoveryCache.contains(libraryName))
+  {
+    auto entry = libraryDiscoveryCache.value(libraryName);
+    return (entry.first == searchKey) ? entry.second : QStringList();
+  }
+
+  // Nothing was found in this process yet. Get the files that were found the last time YUView was running.
+  QSettings settings;
+  settings.beginGroup("Decoders");
+  settings.beginGroup("DiscoveredLibraries");
+  settings.beginGroup(libraryName);
+  if (settings.value("SearchKey").toString() != searchKey)
+    return QStringList();
+  QStringList libraryFiles = settings.value("Files").toStringList();
+  const QVariantList modificationTimes = settings.value("ModificationTimes").toList();
+  if (libraryFiles.isEmpty() || modificationTimes.count() != libraryFiles.count())
+    return QStringList();
+  for (int i = 0; i < libraryFiles.count(); i++)
+    if (getLibraryFileModificationTime(libraryFiles[i]) != modificationTimes[i].toLongLong())
+      return QStringList();
+
+  libraryDiscoveryCache.insert(libraryName, qMakePair(searchKey, libraryFiles));
+  return libraryFiles;
+}
+
+void setCachedLibraryFiles(const QString &libraryName, const QString &searchKey, const QStringList &libraryFiles)
+{
+  // The location of a library in the system directories is unknown. It can not be checked for changes.
+  for (auto &libraryFile : libraryFiles)
+    if (!QFileInfo(libraryFile).isAbsolute())
+      return;
+
+  QMutexLocker locker(&libraryDiscoveryCacheMutex);
+  libraryDiscoveryCache.insert(libraryName, qMakePair(searchKey, libraryFiles));
+
+  QVariantList modificationTimes;
+  for (auto &libraryFile : libraryFiles)
+    modificationTimes.append(getLibraryFileModificationTime(libraryFile));
+
+  QSettings settings;
+  settings.beginGroup("Decoders");
+  settings.beginGroup("DiscoveredLibraries");
+  settings.beginGroup(libraryName);
+  settings.setValue("SearchKey", searchKey);
+  settings.setValue("Files", libraryFiles);
+  settings.setValue("ModificationTimes", modificationTimes);
+}
+
+void removeCachedLibraryFiles(const QString &libraryName)
+{
+  QMutexLocker locker(&libraryDiscoveryCacheMutex);
+  libraryDiscoveryCache.remove(libraryName);
+
+  QSettings settings;
+  settings.beginGroup("Decoders");
+  settings.beginGroup("DiscoveredLibraries");
+  settings.remove(libraryName);
+}
+
 QIcon convertIcon(QString iconPath)
 {
   QSettings settings;
@@ -401,6 +401,20 @@ unsigned int getOptimalThreadCount();
 // This function is thread safe and inexpensive to call.
 unsigned int systemMemorySizeInMB();
 
+// The decoder libraries are searched using many names in many paths. The library files that were found are
+// remembered (for this process and in the settings together with the modification time of the files) so that
+// the search does not have to be repeated. The search key describes the search (e.g. the names and paths that
+// are tried). If the key changed or one of the files was modified, no files are returned.
+// Only files that were found in one of the given directories can be remembered. A library that is installed into
+// one of the directories later changes the modification time of the directory and thereby the search key. Files that
+// were found in the system directories (no absolute path) are not remembered.
+// These functions are thread safe.
+QString getLibrarySearchKey(const QStringList &candidates, const QStringList &directories);
+QStringList getCachedLibraryFiles(const QString &libraryName, const QString &searchKey);
+void setCachedLibraryFiles(const QString &libraryName, const QString &searchKey, const QStringList &libraryFiles);
+// The remembered files could not be loaded
+void removeCachedLibraryFiles(const QString &libraryName);
+
 // When asking the playlist item if it needs loading, there are some states that the item can return
 enum itemLoadingState
 {
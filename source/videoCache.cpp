@@ -33,13 +33,16 @@
 #include "videoCache.h"
 
 #include <algorithm>
+#include <QFile>
 #include <QMessageBox>
 #include <QPainter>
 #include <QScrollArea>
 #include <QSettings>
+#include <QTextStream>
 #include <QThread>
 #include "playbackController.h"
 #include "playlistItem.h"
+#include "videoHandler.h"
 
 // This debug setting has two values:
 // 1: Basic operation is written to qDebug: If a new item is selected, what is the decision to cache/remove next?
@@ -67,6 +70,62 @@
 #define DEBUG_JOBS(fmt,...) ((void)0)
 #endif
 
+// In the adaptive cache size mode, the available memory is checked in this interval (in ms)
+#define CACHE_ADAPTIVE_UPDATE_INTERVAL_MS 1000
+// In the adaptive mode, this much memory (in MB) is always left available for other applications
+#define CACHE_ADAPTIVE_RESERVE_MB 2048
+// If the memory pressure (the percentage of time in the last 10 seconds in which some tasks were stalled
+// waiting for memory) exceeds this value, the cache is made smaller by CACHE_ADAPTIVE_SHRINK_PERCENT in every update.
+#define CACHE_ADAPTIVE_PRESSURE_THRESHOLD 2.0
+#define CACHE_ADAPTIVE_SHRINK_PERCENT 10
+// Smaller changes of the adaptive cache size (in MB) are ignored so that the caching is not restarted all the time
+#define CACHE_ADAPTIVE_MIN_CHANGE_MB 256
+
+namespace
+{
+  // Get the memory that is available for starting new applications without swapping (in bytes).
+  // This is only supported on linux (MemAvailable in /proc/meminfo).
+  bool getAvailableMemory(int64_t &availableBytes)
+  {
+    QFile file("/proc/meminfo");
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+      return false;
+    QTextStream in(&file);
+    for (QString line = in.readLine(); !line.isNull(); line = in.readLine())
+    {
+      // The line looks like this: "MemAvailable:   12345678 kB"
+      if (line.startsWith("MemAvailable:"))
+      {
+        bool ok;
+        const int64_t kB = line.section(' ', 1, 1, QString::SectionSkipEmpty).toLongLong(&ok);
+        availableBytes = kB * 1024;
+        return ok;
+      }
+    }
+    return false;
+  }
+
+  // Get the memory pressure (PSI) from /proc/pressure/memory. This is only supported on linux (kernel 4.20 and later).
+  bool getMemoryPressure(double &pressure)
+  {
+    QFile file("/proc/pressure/memory");
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+      return false;
+    // The first line looks like this: "some avg10=0.00 avg60=0.00 avg300=0.00 total=0"
+    const QString line = QTextStream(&file).readLine();
+    if (!line.startsWith("some "))
+      return false;
+    for (const QString &value : line.split(' ', QString::SkipEmptyParts))
+      if (value.startsWith("avg10="))
+      {
+        bool ok;
+        pressure = value.mid(6).toDouble(&ok);
+        return ok;
+      }
+    return false;
+  }
+}
+
 /// ------------------------ loadingWorker ------------------------
 
 class loadingWorker : public QObject
@@ -218,6 +277,7 @@ videoCache::videoCache(PlaylistTreeWidget *playlistTreeWidget, PlaybackControlle
   connect(playback.data(), &PlaybackController::waitForItemCaching, this, &videoCache::watchItemForCachingFinished);
   connect(playback.data(), &PlaybackController::signalPlaybackStarting, this, &videoCache::updateCacheQueue);
   connect(&statusUpdateTimer, &QTimer::timeout, this, [=]{ emit updateCacheStatus(); });
+  connect(&adaptiveCacheSizeTimer, &QTimer::timeout, this, [=]{ if (updateAdaptiveCacheSize()) scheduleCachingListUpdate(); });
   connect(&testProgrssUpdateTimer, &QTimer::timeout, this, [=]{ updateTestProgress(); });
 }
 
@@ -279,7 +339,19 @@ void videoCache::updateSettings()
   QSettings settings;
   settings.beginGroup("VideoCache");
   cachingEnabled = settings.value("Enabled", true).toBool();
-  cacheLevelMax = (int64_t)settings.value("ThresholdValueMB", 49).toUInt() * 1000 * 1000;
+  cacheLevelMaxFixed = (int64_t)settings.value("ThresholdValueMB", 49).toUInt() * 1000 * 1000;
+  cacheLevelMax = cacheLevelMaxFixed;
+  // In the adaptive mode, the cache size follows the memory that is available in the system. The threshold is the minimum.
+  adaptiveCacheSize = settings.value("AdaptiveThreshold", false).toBool();
+  if (adaptiveCacheSize && cachingEnabled)
+  {
+    updateAdaptiveCacheSize();
+    adaptiveCacheSizeTimer.start(CACHE_ADAPTIVE_UPDATE_INTERVAL_MS);
+  }
+  else
+    adaptiveCacheSizeTimer.stop();
+  // Frames that are removed from the cache can be kept in a second level cache on disk
+  videoHandler::updateDiskCacheSettings();
 
   // See if the user changed the number of threads
   int targetNrThreads = getOptimalThreadCount();
@@ -333,6 +405,41 @@ void videoCache::updateSettings()
   settings.endGroup();
 }
 
+bool videoCache::updateAdaptiveCacheSize()
+{
+  int64_t availableMemory;
+  if (!getAvailableMemory(availableMemory))
+  {
+    // Not supported on this system. Use the fixed threshold.
+    DEBUG_CACHING("videoCache::updateAdaptiveCacheSize Available memory unknown. Using the fixed threshold.");
+    adaptiveCacheSizeTimer.stop();
+    const bool changed = cacheLevelMax != cacheLevelMaxFixed;
+    cacheLevelMax = cacheLevelMaxFixed;
+    return changed;
+  }
+
+  // The cache may grow into the available memory (except for the reserve). The memory that is already used by the cache
+  // can of course also be used by it.
+  int64_t newCacheLevelMax = cacheLevelCurrent + availableMemory - int64_t(CACHE_ADAPTIVE_RESERVE_MB) * 1000 * 1000;
+  double pressure;
+  if (getMemoryPressure(pressure) && pressure > CACHE_ADAPTIVE_PRESSURE_THRESHOLD)
+  {
+    // The system is already waiting for memory. Free some memory even if the available memory says otherwise.
+    newCacheLevelMax = std::min(newCacheLevelMax, cacheLevelCurrent * (100 - CACHE_ADAPTIVE_SHRINK_PERCENT) / 100);
+    DEBUG_CACHING("videoCache::updateAdaptiveCacheSize Memory pressure %f", pressure);
+  }
+  newCacheLevelMax = std::max(newCacheLevelMax, cacheLevelMaxFixed);
+
+  // Shrinking the cache below its current level is always done immediately. Otherwise ignore small changes.
+  const bool mustShrink = newCacheLevelMax < cacheLevelCurrent && newCacheLevelMax < cacheLevelMax;
+  if (newCacheLevelMax == cacheLevelMax || (!mustShrink && qAbs(newCacheLevelMax - cacheLevelMax) < int64_t(CACHE_ADAPTIVE_MIN_CHANGE_MB) * 1000 * 1000))
+    return false;
+
+  DEBUG_CACHING("videoCache::updateAdaptiveCacheSize New size %d MB (was %d MB)", int(newCacheLevelMax / 1000000), int(cacheLevelMax / 1000000));
+  cacheLevelMax = newCacheLevelMax;
+  return true;
+}
+
 void videoCache::loadFrame(playlistItem * item, int frameIndex, int loadingSlot)
 {
   if (item == nullptr || item->taggedForDeletion() || (frameIndex < 0 && item->isIndexedByFrame()))
@@ -534,6 +641,9 @@ void videoCache::updateCacheQueue()
       unsigned int frameSize = allItems[i]->getCachingFrameSize();
       for (int f : cachedFrames)
       {
+        if (frameSize == 0)
+          // The item does not use space in this cache (e.g. statistics have their own cache)
+          break;
         allItems[i]->removeFrameFromCache(f);
         cacheLevel -= frameSize;
         if (cacheLevel < cacheLevelMax)
@@ -606,7 +716,7 @@ void videoCache::updateCacheQueue()
             adding = false;
           }
         }
-        else
+        else if (allItems[i]->getCachingFrameSize() > 0)
         {
           // Enqueue all frames (that are cached) from the item as "can be deleted".
           QList<int> cachedFrames = allItems[i]->getCachedFrames();
@@ -692,10 +802,10 @@ void videoCache::updateCacheQueue()
           // There is no previous item or the previous item is the first one in the list
           i = allItems.count() - 1;
         }
-        if (allItems[i]->getNumberCachedFrames() == 0)
+        if (allItems[i]->getNumberCachedFrames() == 0 || allItems[i]->getCachingFrameSize() == 0)
         {
           i--;
-          continue;  // Nothing to delete for this item
+          continue;  // Nothing to delete for this item (or the item does not use space in this cache)
         }
 
         // Which frames are cached for the item at position i?
@@ -747,7 +857,8 @@ void videoCache::updateCacheQueue()
     }
     else
     {
-      if (additionalItemSpaceNeeded > 0)
+      // Items with their own cache (frame size 0) do not need space in this cache but still have to be cached.
+      if (additionalItemSpaceNeeded > 0 || (cachingFrameSize == 0 && selection[0]->isCachable()))
       {
         DEBUG_CACHING("videoCache::updateCacheQueue All frames of %s fit.", selection[0]->getName().toLatin1().data());
         // All frames from the current item will fit and there is probably even space for more items.
@@ -789,7 +900,7 @@ void videoCache::updateCacheQueue()
         range = allItems[i]->getFrameIdxRange();
         int64_t itemCacheSize = (range.second - range.first + 1) * int64_t(allItems[i]->getCachingFrameSize());
 
-        if ((itemCacheSize + cacheLevelWithoutCurrent) <= cacheLevelMax)
+        if (itemCacheSize == 0 || (itemCacheSize + cacheLevelWithoutCurrent) <= cacheLevelMax)
         {
           DEBUG_CACHING("videoCache::updateCacheQueue Entire next item %s fits.", allItems[i]->getName().toLatin1().data());
           // The entire item fits
@@ -854,6 +965,19 @@ void videoCache::updateCacheQueue()
 
 void videoCache::enqueueCacheJob(playlistItem* item, indexRange range)
 {
+  // Items that keep their frames in a cache of their own (e.g. statistics) can only hold a limited number of frames
+  // in it. Scheduling more would make that cache evict the frames that were just cached (the ones closest to the
+  // current frame) and they would be scheduled again. Only schedule the frames around the current frame that fit.
+  int frameLimit = item->getCachingFrameLimit();
+  if (item->getCachingFrameSize() == 0 && frameLimit >= 0 && range.second - range.first + 1 > frameLimit)
+  {
+    int startFrame = range.first;
+    auto selection = playlist->getSelectedItems();
+    if (selection[0] == item)
+      startFrame = clip(playback->getCurrentFrame(), range.first, std::max(range.first, range.second - frameLimit + 1));
+    range = indexRange(startFrame, startFrame + frameLimit - 1);
+  }
+
   // Only schedule frames for caching that were not yet cached.
   QList<int> cachedFrames = item->getCachedFrames();
   int i = range.first;
@@ -59,6 +59,9 @@ public:
   // The user might have changed the settings. Update.
   void updateSettings();
 
+  // The current size limit of the cache in bytes. In the adaptive mode, this changes with the available memory.
+  int64_t getCacheLevelMax() const { return cacheLevelMax; }
+
   // Load the given frame of the given object. This also includes a queue with only one slot. If a frame is currently being
   // loaded, the next call will be saved and started as soon as the running loading request is done. If a request is waiting
   // and another one arrives, the waiting request will be discarded. There are two slots for loading requests. One for each
@@ -130,7 +133,16 @@ private:
   QQueue<plItemFrame> cacheDeQueue;
   // If a frame is removed can be determined by the following cache states:
   int64_t cacheLevelMax;
-  int64_t cacheLevelCurrent;
+  int64_t cacheLevelCurrent {0};
+
+  // In the adaptive mode, cacheLevelMax is updated periodically from the memory that is available in the system
+  // (linux only). If the memory pressure rises, frames are removed from the cache until the cache shrinks to
+  // cacheLevelMaxFixed (the threshold from the settings).
+  bool adaptiveCacheSize {false};
+  int64_t cacheLevelMaxFixed;
+  QTimer adaptiveCacheSizeTimer;
+  // Update cacheLevelMax. Return true if it changed and the cache queue must be updated (frames removed or more frames cached).
+  bool updateAdaptiveCacheSize();
 
   // Enqueue the job in the queue. If all frames within the range are already cached in the item, do nothing.
   void enqueueCacheJob(playlistItem* item, indexRange range);
@@ -34,7 +34,6 @@
 
 #include <QGroupBox>
 #include <QPainter>
-#include <QSettings>
 
 #define VIDEOCACHEINFOWIDGET_DEBUG_OUTPUT 0
 #if VIDEOCACHEINFOWIDGET_DEBUG_OUTPUT && !NDEBUG
@@ -92,17 +91,13 @@ void videoCacheStatusWidget::paintEvent(QPaintEvent *event)
   painter.drawRect(0, 0, width-1, height-1);
 }
 
-void videoCacheStatusWidget::updateStatus(PlaylistTreeWidget *playlist, unsigned int cacheRate)
+void videoCacheStatusWidget::updateStatus(PlaylistTreeWidget *playlist, int64_t cacheLevelMax, unsigned int cacheRate)
 {
   // Get all items from the playlist
   QList<playlistItem*> allItems = playlist->getAllPlaylistItems();
 
-  // Get if caching is enabled and how much memory we can use for the cache
-  QSettings settings;
-  settings.beginGroup("VideoCache");
-  cacheLevelMaxMB = settings.value("ThresholdValueMB", 49).toUInt();
-  const int64_t cacheLevelMax = cacheLevelMaxMB * 1000 * 1000;
-  settings.endGroup();
+  // The size of the cache (this may change over time in the adaptive mode)
+  cacheLevelMaxMB = cacheLevelMax / 1000000;
 
   // Clear the old percent values
   relativeValsEnd.clear();
@@ -176,7 +171,7 @@ void VideoCacheInfoWidget::onUpdateCacheStatus()
   playlist->updateCachingStatus();
 
   DEBUG_CACHINGINFO("VideoCacheInfoWidget::updateCacheStatus");
-  statusWidget->updateStatus(playlist, cacheRateInBytesPerMs);
+  statusWidget->updateStatus(playlist, cache->getCacheLevelMax(), cacheRateInBytesPerMs);
 
   QStringList statusText = cache->getCacheStatusText();
   cachingInfoLabel->setText(statusText.join("\n"));
@@ -32,7 +32,15 @@
 
 #include "videoHandler.h"
 
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QHash>
 #include <QPainter>
+#include <QSettings>
+#include <QStandardPaths>
+#include <QThreadPool>
+#include <QtConcurrent>
 
 // Activate this if you want to know when which buffer is loaded/converted to image and so on.
 #define VIDEOHANDLER_DEBUG_LOADING 0
@@ -42,6 +50,372 @@
 #define DEBUG_VIDEO(fmt,...) ((void)0)
 #endif
 
+// The maximum size of the frames that wait to be written to the disk cache (in MB). If writing can not keep up,
+// further frames are not written to the disk cache (instead of piling up in memory).
+#define VIDEOHANDLER_DISK_CACHE_MAX_PENDING_MB 512
+
+// --------- Disk cache ---------------------------------------
+
+/* The second level of the frame cache. If it is enabled, frames that the video cache removes from the (memory) cache
+ * are written to a local directory (ideally on a fast SSD). If the frame is needed again, it is read from there which
+ * is much faster than decoding it again (e.g. for 8K HEVC files). The disk cache has its own size limit. If it is
+ * exceeded, the least recently used frames are deleted. All files are deleted when YUView is closed.
+ * All functions are thread-safe.
+ */
+class videoHandler::diskCache
+{
+public:
+  diskCache() { writePool.setMaxThreadCount(1); updateSettings(); }
+  ~diskCache();
+
+  void updateSettings();
+  bool isEnabled() const { return enabled; }
+
+  // The frames are identified by the ID of the handler. The address of a handler can not be used because a new
+  // handler may be created at the address of a deleted one. A handler gets a new ID when its frames change.
+  int getNewHandlerId() { return nextHandlerId.fetchAndAddRelaxed(1); }
+
+  // Write the frame of the given handler to the disk cache (in the background)
+  void addFrame(int handlerId, int frameIdx, const QImage &image);
+  bool loadFrame(int handlerId, int frameIdx, QImage &image);
+  // Remove all frames of the given handler (e.g. because the handler is deleted or its frames changed)
+  void removeFrames(int handlerId);
+
+private:
+  typedef QPair<int, int> frameKey;
+  QString getFilePath(const frameKey &key) const;
+  void writeFrame(frameKey key, QImage image);
+  void removeFrame(const frameKey &key);
+
+  // The file header of every frame in the cache
+  struct fileHeader
+  {
+    qint32 width, height, format, compressed;
+    qint64 dataSize;
+  };
+
+  bool enabled {false};
+  bool compress {false};
+  QString directory;
+  int64_t cacheSize {0};
+  int64_t cacheSizeMax {0};
+
+  // All frames in the cache (and their size on disk) and the least recently used frames (first)
+  QHash<frameKey, int64_t> frames;
+  QList<frameKey> framesLRU;
+  // The frames that are currently being written to disk can be read from here.
+  QHash<frameKey, QImage> framesWriting;
+  int64_t framesWritingSize {0};
+  QMutex mutable cacheMutex;
+  QAtomicInt nextHandlerId;
+
+  // The frames are written one at a time in the background
+  QThreadPool writePool;
+};
+
+videoHandler::diskCache::~diskCache()
+{
+  writePool.waitForDone();
+  if (!directory.isEmpty())
+    QDir(directory).removeRecursively();
+}
+
+void videoHandler::diskCache::updateSettings()
+{
+  QSettings settings;
+  settings.beginGroup("VideoCache");
+  const bool newEnabled = settings.value("DiskCacheEnabled", false).toBool();
+  const QString baseDir = settings.value("DiskCacheDirectory", QStandardPaths::writableLocation(QStandardPaths::CacheLocation)).toString();
+  const int64_t newSizeMax = (int64_t)settings.value("DiskCacheThresholdValueMB", VIDEOHANDLER_DISK_CACHE_DEFAULT_SIZE_MB).toUInt() * 1000 * 1000;
+  const bool newCompress = settings.value("DiskCacheCompression", false).toBool();
+  settings.endGroup();
+
+  // Each instance of YUView uses its own sub directory
+  const QString newDirectory = newEnabled ? QDir(baseDir).filePath(QString("YUViewFrameCache-%1").arg(QCoreApplication::applicationPid())) : QString();
+
+  writePool.waitForDone();
+  QMutexLocker lock(&cacheMutex);
+  if (newDirectory != directory)
+  {
+    // Start over in the new directory (or disable the cache)
+    if (!directory.isEmpty())
+      QDir(directory).removeRecursively();
+    frames.clear();
+    framesLRU.clear();
+    cacheSize = 0;
+    directory = newDirectory;
+    if (!directory.isEmpty() && !QDir().mkpath(directory))
+      directory.clear();
+  }
+  enabled = !directory.isEmpty();
+  compress = newCompress;
+  cacheSizeMax = newSizeMax;
+
+  // The cache might be too big now
+  while (cacheSize > cacheSizeMax && !framesLRU.isEmpty())
+    removeFrame(framesLRU.first());
+}
+
+QString videoHandler::diskCache::getFilePath(const frameKey &key) const
+{
+  return QDir(directory).filePath(QString("%1_%2.frame").arg(key.first).arg(key.second));
+}
+
+void videoHandler::diskCache::addFrame(int handlerId, int frameIdx, const QImage &image)
+{
+  QMutexLocker lock(&cacheMutex);
+  const frameKey key(handlerId, frameIdx);
+  if (!enabled || image.isNull() || frames.contains(key) || framesWriting.contains(key))
+    return;
+  if (framesWritingSize + image.byteCount() > int64_t(VIDEOHANDLER_DISK_CACHE_MAX_PENDING_MB) * 1000 * 1000)
+  {
+    // Writing to disk does not keep up. Drop the frame.
+    DEBUG_VIDEO("videoHandler::diskCache::addFrame dropping frame %d", frameIdx);
+    return;
+  }
+  framesWriting.insert(key, image);
+  framesWritingSize += image.byteCount();
+  lock.unlock();
+
+  QtConcurrent::run(&writePool, this, &diskCache::writeFrame, key, image);
+}
+
+void videoHandler::diskCache::writeFrame(frameKey key, QImage image)
+{
+  QByteArray data = QByteArray::fromRawData((const char*)image.constBits(), image.byteCount());
+  if (compress)
+    // Use the fastest compression level. Writing/reading must be faster than decoding the frame again.
+    data = qCompress(data, 1);
+
+  fileHeader header;
+  header.width = image.width();
+  header.height = image.height();
+  header.format = image.format();
+  header.compressed = compress;
+  header.dataSize = data.size();
+
+  QMutexLocker lock(&cacheMutex);
+  const QString filePath = getFilePath(key);
+  lock.unlock();
+
+  QFile file(filePath);
+  const bool written = file.open(QIODevice::WriteOnly) &&
+                       file.write((const char*)&header, sizeof(header)) == sizeof(header) &&
+                       file.write(data) == data.size();
+  file.close();
+
+  lock.relock();
+  // The frames of the handler might have been removed while writing
+  const bool stillNeeded = framesWriting.remove(key) > 0;
+  if (stillNeeded)
+    framesWritingSize -= image.byteCount();
+  if (!written || !stillNeeded)
+  {
+    QFile::remove(filePath);
+    return;
+  }
+  frames.insert(key, sizeof(header) + data.size());
+  framesLRU.append(key);
+  cacheSize += sizeof(header) + data.size();
+  while (cacheSize > cacheSizeMax && !framesLRU.isEmpty())
+    removeFrame(framesLRU.first());
+}
+
+bool videoHandler::diskCache::loadFrame(int handlerId, int frameIdx, QImage &image)
+{
+  QMutexLocker lock(&cacheMutex);
+  const frameKey key(handlerId, frameIdx);
+  if (framesWriting.contains(key))
+  {
+    image = framesWriting[key];
+    return true;
+  }
+  if (!frames.contains(key))
+    return false;
+  framesLRU.removeOne(key);
+  framesLRU.append(key);
+  const QString filePath = getFilePath(key);
+  lock.unlock();
+
+  QFile file(filePath);
+  fileHeader header;
+  if (!file.open(QIODevice::ReadOnly) || file.read((char*)&header, sizeof(header)) != sizeof(header))
+    return false;
+  QImage newImage(header.width, header.height, QImage::Format(header.format));
+  if (header.compressed)
+  {
+    const QByteArray data = qUncompress(file.read(header.dataSize));
+    if (data.size() != newImage.byteCount())
+      return false;
+    memcpy(newImage.bits(), data.constData(), data.size());
+  }
+  else if (header.dataSize != newImage.byteCount() || file.read((char*)newImage.bits(), header.dataSize) != header.dataSize)
+    return false;
+
+  image = newImage;
+  return true;
+}
+
+void videoHandler::diskCache::removeFrames(int handlerId)
+{
+  QMutexLocker lock(&cacheMutex);
+  auto it = framesWriting.begin();
+  while (it != framesWriting.end())
+  {
+    if (it.key().first == handlerId)
+    {
+      framesWritingSize -= it.value().byteCount();
+      it = framesWriting.erase(it);
+    }
+    else
+      ++it;
+  }
+  const QList<frameKey> keys = frames.keys();
+  for (const frameKey &key : keys)
+    if (key.first == handlerId)
+      removeFrame(key);
+}
+
+void videoHandler::diskCache::removeFrame(const frameKey &key)
+{
+  // The cacheMutex must be locked
+  QFile::remove(getFilePath(key));
+  cacheSize -= frames.take(key);
+  framesLRU.removeOne(key);
+}
+
+videoHandler::diskCache &videoHandler::getDiskCache()
+{
+  static diskCache cache;
+  return cache;
+}
+
+void videoHandler::clearDiskCache()
+{
+  // Frames that are added from now on get a new ID. This way, frames of the old state that are still being
+  // written can not be mistaken for the new ones.
+  getDiskCache().removeFrames(diskCacheId.fetchAndStoreOrdered(getDiskCache().getNewHandlerId()));
+}
+
+void videoHandler::updateDiskCacheSettings()
+{
+  getDiskCache().updateSettings();
+}
+
+bool videoHandler::loadFrameFromDiskCache(int frameIndex, bool loadToDoubleBuffer)
+{
+  if (!cacheValid || !getDiskCache().isEnabled())
+    return false;
+
+  QImage image;
+  if (!getDiskCache().loadFrame(diskCacheId.load(), frameIndex, image))
+    return false;
+
+  DEBUG_VIDEO("videoHandler::loadFrameFromDiskCache %d", frameIndex);
+  if (loadToDoubleBuffer)
+  {
+    doubleBufferImage = image;
+    doubleBufferImageFrameIdx = frameIndex;
+  }
+  else
+  {
+    QMutexLocker imageLock(&currentImageSetMutex);
+    currentImage = image;
+    currentImageIdx = frameIndex;
+  }
+  return true;
+}
+
+// --------- Cached frames bitmap -----------------------------
+
+videoHandler::cachedFramesBitmap::cachedFramesBitmap()
+{
+  for (int i = 0; i < nrBlocks; i++)
+    blocks[i].store(nullptr);
+}
+
+videoHandler::cachedFramesBitmap::~cachedFramesBitmap()
+{
+  for (int i = 0; i < nrBlocks; i++)
+    delete[] blocks[i].load();
+}
+
+void videoHandler::cachedFramesBitmap::insert(int frameIdx)
+{
+  if (frameIdx < 0 || frameIdx >= maxFrames)
+    return;
+  const int blockIdx = frameIdx / bitsPerBlock;
+  QAtomicInteger<quint32> *block = blocks[blockIdx].loadAcquire();
+  if (block == nullptr)
+  {
+    // There is only one writer, so the block can not be allocated by another thread in the meantime
+    block = new QAtomicInteger<quint32>[bitsPerBlock / 32];
+    for (int i = 0; i < bitsPerBlock / 32; i++)
+      block[i].store(0);
+    blocks[blockIdx].storeRelease(block);
+  }
+  const int bitIdx = frameIdx % bitsPerBlock;
+  const quint32 mask = quint32(1) << (bitIdx % 32);
+  if ((block[bitIdx / 32].fetchAndOrRelease(mask) & mask) == 0)
+    nrFrames.ref();
+}
+
+void videoHandler::cachedFramesBitmap::remove(int frameIdx)
+{
+  if (frameIdx < 0 || frameIdx >= maxFrames)
+    return;
+  QAtomicInteger<quint32> *block = blocks[frameIdx / bitsPerBlock].loadAcquire();
+  if (block == nullptr)
+    return;
+  const int bitIdx = frameIdx % bitsPerBlock;
+  const quint32 mask = quint32(1) << (bitIdx % 32);
+  if (block[bitIdx / 32].fetchAndAndRelease(~mask) & mask)
+    nrFrames.deref();
+}
+
+void videoHandler::cachedFramesBitmap::clear()
+{
+  for (int i = 0; i < nrBlocks; i++)
+  {
+    QAtomicInteger<quint32> *block = blocks[i].loadAcquire();
+    if (block != nullptr)
+      for (int w = 0; w < bitsPerBlock / 32; w++)
+        block[w].storeRelease(0);
+  }
+  nrFrames.store(0);
+}
+
+bool videoHandler::cachedFramesBitmap::contains(int frameIdx) const
+{
+  if (frameIdx < 0 || frameIdx >= maxFrames)
+    return false;
+  const QAtomicInteger<quint32> *block = blocks[frameIdx / bitsPerBlock].loadAcquire();
+  if (block == nullptr)
+    return false;
+  const int bitIdx = frameIdx % bitsPerBlock;
+  return (block[bitIdx / 32].loadAcquire() >> (bitIdx % 32)) & 1;
+}
+
+QList<int> videoHandler::cachedFramesBitmap::frames() const
+{
+  // Only the set bits of each word are visited so this is fast even for items with many frames.
+  QList<int> list;
+  for (int i = 0; i < nrBlocks; i++)
+  {
+    const QAtomicInteger<quint32> *block = blocks[i].loadAcquire();
+    if (block == nullptr)
+      continue;
+    for (int w = 0; w < bitsPerBlock / 32; w++)
+    {
+      quint32 word = block[w].loadAcquire();
+      for (int b = 0; word != 0; b++, word >>= 1)
+        if (word & 1)
+          list.append(i * bitsPerBlock + w * 32 + b);
+    }
+  }
+  return list;
+}
+
 // --------- videoHandler -------------------------------------
 
 videoHandler::videoHandler()
@@ -53,6 +427,12 @@ videoHandler::videoHandler()
   cacheValid = true;
   currentFrameRawData_frameIdx = -1;
   rawData_frameIdx = -1;
+  diskCacheId.store(getDiskCache().getNewHandlerId());
+}
+
+videoHandler::~videoHandler()
+{
+  getDiskCache().removeFrames(diskCacheId.load());
 }
 
 void videoHandler::slotVideoControlChanged()
@@ -100,9 +480,6 @@ itemLoadingState videoHandler::needsLoading(int frameIdx, bool loadRawValues)
       return state;
   }
 
-  // Lock the mutex for checking the cache
-  QMutexLocker lock(&imageCacheAccess);
-
   // The raw values are not needed. 
   if (frameIdx == currentImageIdx)
   {
@@ -111,7 +488,7 @@ itemLoadingState videoHandler::needsLoading(int frameIdx, bool loadRawValues)
       DEBUG_VIDEO("videoHandler::needsLoading %d is current and %d found in double buffer", frameIdx, frameIdx+1);
       return LoadingNotNeeded;
     }
-    else if (cacheValid && imageCache.contains(frameIdx + 1))
+    else if (cacheValid && imageCacheFrames.contains(frameIdx + 1))
     {
       DEBUG_VIDEO("videoHandler::needsLoading %d is current and %d found in cache", frameIdx, frameIdx+1);
       return LoadingNotNeeded;
@@ -128,7 +505,7 @@ itemLoadingState videoHandler::needsLoading(int frameIdx, bool loadRawValues)
   if (doubleBufferImageFrameIdx == frameIdx)
   {
     // The frame in question is in the double buffer...
-    if (cacheValid && imageCache.contains(frameIdx + 1))
+    if (cacheValid && imageCacheFrames.contains(frameIdx + 1))
     {
       // ... and the one after that is in the cache.
       DEBUG_VIDEO("videoHandler::needsLoading %d found in double buffer. Next frame in cache.", frameIdx);
@@ -145,7 +522,7 @@ itemLoadingState videoHandler::needsLoading(int frameIdx, bool loadRawValues)
   }
 
   // Check the cache
-  if (cacheValid && imageCache.contains(frameIdx))
+  if (cacheValid && imageCacheFrames.contains(frameIdx))
   {
     // What about the next frame? Is it also in the cache or in the double buffer?
     if (doubleBufferImageFrameIdx == frameIdx + 1)
@@ -153,7 +530,7 @@ itemLoadingState videoHandler::needsLoading(int frameIdx, bool loadRawValues)
       DEBUG_VIDEO("videoHandler::needsLoading %d in cache and %d found in double buffer", frameIdx, frameIdx+1);
       return LoadingNotNeeded;
     }
-    else if (cacheValid && imageCache.contains(frameIdx + 1))
+    else if (cacheValid && imageCacheFrames.contains(frameIdx + 1))
     {
       DEBUG_VIDEO("videoHandler::needsLoading %d in cache and %d found in cache", frameIdx, frameIdx+1);
       return LoadingNotNeeded;
@@ -185,10 +562,10 @@ void videoHandler::drawFrame(QPainter *painter, int frameIdx, double zoomFactor,
       currentImageIdx = frameIdx;
       DEBUG_VIDEO("videoHandler::drawFrame %d loaded from double buffer", frameIdx);
     }
-    else
+    else if (cacheValid && imageCacheFrames.contains(frameIdx))
     {
       QMutexLocker lock(&imageCacheAccess);
-      if (cacheValid && imageCache.contains(frameIdx))
+      if (imageCache.contains(frameIdx))
       {
         currentImage = imageCache[frameIdx];
         currentImageIdx = frameIdx;
@@ -243,8 +620,7 @@ QRgb videoHandler::getPixelVal(int x, int y)
 
 int videoHandler::getNrFramesCached() const
 {
-  QMutexLocker lock(&imageCacheAccess);
-  return imageCache.size();
+  return imageCacheFrames.count();
 }
 
 // Put the frame into the cache (if it is not already in there)
@@ -260,8 +636,10 @@ void videoHandler::cacheFrame(int frameIdx, bool testMode)
   }
 
   // Load the frame. While this is happening in the background the frame size must not change.
+  // If the frame was removed from the cache before, it may still be in the disk cache.
   QImage cacheImage;
-  loadFrameForCaching(frameIdx, cacheImage);
+  if (testMode || !cacheValid || !getDiskCache().loadFrame(diskCacheId.load(), frameIdx, cacheImage))
+    loadFrameForCaching(frameIdx, cacheImage);
 
   // Put it into the cache
   if (!cacheImage.isNull())
@@ -269,7 +647,10 @@ void videoHandler::cacheFrame(int frameIdx, bool testMode)
     DEBUG_VIDEO("videoHandler::cacheFrame insert frame %i into cache", frameIdx);
     QMutexLocker imageCacheLock(&imageCacheAccess);
     if (cacheValid && !testMode)
+    {
       imageCache.insert(frameIdx, cacheImage);
+      imageCacheFrames.insert(frameIdx);
+    }
   }
   else
     DEBUG_VIDEO("videoHandler::cacheFrame loading frame %i for caching failed", frameIdx);
@@ -283,28 +664,31 @@ unsigned int videoHandler::getCachingFrameSize() const
 
 QList<int> videoHandler::getCachedFrames() const
 {
-  QMutexLocker lock(&imageCacheAccess);
-  return imageCache.keys();
+  return imageCacheFrames.frames();
 }
 
 int videoHandler::getNumberCachedFrames() const
 {
-  QMutexLocker lock(&imageCacheAccess);
-  return imageCache.size();
+  return imageCacheFrames.count();
 }
 
 bool videoHandler::isInCache(int idx) const
 {
-  QMutexLocker lock(&imageCacheAccess);
-  return imageCache.contains(idx);
+  return imageCacheFrames.contains(idx);
 }
 
 void videoHandler::removeFrameFromCache(int frameIdx)
 {
   DEBUG_VIDEO("removeFrameFromCache %d", frameIdx);
   QMutexLocker lock(&imageCacheAccess);
-  imageCache.remove(frameIdx);
+  const QImage image = imageCache.take(frameIdx);
+  imageCacheFrames.remove(frameIdx);
+  const bool writeToDisk = cacheValid;
   lock.unlock();
+
+  // Move the frame to the second level cache on disk (if enabled)
+  if (writeToDisk)
+    getDiskCache().addFrame(diskCacheId.load(), frameIdx, image);
 }
 
 void videoHandler::removeAllFrameFromCache()
@@ -312,8 +696,12 @@ void videoHandler::removeAllFrameFromCache()
   DEBUG_VIDEO("removeAllFrameFromCache");
   QMutexLocker lock(&imageCacheAccess);
   imageCache.clear();
+  imageCacheFrames.clear();
   cacheValid = true;
   lock.unlock();
+
+  // The frames in the disk cache are not valid anymore either
+  clearDiskCache();
 }
 
 void videoHandler::loadFrame(int frameIndex, bool loadToDoubleBuffer)
@@ -348,6 +736,18 @@ void videoHandler::loadFrame(int frameIndex, bool loadToDoubleBuffer)
   }
 }
 
+QImage videoHandler::getFrameForCaching(int frameIndex)
+{
+  QMutexLocker lock(&imageCacheAccess);
+  if (cacheValid && imageCache.contains(frameIndex))
+    return imageCache[frameIndex];
+  lock.unlock();
+
+  QImage frame;
+  loadFrameForCaching(frameIndex, frame);
+  return frame;
+}
+
 void videoHandler::loadFrameForCaching(int frameIndex, QImage &frameToCache)
 {
   DEBUG_VIDEO("videoHandler::loadFrameForCaching %d", frameIndex);
@@ -380,8 +780,12 @@ void videoHandler::invalidateAllBuffers()
   currentImageSetMutex.unlock();
   requestedFrame_idx = -1;
 
+  QMutexLocker lock(&imageCacheAccess);
   imageCache.clear();
+  imageCacheFrames.clear();
   cacheValid = true;
+  lock.unlock();
+  clearDiskCache();
 }
 
 void videoHandler::activateDoubleBuffer()
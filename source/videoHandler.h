@@ -34,10 +34,15 @@
 #define VIDEOHANDLER_H
 
 #include "frameHandler.h"
+#include <QAtomicInteger>
+#include <QAtomicPointer>
 #include <QBasicTimer>
 #include <QFileInfo>
 #include <QMutex>
 
+// The default size limit of the disk cache in MB (also used as the default in the settings dialog)
+#define VIDEOHANDLER_DISK_CACHE_DEFAULT_SIZE_MB 20000
+
 /* TODO
 */
 class videoHandler : public frameHandler
@@ -49,6 +54,7 @@ public:
   /*
   */
   videoHandler();
+  virtual ~videoHandler();
   
   // Draw the frame with the given frame index and zoom factor. If onLoadShowLasFrame is set, show the last frame
   // if the frame with the current frame index is loaded in the background.
@@ -65,6 +71,14 @@ public:
   virtual void removeFrameFromCache(int frameIdx);
   virtual void removeAllFrameFromCache();
 
+  // Frames that are removed from the cache can be moved to a second level cache on disk (if enabled in the settings).
+  // If the given frame is in the disk cache, load it from there (to the current image or the double buffer) and return true.
+  bool loadFrameFromDiskCache(int frameIndex, bool loadToDoubleBuffer=false);
+  // Get the given frame from the cache or load it like it is loaded for caching. The current frame is not changed.
+  QImage getFrameForCaching(int frameIndex);
+  // Reload the settings of the disk cache (directory, size limit, ...)
+  static void updateDiskCacheSettings();
+
   // Get the number of bytes for one frame (RGB or YUV) with the current format (if this video handler uses raw data)
   virtual int64_t getBytesPerFrame() const { return -1; }
 
@@ -177,8 +191,34 @@ protected:
   void setCacheInvalid() { cacheValid = false; }
 
   // --- Caching
+  // A bitmap of the frames that are in the cache. The cache status is queried very often (by the video cache and the
+  // cache status widgets for all frames of all items). Reading the bitmap does not need any locking. Changing it is
+  // only allowed while imageCacheAccess is locked (so there is only one writer at a time). The blocks of the bitmap
+  // are allocated when needed and are never freed while the bitmap exists so that readers never access freed memory.
+  class cachedFramesBitmap
+  {
+  public:
+    cachedFramesBitmap();
+    ~cachedFramesBitmap();
+    void insert(int frameIdx);
+    void remove(int frameIdx);
+    void clear();
+    bool contains(int frameIdx) const;
+    int count() const { return nrFrames.load(); }
+    QList<int> frames() const;
+    // The highest frame index +1 that can be stored in the bitmap
+    static const int maxFrames = (1 << 26);
+  private:
+    static const int bitsPerBlock = 32 * 1024;
+    static const int nrBlocks = maxFrames / bitsPerBlock;
+    QAtomicPointer<QAtomicInteger<quint32>> blocks[nrBlocks];
+    QAtomicInt nrFrames;
+  };
+
+  // The images of the cached frames. Access to the images (and changes to the bitmap) require locking imageCacheAccess.
   QMutex mutable     imageCacheAccess;
   QMap<int, QImage>  imageCache;
+  cachedFramesBitmap imageCacheFrames;
   // Is the cache valid? The cache can be ivalid in the following scenario:
   // Somethign about how an item is shown changes (e.g. the resolution) but caching of the item is currently performed.
   // If we just cleared the cache, the wrong (currently being cached) frames would still end up in the cache. So we emit
@@ -186,6 +226,15 @@ protected:
   // Until then, however, the items that are in the cache (or are being put into the cache by the still running threads) are invalid.
   bool cacheValid;
 
+private:
+  // The disk cache is shared by all video handlers
+  class diskCache;
+  static diskCache &getDiskCache();
+  // The ID of the frames of this handler in the disk cache
+  QAtomicInt diskCacheId;
+  // Remove all frames of this handler from the disk cache
+  void clearDiskCache();
+
 private slots:
   // Override the slotVideoControlChanged slot. For a videoHandler, also the number of frames might have changed.
   void slotVideoControlChanged() Q_DECL_OVERRIDE;
@@ -66,15 +66,17 @@ void videoHandlerDifference::drawDifferenceFrame(QPainter *painter, int frameIdx
     {
       currentImage = doubleBufferImage;
       currentImageIdx = frameIdx;
+      differenceInfoList = doubleBufferInfoList;
       DEBUG_VIDEO("videoHandler::drawFrame %d loaded from double buffer", frameIdx);
     }
-    else
+    else if (cacheValid && imageCacheFrames.contains(frameIdx))
     {
       QMutexLocker lock(&imageCacheAccess);
-      if (cacheValid && imageCache.contains(frameIdx))
+      if (imageCache.contains(frameIdx))
       {
         currentImage = imageCache[frameIdx];
         currentImageIdx = frameIdx;
+        differenceInfoList = differenceInfoCache.value(frameIdx);
         DEBUG_VIDEO("videoHandler::drawFrame %d loaded from cache", frameIdx);
       }
     }
@@ -99,14 +101,38 @@ void videoHandlerDifference::drawDifferenceFrame(QPainter *painter, int frameIdx
 
 void videoHandlerDifference::loadFrameDifference(int frameIndex, int frameIndex0, int frameIndex1, bool loadToDoubleBuffer)
 {
-  // No double buffering for difference items
-  Q_UNUSED(loadToDoubleBuffer);
-
   // Calculate the difference between the inputVideos
   if (!inputsValid())
     return;
   
-  differenceInfoList.clear();
+  QList<infoItem> infoList;
+  QImage newFrame = calculateDifferenceFrame(frameIndex0, frameIndex1, infoList);
+
+  if (loadToDoubleBuffer)
+  {
+    if (!newFrame.isNull())
+    {
+      doubleBufferImage = newFrame;
+      doubleBufferImageFrameIdx = frameIndex;
+      doubleBufferInfoList = infoList;
+    }
+    return;
+  }
+
+  differenceInfoList = infoList;
+  if (!newFrame.isNull())
+  {
+    // The new difference frame is ready
+    currentImageIdx = frameIndex;
+    currentImageSetMutex.lock();
+    currentImage = newFrame;
+    currentImageSetMutex.unlock();
+  }
+}
+
+QImage videoHandlerDifference::calculateDifferenceFrame(int frameIndex0, int frameIndex1, QList<infoItem> &infoList)
+{
+  QMutexLocker lock(&calculateDifferenceMutex);
 
   // Check if the second item is a video and the first one is not. In that case,
   // make sure that the right frame is loaded for the video item.
@@ -116,16 +142,112 @@ void videoHandlerDifference::loadFrameDifference(int frameIndex, int frameIndex0
     video1->loadFrame(frameIndex1);
   
   // Calculate the difference  
-  QImage newFrame = inputVideo[0]->calculateDifference(inputVideo[1], frameIndex0, frameIndex1, differenceInfoList, amplificationFactor, markDifference);
+  QList<infoItem> diffInfoList;
+  QImage newFrame = inputVideo[0]->calculateDifference(inputVideo[1], frameIndex0, frameIndex1, diffInfoList, amplificationFactor, markDifference);
 
+  // Report the position of the first difference in coding order. This must be done now because the YUV difference
+  // in the input is overwritten when the next difference is calculated.
   if (!newFrame.isNull())
   {
-    // The new difference frame is ready
-    currentImageIdx = frameIndex;
-    currentImageSetMutex.lock();
-    currentImage = newFrame;
-    currentImageSetMutex.unlock();
+    videoHandlerYUV *yuvVideo0 = dynamic_cast<videoHandlerYUV*>(inputVideo[0].data());
+    if (yuvVideo0 != nullptr && yuvVideo0->getIs_YUV_diff())
+      reportFirstDifferencePosition(infoList, newFrame, yuvVideo0->getDiffYUV(), yuvVideo0->getDiffYUVFormat());
+    else
+      reportFirstDifferencePosition(infoList, newFrame, QByteArray(), YUV_Internals::yuvPixelFormat());
   }
+  infoList.append(diffInfoList);
+
+  return newFrame;
+}
+
+QImage videoHandlerDifference::calculateDifferenceFrameForCaching(int frameIndex0, int frameIndex1, QList<infoItem> &infoList)
+{
+  QList<infoItem> diffInfoList;
+  QImage newFrame;
+  QByteArray diffYUV;
+  YUV_Internals::yuvPixelFormat diffYUVFormat;
+
+  // If possible, calculate the difference of the YUV values
+  videoHandlerYUV *yuvVideo[2] = {dynamic_cast<videoHandlerYUV*>(inputVideo[0].data()), dynamic_cast<videoHandlerYUV*>(inputVideo[1].data())};
+  if (yuvVideo[0] != nullptr && yuvVideo[1] != nullptr)
+  {
+    QByteArray rawYUV[2];
+    YUV_Internals::yuvPixelFormat yuvFormat[2];
+    QSize yuvFrameSize[2];
+    if (!yuvVideo[0]->loadRawYUVDataForCaching(frameIndex0, rawYUV[0], yuvFormat[0], yuvFrameSize[0]))
+      return QImage();
+    if (!yuvVideo[1]->loadRawYUVDataForCaching(frameIndex1, rawYUV[1], yuvFormat[1], yuvFrameSize[1]))
+      return QImage();
+
+    if (yuvFormat[0].subsampling == yuvFormat[1].subsampling)
+    {
+      newFrame = yuvVideo[0]->calculateDifferenceYUV(rawYUV[0], yuvFormat[0], yuvFrameSize[0], rawYUV[1], yuvFormat[1], yuvFrameSize[1], diffInfoList, amplificationFactor, markDifference, diffYUV, diffYUVFormat);
+      if (newFrame.isNull())
+        return QImage();
+    }
+  }
+
+  if (newFrame.isNull())
+  {
+    // Calculate the difference of the RGB values
+    QImage inputFrame0 = getInputFrameForCaching(0, frameIndex0);
+    QImage inputFrame1 = getInputFrameForCaching(1, frameIndex1);
+    if (inputFrame0.isNull() || inputFrame1.isNull())
+      return QImage();
+    newFrame = frameHandler::calculateDifferenceOfImages(inputFrame0, inputFrame1, diffInfoList, amplificationFactor, markDifference);
+  }
+
+  // The YUV difference of this frame is only in the local buffer (not in the input)
+  reportFirstDifferencePosition(infoList, newFrame, diffYUV, diffYUVFormat);
+  infoList.append(diffInfoList);
+  return newFrame;
+}
+
+QImage videoHandlerDifference::getInputFrameForCaching(int input, int frameIndex)
+{
+  // A video is loaded like it is loaded for caching. Other inputs (e.g. a static image) only have one frame.
+  videoHandler *video = dynamic_cast<videoHandler*>(inputVideo[input].data());
+  if (video)
+    return video->getFrameForCaching(frameIndex);
+  return inputVideo[input]->getCurrentFrameAsImage();
+}
+
+void videoHandlerDifference::cacheFrameDifference(int frameIndex, int frameIndex0, int frameIndex1, bool testMode)
+{
+  DEBUG_VIDEO("videoHandlerDifference::cacheFrameDifference %d %s", frameIndex, testMode ? "testMode" : "");
+
+  if (!inputsValid() || (cacheValid && isInCache(frameIndex) && !testMode))
+    return;
+
+  QList<infoItem> infoList;
+  QImage cacheImage = calculateDifferenceFrameForCaching(frameIndex0, frameIndex1, infoList);
+  if (cacheImage.isNull())
+    return;
+
+  QMutexLocker lock(&imageCacheAccess);
+  if (cacheValid && !testMode)
+  {
+    imageCache.insert(frameIndex, cacheImage);
+    imageCacheFrames.insert(frameIndex);
+    differenceInfoCache.insert(frameIndex, infoList);
+  }
+}
+
+void videoHandlerDifference::removeFrameFromCache(int frameIdx)
+{
+  // The differences are not moved to the disk cache. Calculating them again is fast if the inputs are cached.
+  QMutexLocker lock(&imageCacheAccess);
+  imageCache.remove(frameIdx);
+  imageCacheFrames.remove(frameIdx);
+  differenceInfoCache.remove(frameIdx);
+}
+
+void videoHandlerDifference::removeAllFrameFromCache()
+{
+  QMutexLocker lock(&imageCacheAccess);
+  differenceInfoCache.clear();
+  lock.unlock();
+  videoHandler::removeAllFrameFromCache();
 }
 
 bool videoHandlerDifference::inputsValid() const
@@ -158,8 +280,9 @@ void videoHandlerDifference::setInputVideos(frameHandler *childVideo0, frameHand
       setFrameSize(diffSize);
     }
 
-    // If something changed, we might need a redraw
-    emit signalHandlerChanged(true, RECACHE_NONE);
+    // If something changed, we might need a redraw and all cached differences are invalid
+    invalidateInputs();
+    emit signalHandlerChanged(true, RECACHE_CLEAR);
   }
 }
 
@@ -203,9 +326,11 @@ void videoHandlerDifference::slotDifferenceControlChanged()
   {
     markDifference = ui.markDifferenceCheckBox->isChecked();
 
-    // Set the current frame in the buffer to be invalid and emit the signal that something has changed
+    // Set the current frame in the buffer and the cache to be invalid and emit the signal that something has changed
     currentImageIdx = -1;
-    emit signalHandlerChanged(true, RECACHE_NONE);
+    doubleBufferImageFrameIdx = -1;
+    setCacheInvalid();
+    emit signalHandlerChanged(true, RECACHE_CLEAR);
   }
   else if (sender == ui.codingOrderComboBox)
   {
@@ -218,18 +343,20 @@ void videoHandlerDifference::slotDifferenceControlChanged()
   {
     amplificationFactor = ui.amplificationFactorSpinBox->value();
 
-    // Set the current frame in the buffer to be invalid and emit the signal that something has changed
+    // Set the current frame in the buffer and the cache to be invalid and emit the signal that something has changed
     currentImageIdx = -1;
-    emit signalHandlerChanged(true, RECACHE_NONE);
+    doubleBufferImageFrameIdx = -1;
+    setCacheInvalid();
+    emit signalHandlerChanged(true, RECACHE_CLEAR);
   }
 }
 
-void videoHandlerDifference::reportFirstDifferencePosition(QList<infoItem> &infoList) const
+void videoHandlerDifference::reportFirstDifferencePosition(QList<infoItem> &infoList, const QImage &diffImage, const QByteArray &diffYUV, const YUV_Internals::yuvPixelFormat &diffYUVFormat) const
 {
   if (!inputsValid())
     return;
 
-  if (currentImage.width() != frameSize.width() || currentImage.height() != frameSize.height())
+  if (diffImage.width() != frameSize.width() || diffImage.height() != frameSize.height())
     return;
 
   if (codingOrder == CodingOrder_HEVC)
@@ -250,12 +377,11 @@ void videoHandlerDifference::reportFirstDifferencePosition(QList<infoItem> &info
         int firstX, firstY, partIndex = 0;
 
 
-        videoHandlerYUV* video0 = dynamic_cast<videoHandlerYUV*>(inputVideo[0].data());
-        if(video0 != NULL && video0->getIs_YUV_diff())
+        if (!diffYUV.isEmpty())
         {
 
             // find first difference using YUV instead of QImage. The latter does not work for 10bit videos and very small differences, since it only supports 8bit
-            if (hierarchicalPositionYUV(x*64, y*64, 64, firstX, firstY, partIndex, video0->getDiffYUV(), video0->getDiffYUVFormat()))
+            if (hierarchicalPositionYUV(x*64, y*64, 64, firstX, firstY, partIndex, diffYUV, diffYUVFormat))
             {
               // We found a difference in this block
               infoList.append(infoItem("First Difference LCU", QString::number(y * widthLCU + x)));
@@ -268,7 +394,7 @@ void videoHandlerDifference::reportFirstDifferencePosition(QList<infoItem> &info
         }
         else
         {
-            if (hierarchicalPosition(x*64, y*64, 64, firstX, firstY, partIndex, currentImage))
+            if (hierarchicalPosition(x*64, y*64, 64, firstX, firstY, partIndex, diffImage))
             {
               // We found a difference in this block
               infoList.append(infoItem("First Difference LCU", QString::number(y * widthLCU + x)));
@@ -33,6 +33,8 @@
 #ifndef VIDEOHANDLERDIFFERENCE_H
 #define VIDEOHANDLERDIFFERENCE_H
 
+#include <QMap>
+#include <QMutex>
 #include <QPointer>
 #include "fileInfoWidget.h"
 #include "ui_videoHandlerDifference.h"
@@ -52,6 +54,15 @@ public:
   explicit videoHandlerDifference();
 
   void loadFrameDifference(int frameIndex, int frameIndex0, int frameIndex1, bool loadToDoubleBuffer=false);
+
+  // --- Caching ---
+  // The difference of the given frames is calculated and put into the cache (together with its info list).
+  // This is called from the caching threads.
+  void cacheFrameDifference(int frameIndex, int frameIndex0, int frameIndex1, bool testMode);
+  virtual void removeFrameFromCache(int frameIdx) Q_DECL_OVERRIDE;
+  virtual void removeAllFrameFromCache() Q_DECL_OVERRIDE;
+  // One of the inputs changed. All buffers are cleared and the cache is invalid until the video cache cleared it.
+  void invalidateInputs() { invalidateAllBuffers(); setCacheInvalid(); }
   
   // Are both inputs valid and can be used?
   bool inputsValid() const;
@@ -63,13 +74,11 @@ public:
   // The signal signalHandlerChanged will be emitted if a redraw is required.
   void setInputVideos(frameHandler *childVideo0, frameHandler *childVideo1);
 
+  // The info (difference type, MSE, position of the first difference) of the current difference frame
   QList<infoItem> differenceInfoList;
   
   // The difference overloads this and returns the difference values (A-B)
   virtual QStringPairList getPixelValues(const QPoint &pixelPos, int frameIdx, frameHandler *item2=nullptr, const int frameIdx1 = 0) Q_DECL_OVERRIDE;
-
-  // Calculate the position of the first difference and add the info to the list
-  void reportFirstDifferencePosition(QList<infoItem> &infoList) const;
     
 private slots:
   void slotDifferenceControlChanged();
@@ -89,6 +98,23 @@ private:
   // The two videos that the difference will be calculated from
   QPointer<frameHandler> inputVideo[2];  
 
+  // Calculate the difference of the given frames of the two inputs and the info list for it. This uses the current frame
+  // buffers of the inputs, so only one difference can be calculated at a time (from the GUI or the loading thread).
+  QImage calculateDifferenceFrame(int frameIndex0, int frameIndex1, QList<infoItem> &infoList);
+  QMutex calculateDifferenceMutex;
+  // The same for the caching threads. The frames of the inputs are loaded through their caching path into local buffers,
+  // so the current frames of the inputs are not touched.
+  QImage calculateDifferenceFrameForCaching(int frameIndex0, int frameIndex1, QList<infoItem> &infoList);
+  QImage getInputFrameForCaching(int input, int frameIndex);
+
+  // The info lists of the frames in the cache and of the frame in the double buffer
+  QMap<int, QList<infoItem>> differenceInfoCache;
+  QList<infoItem> doubleBufferInfoList;
+
+  // Calculate the position of the first difference and add the info to the list. If the YUV difference is given, it is
+  // used (the image does not show small differences of more than 8 bit). Otherwise, the difference image is used.
+  void reportFirstDifferencePosition(QList<infoItem> &infoList, const QImage &diffImage, const QByteArray &diffYUV, const YUV_Internals::yuvPixelFormat &diffYUVFormat) const;
+
   // Recursively scan the LCU
   bool hierarchicalPosition(int x, int y, int blockSize, int &firstX, int &firstY, int &partIndex, const QImage &diffImg) const;
   bool hierarchicalPositionYUV(int x, int y, int blockSize, int &firstX, int &firstY, int &partIndex, const QByteArray &diffYUV, const YUV_Internals::yuvPixelFormat &diffYUVFormat) const;
@@ -969,6 +969,8 @@ void videoHandlerRGB::drawPixelValues(QPainter *painter, const int frameIdx, con
   QRect pixelRect;
   pixelRect.setSize(QSize(zoomFactor, zoomFactor));
   const unsigned int drawWhitLevel = 1 << (srcPixelFormat.bitsPerValue - 1);
+  pixelValueGlyphAtlas &glyphAtlas = getPixelValueGlyphAtlas();
+  glyphAtlas.begin(painter);
   for (int x = xMin; x <= xMax; x++)
   {
     for (int y = yMin; y <= yMax; y++)
@@ -977,8 +979,9 @@ void videoHandlerRGB::drawPixelValues(QPainter *painter, const int frameIdx, con
       QPoint pixCenter = centerPointZero + QPoint(x * zoomFactor, y * zoomFactor);
       pixelRect.moveCenter(pixCenter);
 
-      // Get the text to show
-      QString valText;
+      // Get the values to show
+      int values[3];
+      bool drawWhite;
       if (rgbItem2 != nullptr)
       {
         unsigned int R0, G0, B0, R1, G1, B1;
@@ -989,22 +992,27 @@ void videoHandlerRGB::drawPixelValues(QPainter *painter, const int frameIdx, con
         int DG = (int)G0-G1;
         int DB = (int)B0-B1;
         if (markDifference)
-          painter->setPen((DR == 0 && DG == 0 && DB == 0) ? Qt::white : Qt::black);
+          drawWhite = (DR == 0 && DG == 0 && DB == 0);
         else
-          painter->setPen((DR < 0 && DG < 0 && DB < 0) ? Qt::white : Qt::black);
-        valText = QString("R%1\nG%2\nB%3").arg(DR).arg(DG).arg(DB);
+          drawWhite = (DR < 0 && DG < 0 && DB < 0);
+        values[0] = DR;
+        values[1] = DG;
+        values[2] = DB;
       }
       else
       {
         unsigned int R, G, B;
         getPixelValue(QPoint(x, y), R, G, B);
-        valText = QString("R%1\nG%2\nB%3").arg(R).arg(G).arg(B);
-        painter->setPen((R < drawWhitLevel && G < drawWhitLevel && B < drawWhitLevel) ? Qt::white : Qt::black);
+        values[0] = R;
+        values[1] = G;
+        values[2] = B;
+        drawWhite = (R < drawWhitLevel && G < drawWhitLevel && B < drawWhitLevel);
       }
 
-      painter->drawText(pixelRect, Qt::AlignCenter, valText);
+      glyphAtlas.addValues(pixelRect, "RGB", values, 3, drawWhite);
     }
   }
+  glyphAtlas.end(painter);
 }
 
 QImage videoHandlerRGB::calculateDifference(frameHandler *item2, const int frameIdxItem0, const int frameIdxItem1, QList<infoItem> &differenceInfoList, const int amplificationFactor, const bool markDifference)
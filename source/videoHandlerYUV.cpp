@@ -37,6 +37,7 @@
 #include <xmmintrin.h>
 #include <QDir>
 #include <QPainter>
+#include <QtConcurrent>
 #include "fileInfoWidget.h"
 
 using namespace YUV_Internals;
@@ -65,6 +66,17 @@ const int yuvRgbConvScaleLuma[256] =
 #define DEBUG_YUV(fmt,...) ((void)0)
 #endif
 
+// Frames with at least this many pixels (8K and up) are converted to RGB in tiles if only a part of the frame is visible.
+#define YUV_TILE_CONVERSION_MIN_PIXELS (7680*4320)
+// The size of the tiles in pixels. This must be a multiple of all subsampling factors.
+#define YUV_TILE_SIZE 256
+// The tiles within this many pixels around the visible area are also converted so that panning by a small amount
+// does not require any conversion.
+#define YUV_TILE_CONVERSION_MARGIN 256
+// Each tile is converted with this many additional pixels on each side. This way, the chroma interpolation at the
+// tile borders gives the same result as the conversion of the whole frame.
+#define YUV_TILE_BORDER 8
+
 // Restrict is basically a promise to the compiler that for the scope of the pointer, the target of the pointer will only be accessed through that pointer (and pointers copied from it).
 #if __STDC__ != 1
 #    define restrict __restrict /* use implementation __ format */
@@ -141,21 +153,29 @@ bool isDefaultChromaFormat(int chromaOffset, bool offsetX, YUVSubsamplingType su
   return chromaOffset == 0;
 }
 
-// Compute the MSE between the given char sources for numPixels bytes
-template<typename T>
-double computeMSE(T ptr, T ptr2, int numPixels)
+// Compute the sum of squared errors between the given sources for numPixels samples. The sum is calculated
+// in blocks with an accumulator of type Acc that can not overflow within one block so that the compiler can
+// vectorize the inner loop. After each block, the computation is aborted if the sum exceeds maxSSE.
+template<typename T, typename Acc>
+uint64_t computeSSE(const T * restrict ptr, const T * restrict ptr2, int numPixels, uint64_t maxSSE)
 {
-  if (numPixels <= 0)
-    return 0.0;
+  const int blockSize = 4096;
 
-  uint64_t sad = 0;
-  for(int i=0; i<numPixels; i++)
+  uint64_t sse = 0;
+  for (int blockStart = 0; blockStart < numPixels; blockStart += blockSize)
   {
-    int diff = (int)ptr[i] - (int)ptr2[i];
-    sad += diff*diff;
+    const int blockEnd = std::min(blockStart + blockSize, numPixels);
+    Acc blockSSE = 0;
+    for (int i = blockStart; i < blockEnd; i++)
+    {
+      const int diff = (int)ptr[i] - (int)ptr2[i];
+      blockSSE += (Acc)(diff*diff);
+    }
+    sse += blockSSE;
+    if (sse > maxSSE)
+      break;
   }
-
-  return (double)sad / numPixels;
+  return sse;
 }
 
 namespace YUV_Internals
@@ -672,7 +692,25 @@ void videoHandlerYUV::drawFrame(QPainter *painter, int frameIdx, double zoomFact
     painter->drawText(textRect, msg);
   }
   else
+  {
+    // Get the visible part of the frame in pixels. This is used for the tile conversion of very large frames.
+    QRectF visibleArea = painter->combinedTransform().inverted().mapRect(QRectF(painter->viewport()));
+    if (painter->hasClipping())
+      visibleArea &= painter->clipBoundingRect();
+    const QPointF frameTopLeft(-frameSize.width() * zoomFactor / 2, -frameSize.height() * zoomFactor / 2);
+    const QRectF visibleAreaFrame((visibleArea.topLeft() - frameTopLeft) / zoomFactor, visibleArea.size() / zoomFactor);
+    const QRect visibleRect = visibleAreaFrame.toAlignedRect().intersected(QRect(QPoint(0, 0), frameSize));
+
+    tileConversionMutex.lock();
+    tileVisibleRect = visibleRect;
+    tileConversionMutex.unlock();
+
+    // If the current image was only converted in parts, convert the tiles that are visible now
+    if (nrTilesNotConverted.load() > 0)
+      convertTiles(visibleRect);
+
     videoHandler::drawFrame(painter, frameIdx, zoomFactor, drawRawData);
+  }
 }
 
 /// --- Convert from the current YUV input format to YUV 444
@@ -1188,8 +1226,9 @@ void videoHandlerYUV::drawPixelValues(QPainter *painter, const int frameIdx, con
   QRect pixelRect;
   pixelRect.setSize(QSize(zoomFactor, zoomFactor));
 
-  // We might change the pen doing this so backup the current pen and reset it later
-  QPen backupPen = painter->pen();
+  // The values are drawn from the glyph atlas
+  pixelValueGlyphAtlas &glyphAtlas = getPixelValueGlyphAtlas();
+  glyphAtlas.begin(painter);
 
   // If the Y is below this value, use white text, otherwise black text
   // If there is a second item, a difference will be drawn. A difference of 0 is displayed as gray.
@@ -1266,47 +1305,37 @@ void videoHandlerYUV::drawPixelValues(QPainter *painter, const int frameIdx, con
         drawWhite = (mathParameters[Luma].invert) ? (Y > whiteLimit) : (Y < whiteLimit);
       }
 
-      // Set the pen
-      painter->setPen(drawWhite ? Qt::white : Qt::black);
-
+      const int values[3] = {Y, U, V};
       if (chromaPresent && (x-chromaOffsetFullX) % subsamplingX == 0 && (y-chromaOffsetFullY) % subsamplingY == 0)
       {
-        QString valText;
         if (chromaOffsetHalfX || chromaOffsetHalfY)
           // We will only draw the Y value at the center of this pixel
-          valText = QString("Y%1").arg(Y);
+          glyphAtlas.addValues(pixelRect, "Y", values, 1, drawWhite);
         else
           // We also draw the U and V value at this position
-          valText = QString("Y%1\nU%2\nV%3").arg(Y).arg(U).arg(V);
-        // Draw
-        painter->drawText(pixelRect, Qt::AlignCenter, valText);
+          glyphAtlas.addValues(pixelRect, "YUV", values, 3, drawWhite);
 
         if (chromaOffsetHalfX || chromaOffsetHalfY)
         {
           // Draw the U and V values shifted half a pixel right and/or down
-          valText = QString("U%1\nV%2").arg(U).arg(V);
-
           // Move the QRect by half a pixel
           if (chromaOffsetHalfX)
             pixelRect.translate(zoomFactor/2, 0);
           if (chromaOffsetHalfY)
             pixelRect.translate(0, zoomFactor/2);
 
-          // Draw
-          painter->drawText(pixelRect, Qt::AlignCenter, valText);
+          glyphAtlas.addValues(pixelRect, "UV", values + 1, 2, drawWhite);
         }
       }
       else
       {
         // We only draw the luma value for this pixel
-        QString valText = QString("Y%1").arg(Y);
-        painter->drawText(pixelRect, Qt::AlignCenter, valText);
+        glyphAtlas.addValues(pixelRect, "Y", values, 1, drawWhite);
       }
     }
   }
 
-  // Reset pen
-  painter->setPen(backupPen);
+  glyphAtlas.end(painter);
 }
 
 void videoHandlerYUV::setFormatFromSizeAndName(const QSize size, int bitDepth, int64_t fileSize, const QFileInfo &fileInfo)
@@ -1508,9 +1537,23 @@ void videoHandlerYUV::setFormatFromSizeAndName(const QSize size, int bitDepth, i
   * is skipped.
   */
 void videoHandlerYUV::setFormatFromCorrelation(const QByteArray &rawYUVData, int64_t fileSize)
+{
+  QSize bestSize;
+  yuvPixelFormat bestFormat;
+  if (getFormatFromCorrelation(rawYUVData, fileSize, bestSize, bestFormat))
+  {
+    setSrcPixelFormat(bestFormat, false);
+    setFrameSize(bestSize);
+  }
+}
+
+bool videoHandlerYUV::getFormatFromCorrelation(const QByteArray &rawYUVData, int64_t fileSize, QSize &frameSize, yuvPixelFormat &format)
 {
   if(rawYUVData.size() < 1)
-    return;
+    return false;
+
+  // A candidate is only chosen if the MSE between the first two frames is below this threshold.
+  const double maxMSE = 400;
 
   class testFormatAndSize
   {
@@ -1577,33 +1620,46 @@ void videoHandlerYUV::setFormatFromCorrelation(const QByteArray &rawYUVData, int
 
     if(!found)
       // No candidate matches the file size
-      return;
+      return false;
   }
 
-  // calculate max. correlation for first two frames, use max. candidate frame size
+  // We can only test candidates for which the first two frames are in the given data
   for (testFormatAndSize &testFormat : formatList)
+    if (testFormat.format.bytesPerFrame(testFormat.size) * 2 > rawYUVData.size())
+      testFormat.interesting = false;
+
+  // calculate max. correlation for first two frames, use max. candidate frame size.
+  // The candidates are independent of each other, so we test them in parallel. The calculation for a candidate
+  // is aborted as soon as it is clear that its MSE will be above the threshold.
+  QtConcurrent::blockingMap(formatList, [&rawYUVData, maxMSE](testFormatAndSize &testFormat)
   {
-    if (testFormat.interesting)
-    {
-      int64_t picSize = testFormat.format.bytesPerFrame(testFormat.size);
-      int lumaSamples = testFormat.size.width() * testFormat.size.height();
+    if (!testFormat.interesting)
+      return;
 
-      // Calculate the MSE for 2 frames
-      if (testFormat.format.bitsPerSample == 8)
-      {
-        unsigned char *ptr = (unsigned char*) rawYUVData.data();
-        testFormat.mse = computeMSE(ptr, ptr + picSize, lumaSamples);
-      }
-      else if (testFormat.format.bitsPerSample > 8 && testFormat.format.bitsPerSample <= 16)
-      {
-        unsigned short *ptr = (unsigned short*) rawYUVData.data();
-        testFormat.mse = computeMSE(ptr, ptr + picSize/2, lumaSamples);
-      }
-      else
-        // Not handled here
-        continue;
+    const int64_t picSize = testFormat.format.bytesPerFrame(testFormat.size);
+    const int lumaSamples = testFormat.size.width() * testFormat.size.height();
+    const uint64_t maxSSE = uint64_t(maxMSE * lumaSamples);
+
+    // Calculate the MSE for 2 frames
+    uint64_t sse;
+    if (testFormat.format.bitsPerSample == 8)
+    {
+      const unsigned char *ptr = (const unsigned char*) rawYUVData.constData();
+      sse = computeSSE<unsigned char, uint32_t>(ptr, ptr + picSize, lumaSamples, maxSSE);
     }
-  }
+    else if (testFormat.format.bitsPerSample > 8 && testFormat.format.bitsPerSample <= 16)
+    {
+      const unsigned short *ptr = (const unsigned short*) rawYUVData.constData();
+      sse = computeSSE<unsigned short, uint64_t>(ptr, ptr + picSize/2, lumaSamples, maxSSE);
+    }
+    else
+    {
+      // Not handled here
+      testFormat.interesting = false;
+      return;
+    }
+    testFormat.mse = (lumaSamples > 0) ? double(sse) / lumaSamples : 0.0;
+  });
 
   // step3: select best candidate
   double leastMSE = std::numeric_limits<double>::max(); // large error...
@@ -1619,12 +1675,14 @@ void videoHandlerYUV::setFormatFromCorrelation(const QByteArray &rawYUVData, int
     }
   }
 
-  if(leastMSE < 400)
+  if(leastMSE < maxMSE)
   {
     // MSE is below threshold. Choose the candidate.
-    setSrcPixelFormat(bestFormat, false);
-    setFrameSize(bestSize);
+    format = bestFormat;
+    frameSize = bestSize;
+    return true;
   }
+  return false;
 }
 
 void videoHandlerYUV::loadFrame(int frameIndex, bool loadToDoubleBuffer)
@@ -1652,27 +1710,193 @@ void videoHandlerYUV::loadFrame(int frameIndex, bool loadToDoubleBuffer)
   else if (currentImageIdx != frameIndex)
   {
     QImage newImage;
-    convertYUVToImage(currentFrameRawData, newImage, srcPixelFormat, frameSize);
+    const QRect tileRect = getTileConversionRect();
+    if (tileRect.isEmpty())
+    {
+      convertYUVToImage(currentFrameRawData, newImage, srcPixelFormat, frameSize);
+
+      // The image of a previous tile conversion is not needed anymore
+      QMutexLocker tileLock(&tileConversionMutex);
+      tileImage = QImage();
+      tileImageBits = nullptr;
+      tileRawData.clear();
+      nrTilesNotConverted.store(0);
+    }
+    else
+      // Only a small part of this very large frame is visible. Only convert the tiles around the visible part.
+      startTileConversion(newImage, tileRect);
     QMutexLocker setLock(&currentImageSetMutex);    
     currentImage = newImage;
     currentImageIdx = frameIndex;
   }
 }
 
-void videoHandlerYUV::loadFrameForCaching(int frameIndex, QImage &frameToCache)
+// Copy the given region of the frame in src to dst. The result has the same YUV format as the frame. The region must
+// be aligned to the chroma subsampling. Only the data that is needed for the conversion to RGB is copied (no alpha plane).
+inline void getYUVFrameRegion(const QByteArray &src, QByteArray &dst, const QSize &frameSize, const yuvPixelFormat &format, const QRect &region)
 {
-  DEBUG_YUV("videoHandlerYUV::loadFrameForCaching %d", frameIndex);
+  dst.resize(format.bytesPerFrame(region.size()));
 
-  // Get the YUV format and the size here, so that the caching process does not crash if this changes.
-  yuvPixelFormat yuvFormat = srcPixelFormat;
-  const QSize curFrameSize = frameSize;
+  const int bytesPerSample = (format.bitsPerSample > 8) ? 2 : 1;
+  const char * restrict srcData = src.constData();
+  char * restrict dstData = dst.data();
 
-  requestDataMutex.lock();
-  emit signalRequestRawData(frameIndex, true);
-  QByteArray tmpBufferRawYUVDataCaching = rawData;
-  requestDataMutex.unlock();
+  // Copy the lines of the region from a plane with the given size. Each pixel of the plane has valuesPerPixel values.
+  auto copyPlaneRegion = [&](int planeWidth, int planeHeight, const QRect &planeRegion, int valuesPerPixel)
+  {
+    const int lineBytes = planeRegion.width() * valuesPerPixel * bytesPerSample;
+    for (int y = planeRegion.top(); y <= planeRegion.bottom(); y++)
+    {
+      memcpy(dstData, srcData + (y * planeWidth + planeRegion.left()) * valuesPerPixel * bytesPerSample, lineBytes);
+      dstData += lineBytes;
+    }
+    srcData += planeWidth * planeHeight * valuesPerPixel * bytesPerSample;
+  };
+
+  const int w = frameSize.width();
+  const int h = frameSize.height();
+  if (!format.planar)
+  {
+    // The values of the packed formats are all in one plane. For 4:2:2 there are 2 values per pixel.
+    const YUVPackingOrder packing = format.packingOrder;
+    const int valuesPerPixel = (format.subsampling == YUV_422) ? 2 : (packing == Packing_YUV || packing == Packing_YVU) ? 3 : 4;
+    copyPlaneRegion(w, h, region, valuesPerPixel);
+    return;
+  }
+
+  // Luma plane
+  copyPlaneRegion(w, h, region, 1);
+  if (format.subsampling == YUV_400)
+    return;
 
-  if (frameIndex != rawData_frameIdx)
+  // Chroma planes
+  const int subW = format.getSubsamplingHor();
+  const int subH = format.getSubsamplingVer();
+  const QRect chromaRegion(region.left() / subW, region.top() / subH, region.width() / subW, region.height() / subH);
+  if (format.uvInterleaved)
+  {
+    const int valuesPerPixel = (format.planeOrder == Order_YUV || format.planeOrder == Order_YVU) ? 2 : 3;
+    copyPlaneRegion(w / subW, h / subH, chromaRegion, valuesPerPixel);
+  }
+  else
+  {
+    copyPlaneRegion(w / subW, h / subH, chromaRegion, 1);
+    copyPlaneRegion(w / subW, h / subH, chromaRegion, 1);
+  }
+}
+
+QRect videoHandlerYUV::getTileConversionRect() const
+{
+  if (int64_t(frameSize.width()) * frameSize.height() < YUV_TILE_CONVERSION_MIN_PIXELS)
+    return QRect();
+  if (!srcPixelFormat.planar && srcPixelFormat.bytePacking)
+    return QRect();
+
+  QMutexLocker lock(&tileConversionMutex);
+  const QRect rect = tileVisibleRect.adjusted(-YUV_TILE_CONVERSION_MARGIN, -YUV_TILE_CONVERSION_MARGIN, YUV_TILE_CONVERSION_MARGIN, YUV_TILE_CONVERSION_MARGIN).intersected(QRect(QPoint(0, 0), frameSize));
+
+  // If most of the frame is visible anyways (or nothing was drawn yet), the whole frame is converted at once.
+  if (rect.isEmpty() || int64_t(rect.width()) * rect.height() > int64_t(frameSize.width()) * frameSize.height() / 2)
+    return QRect();
+  return rect;
+}
+
+void videoHandlerYUV::startTileConversion(QImage &image, const QRect &rect)
+{
+  QMutexLocker lock(&tileConversionMutex);
+
+  // The image is not shared yet. Get the pointer to the data now so that writing the tiles does not detach it later.
+  tileImage = QImage(frameSize, platformImageFormat());
+  tileImageBits = tileImage.bits();
+  tileRawData = currentFrameRawData;
+  tileFormat = srcPixelFormat;
+
+  const int nrTiles = ((frameSize.width() + YUV_TILE_SIZE - 1) / YUV_TILE_SIZE) * ((frameSize.height() + YUV_TILE_SIZE - 1) / YUV_TILE_SIZE);
+  tilesConverted = QBitArray(nrTiles);
+  nrTilesNotConverted.store(nrTiles);
+
+  convertTilesInRect(rect);
+  image = tileImage;
+}
+
+void videoHandlerYUV::convertTiles(const QRect &rect)
+{
+  QMutexLocker lock(&tileConversionMutex);
+  if (tileImage.isNull())
+    return;
+
+  // Is the tileImage still the current image?
+  currentImageSetMutex.lock();
+  const bool isCurrentImage = (currentImage.constBits() == tileImageBits);
+  currentImageSetMutex.unlock();
+  if (isCurrentImage)
+    convertTilesInRect(rect);
+}
+
+void videoHandlerYUV::convertTilesInRect(const QRect &rect)
+{
+  const QRect frameRect(QPoint(0, 0), tileImage.size());
+  const int nrTilesHor = (frameRect.width() + YUV_TILE_SIZE - 1) / YUV_TILE_SIZE;
+  const QRect convertRect = rect.intersected(frameRect);
+  if (convertRect.isEmpty())
+    return;
+
+  // Get all tiles in the rect which were not converted yet
+  QList<QRect> tiles;
+  for (int y = convertRect.top() / YUV_TILE_SIZE; y <= convertRect.bottom() / YUV_TILE_SIZE; y++)
+  {
+    for (int x = convertRect.left() / YUV_TILE_SIZE; x <= convertRect.right() / YUV_TILE_SIZE; x++)
+    {
+      if (tilesConverted.testBit(y * nrTilesHor + x))
+        continue;
+      tilesConverted.setBit(y * nrTilesHor + x);
+      tiles.append(QRect(x * YUV_TILE_SIZE, y * YUV_TILE_SIZE, YUV_TILE_SIZE, YUV_TILE_SIZE).intersected(frameRect));
+    }
+  }
+  if (tiles.isEmpty())
+    return;
+  DEBUG_YUV("videoHandlerYUV::convertTilesInRect Converting %d tiles", tiles.count());
+
+  // Convert the tiles in parallel and copy them into the image
+  const int bytesPerLine = tileImage.bytesPerLine();
+  const int bytesPerPixel = tileImage.depth() / 8;
+  QtConcurrent::blockingMap(tiles, [&](const QRect &tile)
+  {
+    const QRect tileWithBorder = tile.adjusted(-YUV_TILE_BORDER, -YUV_TILE_BORDER, YUV_TILE_BORDER, YUV_TILE_BORDER).intersected(frameRect);
+    QByteArray tileRaw;
+    getYUVFrameRegion(tileRawData, tileRaw, frameRect.size(), tileFormat, tileWithBorder);
+    QImage tileRGB;
+    convertYUVToImage(tileRaw, tileRGB, tileFormat, tileWithBorder.size());
+
+    const int offsetX = (tile.x() - tileWithBorder.x()) * bytesPerPixel;
+    for (int y = 0; y < tile.height(); y++)
+      memcpy(tileImageBits + (tile.y() + y) * bytesPerLine + tile.x() * bytesPerPixel, tileRGB.constScanLine(tile.y() - tileWithBorder.y() + y) + offsetX, tile.width() * bytesPerPixel);
+  });
+
+  if (nrTilesNotConverted.fetchAndAddOrdered(-tiles.count()) == tiles.count())
+  {
+    // All tiles are converted. The image is complete.
+    tileImage = QImage();
+    tileImageBits = nullptr;
+    tileRawData.clear();
+  }
+}
+
+QRgb videoHandlerYUV::getPixelVal(int x, int y)
+{
+  if (nrTilesNotConverted.load() > 0)
+    convertTiles(QRect(x, y, 1, 1));
+  return videoHandler::getPixelVal(x, y);
+}
+
+void videoHandlerYUV::loadFrameForCaching(int frameIndex, QImage &frameToCache)
+{
+  DEBUG_YUV("videoHandlerYUV::loadFrameForCaching %d", frameIndex);
+
+  yuvPixelFormat yuvFormat;
+  QSize curFrameSize;
+  QByteArray tmpBufferRawYUVDataCaching;
+  if (!loadRawYUVDataForCaching(frameIndex, tmpBufferRawYUVDataCaching, yuvFormat, curFrameSize))
   {
     // Loading failed
     DEBUG_YUV("videoHandlerYUV::loadFrameForCaching Loading failed");
@@ -1683,6 +1907,21 @@ void videoHandlerYUV::loadFrameForCaching(int frameIndex, QImage &frameToCache)
   convertYUVToImage(tmpBufferRawYUVDataCaching, frameToCache, yuvFormat, curFrameSize);
 }
 
+bool videoHandlerYUV::loadRawYUVDataForCaching(int frameIndex, QByteArray &rawYUV, yuvPixelFormat &yuvFormat, QSize &curFrameSize)
+{
+  // Get the YUV format and the size here, so that the caching process does not crash if this changes.
+  yuvFormat = srcPixelFormat;
+  curFrameSize = frameSize;
+
+  QMutexLocker lock(&requestDataMutex);
+  emit signalRequestRawData(frameIndex, true);
+  if (frameIndex != rawData_frameIdx || rawData.isEmpty())
+    return false;
+
+  rawYUV = rawData;
+  return true;
+}
+
 // Load the raw YUV data for the given frame index into currentFrameRawData.
 bool videoHandlerYUV::loadRawYUVData(int frameIndex)
 {
@@ -1794,6 +2033,16 @@ inline int getValueFromSource(const unsigned char * restrict src, const int idx,
     return src[idx];
 }
 
+// The same as getValueFromSource but with the sample size and the endianness known at compile time.
+// Using this in the conversion functions gets rid of all the per sample branches.
+template<bool twoBytes, bool bigEndian>
+inline int getValueFromSource(const unsigned char * restrict src, const int idx)
+{
+  if (twoBytes)
+    return (bigEndian) ? src[idx*2] << 8 | src[idx*2+1] : src[idx*2] | src[idx*2+1] << 8;
+  return src[idx];
+}
+
 inline void setValueInBuffer(unsigned char * restrict dst, const int val, const int idx, const int bps, const bool bigEndian)
 {
   if (bps > 8)
@@ -1815,16 +2064,30 @@ inline void setValueInBuffer(unsigned char * restrict dst, const int val, const
     dst[idx] = val;
 }
 
+template<bool twoBytes, bool bigEndian>
+inline void setValueInBuffer(unsigned char * restrict dst, const int val, const int idx)
+{
+  if (twoBytes)
+  {
+    dst[idx*2]   = (bigEndian) ? val >> 8 : val & 0xff;
+    dst[idx*2+1] = (bigEndian) ? val & 0xff : val >> 8;
+  }
+  else
+    dst[idx] = val;
+}
+
 // For every input sample in src, apply YUV transformation, (scale to 8 bit if required) and set the value as RGB (monochrome).
 // inValSkip: skip this many values in the input for every value. For pure planar formats, this 1. If the UV components are interleaved, this is 2 or 3.
-inline void YUVPlaneToRGBMonochrome_444(const int componentSize, const yuvMathParameters math, const unsigned char * restrict src, unsigned char * restrict dst,
-                                        const int inMax, const int bps, const bool bigEndian, const int inValSkip, const bool fullRange)
+template<bool twoBytes, bool bigEndian, bool fullRange>
+inline void YUVPlaneToRGBMonochrome_444(const int w, const int h, const yuvMathParameters math, const unsigned char * restrict src, unsigned char * restrict dst,
+                                        const int inMax, const int bps, const int inValSkip)
 {
   const bool applyMath = math.yuvMathRequired();
   const int shiftTo8Bit = bps - 8;
+  const int componentSize = w * h;
   for (int i = 0; i < componentSize; ++i)
   {
-    int newVal = getValueFromSource(src, i*inValSkip, bps, bigEndian);
+    int newVal = getValueFromSource<twoBytes, bigEndian>(src, i*inValSkip);
     if (applyMath)
       newVal = transformYUV(math.invert, math.scale, math.offset, newVal, inMax);
 
@@ -1847,14 +2110,16 @@ inline void YUVPlaneToRGBMonochrome_444(const int componentSize, const yuvMathPa
 
 // For every input sample in the YZV 422 src, apply interpolation (sample and hold), apply YUV transformation, (scale to 8 bit if required)
 // and set the value as RGB (monochrome).
-inline void YUVPlaneToRGBMonochrome_422(const int componentSize, const yuvMathParameters math, const unsigned char * restrict src, unsigned char * restrict dst,
-                                        const int inMax, const int bps, const bool bigEndian, const int inValSkip, const bool fullRange)
+template<bool twoBytes, bool bigEndian, bool fullRange>
+inline void YUVPlaneToRGBMonochrome_422(const int w, const int h, const yuvMathParameters math, const unsigned char * restrict src, unsigned char * restrict dst,
+                                        const int inMax, const int bps, const int inValSkip)
 {
   const bool applyMath = math.yuvMathRequired();
   const int shiftTo8Bit = bps - 8;
+  const int componentSize = (w / 2) * h;
   for (int i = 0; i < componentSize; ++i)
   {
-    int newVal = getValueFromSource(src, i*inValSkip, bps, bigEndian);
+    int newVal = getValueFromSource<twoBytes, bigEndian>(src, i*inValSkip);
     if (applyMath)
       newVal = transformYUV(math.invert, math.scale, math.offset, newVal, inMax);
 
@@ -1878,8 +2143,9 @@ inline void YUVPlaneToRGBMonochrome_422(const int componentSize, const yuvMathPa
   }
 }
 
+template<bool twoBytes, bool bigEndian, bool fullRange>
 inline void YUVPlaneToRGBMonochrome_420(const int w, const int h, const yuvMathParameters math, const unsigned char * restrict src, unsigned char * restrict dst,
-                                        const int inMax, const int bps, const bool bigEndian, const int inValSkip, const bool fullRange)
+                                        const int inMax, const int bps, const int inValSkip)
 {
   const bool applyMath = math.yuvMathRequired();
   const int shiftTo8Bit = bps - 8;
@@ -1887,7 +2153,7 @@ inline void YUVPlaneToRGBMonochrome_420(const int w, const int h, const yuvMathP
     for (int x = 0; x < w/2; x++)
     {
       const int srcIdx = y*(w/2)+x;
-      int newVal = getValueFromSource(src, srcIdx*inValSkip, bps, bigEndian);
+      int newVal = getValueFromSource<twoBytes, bigEndian>(src, srcIdx*inValSkip);
       if (applyMath)
         newVal = transformYUV(math.invert, math.scale, math.offset, newVal, inMax);
 
@@ -1921,8 +2187,9 @@ inline void YUVPlaneToRGBMonochrome_420(const int w, const int h, const yuvMathP
     }
 }
 
+template<bool twoBytes, bool bigEndian, bool fullRange>
 inline void YUVPlaneToRGBMonochrome_440(const int w, const int h, const yuvMathParameters math, const unsigned char * restrict src, unsigned char * restrict dst,
-                                        const int inMax, const int bps, const bool bigEndian, const int inValSkip, const bool fullRange)
+                                        const int inMax, const int bps, const int inValSkip)
 {
   const bool applyMath = math.yuvMathRequired();
   const int shiftTo8Bit = bps - 8;
@@ -1930,7 +2197,7 @@ inline void YUVPlaneToRGBMonochrome_440(const int w, const int h, const yuvMathP
     for (int x = 0; x < w; x++)
     {
       const int srcIdx = y*w+x;
-      int newVal = getValueFromSource(src, srcIdx*inValSkip, bps, bigEndian);
+      int newVal = getValueFromSource<twoBytes, bigEndian>(src, srcIdx*inValSkip);
       if (applyMath)
         newVal = transformYUV(math.invert, math.scale, math.offset, newVal, inMax);
 
@@ -1956,8 +2223,9 @@ inline void YUVPlaneToRGBMonochrome_440(const int w, const int h, const yuvMathP
     }
 }
 
+template<bool twoBytes, bool bigEndian, bool fullRange>
 inline void YUVPlaneToRGBMonochrome_410(const int w, const int h, const yuvMathParameters math, const unsigned char * restrict src, unsigned char * restrict dst,
-  const int inMax, const int bps, const bool bigEndian, const int inValSkip, const bool fullRange)
+                                        const int inMax, const int bps, const int inValSkip)
 {
   // Horizontal subsampling by 4, vertical subsampling by 4
   const bool applyMath = math.yuvMathRequired();
@@ -1966,7 +2234,7 @@ inline void YUVPlaneToRGBMonochrome_410(const int w, const int h, const yuvMathP
     for (int x = 0; x < w/4; x++)
     {
       const int srcIdx = y*(w/4)+x;
-      int newVal = getValueFromSource(src, srcIdx*inValSkip, bps, bigEndian);
+      int newVal = getValueFromSource<twoBytes, bigEndian>(src, srcIdx*inValSkip);
 
       if (applyMath)
         newVal = transformYUV(math.invert, math.scale, math.offset, newVal, inMax);
@@ -1992,15 +2260,17 @@ inline void YUVPlaneToRGBMonochrome_410(const int w, const int h, const yuvMathP
     }
 }
 
-inline void YUVPlaneToRGBMonochrome_411(const int componentSize, const yuvMathParameters math, const unsigned char * restrict src, unsigned char * restrict dst,
-                                        const int inMax, const int bps, const bool bigEndian, const int inValSkip, const bool fullRange)
+template<bool twoBytes, bool bigEndian, bool fullRange>
+inline void YUVPlaneToRGBMonochrome_411(const int w, const int h, const yuvMathParameters math, const unsigned char * restrict src, unsigned char * restrict dst,
+                                        const int inMax, const int bps, const int inValSkip)
 {
   // Horizontally U and V are subsampled by 4
   const bool applyMath = math.yuvMathRequired();
   const int shiftTo8Bit = bps - 8;
+  const int componentSize = (w / 4) * h;
   for (int i = 0; i < componentSize; ++i)
   {
-    int newVal = getValueFromSource(src, i*inValSkip, bps, bigEndian);
+    int newVal = getValueFromSource<twoBytes, bigEndian>(src, i*inValSkip);
     if (applyMath)
       newVal = transformYUV(math.invert, math.scale, math.offset, newVal, inMax);
 
@@ -2088,6 +2358,7 @@ inline int interpolateUV8Pos(int prev, int cur, const int offsetX8)
 }
 
 // Re-sample the chroma component so that the chroma samples and the luma samples are aligned after this operation.
+template<bool twoBytes, bool bigEndian>
 inline void UVPlaneResamplingChromaOffset(const yuvPixelFormat format, const int w, const int h, 
                                           const unsigned char * restrict srcU, const unsigned char * restrict srcV, const int inValSkip,
                                           unsigned char * restrict dstU, unsigned char * restrict dstV)
@@ -2099,11 +2370,7 @@ inline void UVPlaneResamplingChromaOffset(const yuvPixelFormat format, const int
   const int offsetX8 = (possibleValsX == 1) ? format.chromaOffset[0] * 4 : (possibleValsX == 3) ? format.chromaOffset[0] * 2 : format.chromaOffset[0];
   const int offsetY8 = (possibleValsY == 1) ? format.chromaOffset[1] * 4 : (possibleValsY == 3) ? format.chromaOffset[1] * 2 : format.chromaOffset[1];
 
-  // The format to use for input/output
-  const bool bigEndian = format.bigEndian;
-  const int bps = format.bitsPerSample;
-
-  const int stride = bps > 8 ? w*2 : w;
+  const int stride = twoBytes ? w*2 : w;
   if (offsetX8 != 0)
   {
     // Perform horizontal re-sampling
@@ -2111,23 +2378,23 @@ inline void UVPlaneResamplingChromaOffset(const yuvPixelFormat format, const int
     {
       // On the left side, there is no previous sample, so the first value is never changed.
       const int srcIdx = y * stride * inValSkip;
-      int prevU = getValueFromSource(srcU, srcIdx, bps, bigEndian);
-      int prevV = getValueFromSource(srcV, srcIdx, bps, bigEndian);
-      setValueInBuffer(dstU, prevU, y*stride, bps, bigEndian);
-      setValueInBuffer(dstV, prevV, y*stride, bps, bigEndian);
+      int prevU = getValueFromSource<twoBytes, bigEndian>(srcU, srcIdx);
+      int prevV = getValueFromSource<twoBytes, bigEndian>(srcV, srcIdx);
+      setValueInBuffer<twoBytes, bigEndian>(dstU, prevU, y*stride);
+      setValueInBuffer<twoBytes, bigEndian>(dstV, prevV, y*stride);
 
       for (int x = 0; x < w-1; x++)
       {
         // Calculate the new current value using the previous and the current value
         const int srcIdxInLine = srcIdx + (x+1)*inValSkip;
-        int curU = getValueFromSource(srcU, srcIdxInLine, bps, bigEndian);
-        int curV = getValueFromSource(srcV, srcIdxInLine, bps, bigEndian);
+        int curU = getValueFromSource<twoBytes, bigEndian>(srcU, srcIdxInLine);
+        int curV = getValueFromSource<twoBytes, bigEndian>(srcV, srcIdxInLine);
 
         // Perform interpolation and save the value for the current UV value. Goto next value.
         int newU = interpolateUV8Pos(prevU, curU, offsetX8);
         int newV = interpolateUV8Pos(prevV, curV, offsetX8);
-        setValueInBuffer(dstU, newU, y*stride+x, bps, bigEndian);
-        setValueInBuffer(dstV, newV, y*stride+x, bps, bigEndian);
+        setValueInBuffer<twoBytes, bigEndian>(dstU, newU, y*stride+x);
+        setValueInBuffer<twoBytes, bigEndian>(dstV, newV, y*stride+x);
 
         prevU = curU;
         prevV = curV;
@@ -2146,23 +2413,23 @@ inline void UVPlaneResamplingChromaOffset(const yuvPixelFormat format, const int
     for (int x = 0; x < w; x++)
     {
       // On the top, there is no previous sample, so the first value is never changed.
-      int prevU = getValueFromSource(srcUStep2, x*valSkipStep2, bps, bigEndian);
-      int prevV = getValueFromSource(srcVStep2, x*valSkipStep2, bps, bigEndian);
-      setValueInBuffer(dstU, prevU, x, bps, bigEndian);
-      setValueInBuffer(dstV, prevV, x, bps, bigEndian);
+      int prevU = getValueFromSource<twoBytes, bigEndian>(srcUStep2, x*valSkipStep2);
+      int prevV = getValueFromSource<twoBytes, bigEndian>(srcVStep2, x*valSkipStep2);
+      setValueInBuffer<twoBytes, bigEndian>(dstU, prevU, x);
+      setValueInBuffer<twoBytes, bigEndian>(dstV, prevV, x);
 
       for (int y = 0; y < h-1; y++)
       {
         // Calculate the new current value using the previous and the current value
         const int srcIdx = (y+1) * w + x;
-        int curU = getValueFromSource(srcUStep2, srcIdx*valSkipStep2, bps, bigEndian);
-        int curV = getValueFromSource(srcVStep2, srcIdx*valSkipStep2, bps, bigEndian);
+        int curU = getValueFromSource<twoBytes, bigEndian>(srcUStep2, srcIdx*valSkipStep2);
+        int curV = getValueFromSource<twoBytes, bigEndian>(srcVStep2, srcIdx*valSkipStep2);
 
         // Perform interpolation and save the value for the current UV value. Goto next value.
         int newU = interpolateUV8Pos(prevU, curU, offsetY8);
         int newV = interpolateUV8Pos(prevV, curV, offsetY8);
-        setValueInBuffer(dstU, newU, srcIdx, bps, bigEndian);
-        setValueInBuffer(dstV, newV, srcIdx, bps, bigEndian);
+        setValueInBuffer<twoBytes, bigEndian>(dstU, newU, srcIdx);
+        setValueInBuffer<twoBytes, bigEndian>(dstV, newV, srcIdx);
 
         prevU = curU;
         prevV = curV;
@@ -2171,18 +2438,21 @@ inline void UVPlaneResamplingChromaOffset(const yuvPixelFormat format, const int
   }
 }
 
-inline void YUVPlaneToRGB_444(const int componentSize, const yuvMathParameters mathY, const yuvMathParameters mathC,
+template<bool twoBytes, bool bigEndian, bool fullRange, InterpolationMode interpolation>
+inline void YUVPlaneToRGB_444(const int w, const int h, const yuvMathParameters mathY, const yuvMathParameters mathC,
                               const unsigned char * restrict srcY, const unsigned char * restrict srcU, const unsigned char * restrict srcV,
-                              unsigned char * restrict dst, const int RGBConv[5], const bool fullRange, const int inMax, const int bps, const bool bigEndian, const int inValSkip)
+                              unsigned char * restrict dst, const int RGBConv[5], const int inMax, const int bps, const int inValSkip)
 {
+  // No interpolation is required for 4:4:4.
   const bool applyMathLuma = mathY.yuvMathRequired();
   const bool applyMathChroma = mathC.yuvMathRequired();
+  const int componentSize = w * h;
 
   for (int i = 0; i < componentSize; ++i)
   {
-    unsigned int valY = getValueFromSource(srcY, i, bps, bigEndian);
-    unsigned int valU = getValueFromSource(srcU, i*inValSkip, bps, bigEndian);
-    unsigned int valV = getValueFromSource(srcV, i*inValSkip, bps, bigEndian);
+    unsigned int valY = getValueFromSource<twoBytes, bigEndian>(srcY, i);
+    unsigned int valU = getValueFromSource<twoBytes, bigEndian>(srcU, i*inValSkip);
+    unsigned int valV = getValueFromSource<twoBytes, bigEndian>(srcV, i*inValSkip);
 
     if (applyMathLuma)
       valY = transformYUV(mathY.invert, mathY.scale, mathY.offset, valY, inMax);
@@ -2204,9 +2474,10 @@ inline void YUVPlaneToRGB_444(const int componentSize, const yuvMathParameters m
   }
 }
 
+template<bool twoBytes, bool bigEndian, bool fullRange, InterpolationMode interpolation>
 inline void YUVPlaneToRGB_422(const int w, const int h, const yuvMathParameters mathY, const yuvMathParameters mathC,
                               const unsigned char * restrict srcY, const unsigned char * restrict srcU, const unsigned char * restrict srcV,
-                              unsigned char * restrict dst, const int RGBConv[5], const bool fullRange, const int inMax, const InterpolationMode interpolation, const int bps, const bool bigEndian, const int inValSkip)
+                              unsigned char * restrict dst, const int RGBConv[5], const int inMax, const int bps, const int inValSkip)
 {
   const bool applyMathLuma = mathY.yuvMathRequired();
   const bool applyMathChroma = mathC.yuvMathRequired();
@@ -2214,8 +2485,8 @@ inline void YUVPlaneToRGB_422(const int w, const int h, const yuvMathParameters
   for (int y = 0; y < h; y++)
   {
     const int srcIdxUV = y*w/2;
-    int curUSample = getValueFromSource(srcU, srcIdxUV*inValSkip, bps, bigEndian);
-    int curVSample = getValueFromSource(srcV, srcIdxUV*inValSkip, bps, bigEndian);
+    int curUSample = getValueFromSource<twoBytes, bigEndian>(srcU, srcIdxUV*inValSkip);
+    int curVSample = getValueFromSource<twoBytes, bigEndian>(srcV, srcIdxUV*inValSkip);
     if (applyMathChroma)
     {
       curUSample = transformYUV(mathC.invert, mathC.scale, mathC.offset, curUSample, inMax);
@@ -2226,8 +2497,8 @@ inline void YUVPlaneToRGB_422(const int w, const int h, const yuvMathParameters
     {
       // Get the next U/V sample
       const int srcPosLineUV = srcIdxUV + x + 1;
-      int nextUSample = getValueFromSource(srcU, srcPosLineUV*inValSkip, bps, bigEndian);
-      int nextVSample = getValueFromSource(srcV, srcPosLineUV*inValSkip, bps, bigEndian);
+      int nextUSample = getValueFromSource<twoBytes, bigEndian>(srcU, srcPosLineUV*inValSkip);
+      int nextVSample = getValueFromSource<twoBytes, bigEndian>(srcV, srcPosLineUV*inValSkip);
       if (applyMathChroma)
       {
         nextUSample = transformYUV(mathC.invert, mathC.scale, mathC.offset, nextUSample, inMax);
@@ -2239,8 +2510,8 @@ inline void YUVPlaneToRGB_422(const int w, const int h, const yuvMathParameters
       int interpolatedV = interpolateUVSample(interpolation, curVSample, nextVSample);
 
       // Get the 2 Y samples
-      int valY1 = getValueFromSource(srcY, y*w+x*2,   bps, bigEndian);
-      int valY2 = getValueFromSource(srcY, y*w+x*2+1, bps, bigEndian);
+      int valY1 = getValueFromSource<twoBytes, bigEndian>(srcY, y*w+x*2);
+      int valY2 = getValueFromSource<twoBytes, bigEndian>(srcY, y*w+x*2+1);
       if (applyMathLuma)
       {
         valY1 = transformYUV(mathY.invert, mathY.scale, mathY.offset, valY1, inMax);
@@ -2269,8 +2540,8 @@ inline void YUVPlaneToRGB_422(const int w, const int h, const yuvMathParameters
     // For the last row, there is no next sample. Just reuse the current one again. No interpolation required either.
 
     // Get the 2 Y samples
-    int valY1 = getValueFromSource(srcY, (y+1)*w-2, bps, bigEndian);
-    int valY2 = getValueFromSource(srcY, (y+1)*w-1, bps, bigEndian);
+    int valY1 = getValueFromSource<twoBytes, bigEndian>(srcY, (y+1)*w-2);
+    int valY2 = getValueFromSource<twoBytes, bigEndian>(srcY, (y+1)*w-1);
     if (applyMathLuma)
     {
       valY1 = transformYUV(mathY.invert, mathY.scale, mathY.offset, valY1, inMax);
@@ -2293,9 +2564,10 @@ inline void YUVPlaneToRGB_422(const int w, const int h, const yuvMathParameters
   }
 }
 
+template<bool twoBytes, bool bigEndian, bool fullRange, InterpolationMode interpolation>
 inline void YUVPlaneToRGB_440(const int w, const int h, const yuvMathParameters mathY, const yuvMathParameters mathC,
                               const unsigned char * restrict srcY, const unsigned char * restrict srcU, const unsigned char * restrict srcV,
-                              unsigned char * restrict dst, const int RGBConv[5], const bool fullRange,const int inMax, const InterpolationMode interpolation, const int bps, const bool bigEndian, const int inValSkip)
+                              unsigned char * restrict dst, const int RGBConv[5], const int inMax, const int bps, const int inValSkip)
 {
   const bool applyMathLuma = mathY.yuvMathRequired();
   const bool applyMathChroma = mathC.yuvMathRequired();
@@ -2303,8 +2575,8 @@ inline void YUVPlaneToRGB_440(const int w, const int h, const yuvMathParameters
 
   for (int x = 0; x < w; x++)
   {
-    int curUSample = getValueFromSource(srcU, x*inValSkip, bps, bigEndian);
-    int curVSample = getValueFromSource(srcV, x*inValSkip, bps, bigEndian);
+    int curUSample = getValueFromSource<twoBytes, bigEndian>(srcU, x*inValSkip);
+    int curVSample = getValueFromSource<twoBytes, bigEndian>(srcV, x*inValSkip);
     if (applyMathChroma)
     {
       curUSample = transformYUV(mathC.invert, mathC.scale, mathC.offset, curUSample, inMax);
@@ -2315,8 +2587,8 @@ inline void YUVPlaneToRGB_440(const int w, const int h, const yuvMathParameters
     {
       // Get the next U/V sample
       const int srcIdxUV = y*w+x;
-      int nextUSample = getValueFromSource(srcU, srcIdxUV*inValSkip, bps, bigEndian);
-      int nextVSample = getValueFromSource(srcV, srcIdxUV*inValSkip, bps, bigEndian);
+      int nextUSample = getValueFromSource<twoBytes, bigEndian>(srcU, srcIdxUV*inValSkip);
+      int nextVSample = getValueFromSource<twoBytes, bigEndian>(srcV, srcIdxUV*inValSkip);
       if (applyMathChroma)
       {
         nextUSample = transformYUV(mathC.invert, mathC.scale, mathC.offset, nextUSample, inMax);
@@ -2328,8 +2600,8 @@ inline void YUVPlaneToRGB_440(const int w, const int h, const yuvMathParameters
       int interpolatedV = interpolateUVSample(interpolation, curVSample, nextVSample);
 
       // Get the 2 Y samples
-      int valY1 = getValueFromSource(srcY,     y*2*w+x, bps, bigEndian);
-      int valY2 = getValueFromSource(srcY, (y*2+1)*w+x, bps, bigEndian);
+      int valY1 = getValueFromSource<twoBytes, bigEndian>(srcY,     y*2*w+x);
+      int valY2 = getValueFromSource<twoBytes, bigEndian>(srcY, (y*2+1)*w+x);
       if (applyMathLuma)
       {
         valY1 = transformYUV(mathY.invert, mathY.scale, mathY.offset, valY1, inMax);
@@ -2359,8 +2631,8 @@ inline void YUVPlaneToRGB_440(const int w, const int h, const yuvMathParameters
     // For the last column, there is no next sample. Just reuse the current one again. No interpolation required either.
 
     // Get the 2 Y samples
-    int valY1 = getValueFromSource(srcY, (h-2)*w+x, bps, bigEndian);
-    int valY2 = getValueFromSource(srcY, (h-1)*w+x, bps, bigEndian);
+    int valY1 = getValueFromSource<twoBytes, bigEndian>(srcY, (h-2)*w+x);
+    int valY2 = getValueFromSource<twoBytes, bigEndian>(srcY, (h-1)*w+x);
     if (applyMathLuma)
     {
       valY1 = transformYUV(mathY.invert, mathY.scale, mathY.offset, valY1, inMax);
@@ -2384,9 +2656,10 @@ inline void YUVPlaneToRGB_440(const int w, const int h, const yuvMathParameters
   }
 }
 
+template<bool twoBytes, bool bigEndian, bool fullRange, InterpolationMode interpolation>
 inline void YUVPlaneToRGB_420(const int w, const int h, const yuvMathParameters mathY, const yuvMathParameters mathC,
                               const unsigned char * restrict srcY, const unsigned char * restrict srcU, const unsigned char * restrict srcV,
-                              unsigned char * restrict dst, const int RGBConv[5], const bool fullRange,const int inMax, const InterpolationMode interpolation, const int bps, const bool bigEndian, const int inValSkip)
+                              unsigned char * restrict dst, const int RGBConv[5], const int inMax, const int bps, const int inValSkip)
 {
   const bool applyMathLuma = mathY.yuvMathRequired();
   const bool applyMathChroma = mathC.yuvMathRequired();
@@ -2398,10 +2671,10 @@ inline void YUVPlaneToRGB_420(const int w, const int h, const yuvMathParameters
     // Get the current U/V samples for this y line and the next one (_NL)
     const int srcIdxUV0 = y*wh;
     const int srcIdxUV1 = (y+1)*wh;
-    int curU    = getValueFromSource(srcU, srcIdxUV0*inValSkip, bps, bigEndian);
-    int curV    = getValueFromSource(srcV, srcIdxUV0*inValSkip, bps, bigEndian);
-    int curU_NL = getValueFromSource(srcU, srcIdxUV1*inValSkip, bps, bigEndian);
-    int curV_NL = getValueFromSource(srcV, srcIdxUV1*inValSkip, bps, bigEndian);
+    int curU    = getValueFromSource<twoBytes, bigEndian>(srcU, srcIdxUV0*inValSkip);
+    int curV    = getValueFromSource<twoBytes, bigEndian>(srcV, srcIdxUV0*inValSkip);
+    int curU_NL = getValueFromSource<twoBytes, bigEndian>(srcU, srcIdxUV1*inValSkip);
+    int curV_NL = getValueFromSource<twoBytes, bigEndian>(srcV, srcIdxUV1*inValSkip);
     if (applyMathChroma)
     {
       curU    = transformYUV(mathC.invert, mathC.scale, mathC.offset, curU, inMax);
@@ -2415,10 +2688,10 @@ inline void YUVPlaneToRGB_420(const int w, const int h, const yuvMathParameters
       // Get the next U/V sample for this line and the next one
       const int srcIdxUVLine0 = srcIdxUV0 + x + 1;
       const int srcIdxUVLine1 = srcIdxUV1 + x + 1;
-      int nextU    = getValueFromSource(srcU, srcIdxUVLine0*inValSkip, bps, bigEndian);
-      int nextV    = getValueFromSource(srcV, srcIdxUVLine0*inValSkip, bps, bigEndian);
-      int nextU_NL = getValueFromSource(srcU, srcIdxUVLine1*inValSkip, bps, bigEndian);
-      int nextV_NL = getValueFromSource(srcV, srcIdxUVLine1*inValSkip, bps, bigEndian);
+      int nextU    = getValueFromSource<twoBytes, bigEndian>(srcU, srcIdxUVLine0*inValSkip);
+      int nextV    = getValueFromSource<twoBytes, bigEndian>(srcV, srcIdxUVLine0*inValSkip);
+      int nextU_NL = getValueFromSource<twoBytes, bigEndian>(srcU, srcIdxUVLine1*inValSkip);
+      int nextV_NL = getValueFromSource<twoBytes, bigEndian>(srcV, srcIdxUVLine1*inValSkip);
       if (applyMathChroma)
       {
         nextU    = transformYUV(mathC.invert, mathC.scale, mathC.offset, nextU, inMax);
@@ -2436,10 +2709,10 @@ inline void YUVPlaneToRGB_420(const int w, const int h, const yuvMathParameters
       int interpolatedV_Bi  = interpolateUVSample2D(interpolation, curV, nextV, curV_NL, nextV_NL);   // 2D interpolation
 
       // Get the 4 Y samples
-      int valY1 = getValueFromSource(srcY, (y*w+x)*2,   bps, bigEndian);
-      int valY2 = getValueFromSource(srcY, (y*w+x)*2+1, bps, bigEndian);
-      int valY3 = getValueFromSource(srcY, (y*2+1)*w+x*2,   bps, bigEndian);
-      int valY4 = getValueFromSource(srcY, (y*2+1)*w+x*2+1, bps, bigEndian);
+      int valY1 = getValueFromSource<twoBytes, bigEndian>(srcY, (y*w+x)*2);
+      int valY2 = getValueFromSource<twoBytes, bigEndian>(srcY, (y*w+x)*2+1);
+      int valY3 = getValueFromSource<twoBytes, bigEndian>(srcY, (y*2+1)*w+x*2);
+      int valY4 = getValueFromSource<twoBytes, bigEndian>(srcY, (y*2+1)*w+x*2+1);
       if (applyMathLuma)
       {
         valY1 = transformYUV(mathY.invert, mathY.scale, mathY.offset, valY1, inMax);
@@ -2485,10 +2758,10 @@ inline void YUVPlaneToRGB_420(const int w, const int h, const yuvMathParameters
     int interpolatedV_Ver = interpolateUVSample(interpolation, curV, curV_NL);
 
     // Get the 4 Y samples
-    int valY1 = getValueFromSource(srcY, (y*2+1)*w-2, bps, bigEndian);
-    int valY2 = getValueFromSource(srcY, (y*2+1)*w-1, bps, bigEndian);
-    int valY3 = getValueFromSource(srcY, (y*2+2)*w-2, bps, bigEndian);
-    int valY4 = getValueFromSource(srcY, (y*2+2)*w-1, bps, bigEndian);
+    int valY1 = getValueFromSource<twoBytes, bigEndian>(srcY, (y*2+1)*w-2);
+    int valY2 = getValueFromSource<twoBytes, bigEndian>(srcY, (y*2+1)*w-1);
+    int valY3 = getValueFromSource<twoBytes, bigEndian>(srcY, (y*2+2)*w-2);
+    int valY4 = getValueFromSource<twoBytes, bigEndian>(srcY, (y*2+2)*w-1);
     if (applyMathLuma)
     {
       valY1 = transformYUV(mathY.invert, mathY.scale, mathY.offset, valY1, inMax);
@@ -2531,8 +2804,8 @@ inline void YUVPlaneToRGB_420(const int w, const int h, const yuvMathParameters
 
   // Get 2 chroma samples from this line
   const int srcIdxUV = y*wh;
-  int curU = getValueFromSource(srcU, srcIdxUV*inValSkip, bps, bigEndian);
-  int curV = getValueFromSource(srcV, srcIdxUV*inValSkip, bps, bigEndian);
+  int curU = getValueFromSource<twoBytes, bigEndian>(srcU, srcIdxUV*inValSkip);
+  int curV = getValueFromSource<twoBytes, bigEndian>(srcV, srcIdxUV*inValSkip);
   if (applyMathChroma)
   {
     curU = transformYUV(mathC.invert, mathC.scale, mathC.offset, curU, inMax);
@@ -2543,8 +2816,8 @@ inline void YUVPlaneToRGB_420(const int w, const int h, const yuvMathParameters
   {
     // Get the next U/V sample for this line and the next one
     const int srcIdxLineUV = srcIdxUV + x + 1;
-    int nextU = getValueFromSource(srcU, srcIdxLineUV*inValSkip, bps, bigEndian);
-    int nextV = getValueFromSource(srcV, srcIdxLineUV*inValSkip, bps, bigEndian);
+    int nextU = getValueFromSource<twoBytes, bigEndian>(srcU, srcIdxLineUV*inValSkip);
+    int nextV = getValueFromSource<twoBytes, bigEndian>(srcV, srcIdxLineUV*inValSkip);
     if (applyMathChroma)
     {
       nextU = transformYUV(mathC.invert, mathC.scale, mathC.offset, nextU, inMax);
@@ -2556,10 +2829,10 @@ inline void YUVPlaneToRGB_420(const int w, const int h, const yuvMathParameters
     int interpolatedV_Hor = interpolateUVSample(interpolation, curV, nextV);
 
     // Get the 4 Y samples
-    int valY1 = getValueFromSource(srcY, (y*w+x)*2,      bps, bigEndian);
-    int valY2 = getValueFromSource(srcY, (y*w+x)*2+1,    bps, bigEndian);
-    int valY3 = getValueFromSource(srcY, (y2+1)*w+x*2,   bps, bigEndian);
-    int valY4 = getValueFromSource(srcY, (y2+1)*w+x*2+1, bps, bigEndian);
+    int valY1 = getValueFromSource<twoBytes, bigEndian>(srcY, (y*w+x)*2);
+    int valY2 = getValueFromSource<twoBytes, bigEndian>(srcY, (y*w+x)*2+1);
+    int valY3 = getValueFromSource<twoBytes, bigEndian>(srcY, (y2+1)*w+x*2);
+    int valY4 = getValueFromSource<twoBytes, bigEndian>(srcY, (y2+1)*w+x*2+1);
     if (applyMathLuma)
     {
       valY1 = transformYUV(mathY.invert, mathY.scale, mathY.offset, valY1, inMax);
@@ -2602,10 +2875,10 @@ inline void YUVPlaneToRGB_420(const int w, const int h, const yuvMathParameters
   // Just sample and hold. No interpolation is required.
 
   // Get the 4 Y samples
-  int valY1 = getValueFromSource(srcY, (y2+1)*w-2, bps, bigEndian);
-  int valY2 = getValueFromSource(srcY, (y2+1)*w-1, bps, bigEndian);
-  int valY3 = getValueFromSource(srcY, (y2+2)*w-2, bps, bigEndian);
-  int valY4 = getValueFromSource(srcY, (y2+2)*w-1, bps, bigEndian);
+  int valY1 = getValueFromSource<twoBytes, bigEndian>(srcY, (y2+1)*w-2);
+  int valY2 = getValueFromSource<twoBytes, bigEndian>(srcY, (y2+1)*w-1);
+  int valY3 = getValueFromSource<twoBytes, bigEndian>(srcY, (y2+2)*w-2);
+  int valY4 = getValueFromSource<twoBytes, bigEndian>(srcY, (y2+2)*w-1);
   if (applyMathLuma)
   {
     valY1 = transformYUV(mathY.invert, mathY.scale, mathY.offset, valY1, inMax);
@@ -2640,9 +2913,10 @@ inline void YUVPlaneToRGB_420(const int w, const int h, const yuvMathParameters
   dst[pos2-1] = 255;
 }
 
+template<bool twoBytes, bool bigEndian, bool fullRange, InterpolationMode interpolation>
 inline void YUVPlaneToRGB_410(const int w, const int h, const yuvMathParameters mathY, const yuvMathParameters mathC,
                               const unsigned char * restrict srcY, const unsigned char * restrict srcU, const unsigned char * restrict srcV,
-                              unsigned char * restrict dst, const int RGBConv[5], const bool fullRange,const int inMax, const InterpolationMode interpolation, const int bps, const bool bigEndian, const int inValSkip)
+                              unsigned char * restrict dst, const int RGBConv[5], const int inMax, const int bps, const int inValSkip)
 {
   const bool applyMathLuma = mathY.yuvMathRequired();
   const bool applyMathChroma = mathC.yuvMathRequired();
@@ -2656,10 +2930,10 @@ inline void YUVPlaneToRGB_410(const int w, const int h, const yuvMathParameters
     // Get the current U/V samples for this y line and the next one (_NL)
     const int srcIdxUV0 = y*wq;
     const int srcIdxUV1 = (y+1)*wq;
-    int curU    = getValueFromSource(srcU, srcIdxUV0*inValSkip, bps, bigEndian);
-    int curV    = getValueFromSource(srcV, srcIdxUV0*inValSkip, bps, bigEndian);
-    int curU_NL = (y < hq-1) ? getValueFromSource(srcU, srcIdxUV1*inValSkip, bps, bigEndian) : curU;
-    int curV_NL = (y < hq-1) ? getValueFromSource(srcV, srcIdxUV1*inValSkip, bps, bigEndian) : curV;
+    int curU    = getValueFromSource<twoBytes, bigEndian>(srcU, srcIdxUV0*inValSkip);
+    int curV    = getValueFromSource<twoBytes, bigEndian>(srcV, srcIdxUV0*inValSkip);
+    int curU_NL = (y < hq-1) ? getValueFromSource<twoBytes, bigEndian>(srcU, srcIdxUV1*inValSkip) : curU;
+    int curV_NL = (y < hq-1) ? getValueFromSource<twoBytes, bigEndian>(srcV, srcIdxUV1*inValSkip) : curV;
     if (applyMathChroma)
     {
       curU    = transformYUV(mathC.invert, mathC.scale, mathC.offset, curU, inMax);
@@ -2675,10 +2949,10 @@ inline void YUVPlaneToRGB_410(const int w, const int h, const yuvMathParameters
       // Get the next U/V sample for this line and the next one
       const int srcIdxUVLine0 = srcIdxUV0 + x + 1;
       const int srcIdxUVLine1 = srcIdxUV1 + x + 1;
-      int nextU    = (x < wq-1) ? getValueFromSource(srcU, srcIdxUVLine0*inValSkip, bps, bigEndian) : curU;
-      int nextV    = (x < wq-1) ? getValueFromSource(srcV, srcIdxUVLine0*inValSkip, bps, bigEndian) : curV;
-      int nextU_NL = (x < wq-1) ? getValueFromSource(srcU, srcIdxUVLine1*inValSkip, bps, bigEndian) : curU_NL;
-      int nextV_NL = (x < wq-1) ? getValueFromSource(srcV, srcIdxUVLine1*inValSkip, bps, bigEndian) : curV_NL;
+      int nextU    = (x < wq-1) ? getValueFromSource<twoBytes, bigEndian>(srcU, srcIdxUVLine0*inValSkip) : curU;
+      int nextV    = (x < wq-1) ? getValueFromSource<twoBytes, bigEndian>(srcV, srcIdxUVLine0*inValSkip) : curV;
+      int nextU_NL = (x < wq-1) ? getValueFromSource<twoBytes, bigEndian>(srcU, srcIdxUVLine1*inValSkip) : curU_NL;
+      int nextV_NL = (x < wq-1) ? getValueFromSource<twoBytes, bigEndian>(srcV, srcIdxUVLine1*inValSkip) : curV_NL;
       if (applyMathChroma)
       {
         nextU    = transformYUV(mathC.invert, mathC.scale, mathC.offset, nextU, inMax);
@@ -2702,7 +2976,7 @@ inline void YUVPlaneToRGB_410(const int w, const int h, const yuvMathParameters
           int U = interpolateUVSampleQ(interpolation, curU_INT, nextU_INT, xo);
           int V = interpolateUVSampleQ(interpolation, curV_INT, nextV_INT, xo);
           // Get the Y sample
-          int Y = getValueFromSource(srcY, (y*4+yo)*w+x*4+xo, bps, bigEndian);
+          int Y = getValueFromSource<twoBytes, bigEndian>(srcY, (y*4+yo)*w+x*4+xo);
           if (applyMathLuma)
             Y = transformYUV(mathY.invert, mathY.scale, mathY.offset, Y, inMax);
 
@@ -2725,9 +2999,10 @@ inline void YUVPlaneToRGB_410(const int w, const int h, const yuvMathParameters
   }
 }
 
+template<bool twoBytes, bool bigEndian, bool fullRange, InterpolationMode interpolation>
 inline void YUVPlaneToRGB_411(const int w, const int h, const yuvMathParameters mathY, const yuvMathParameters mathC,
   const unsigned char * restrict srcY, const unsigned char * restrict srcU, const unsigned char * restrict srcV,
-  unsigned char * restrict dst, const int RGBConv[5], const bool fullRange,const int inMax, const InterpolationMode interpolation, const int bps, const bool bigEndian, const int inValSkip)
+  unsigned char * restrict dst, const int RGBConv[5], const int inMax, const int bps, const int inValSkip)
 {
   // Chroma: quarter horizontal resolution
   const bool applyMathLuma = mathY.yuvMathRequired();
@@ -2737,8 +3012,8 @@ inline void YUVPlaneToRGB_411(const int w, const int h, const yuvMathParameters
   for (int y = 0; y < h; y++)
   {
     const int srcIdxUV = y*w/4;
-    int curUSample = getValueFromSource(srcU, srcIdxUV*inValSkip, bps, bigEndian);
-    int curVSample = getValueFromSource(srcV, srcIdxUV*inValSkip, bps, bigEndian);
+    int curUSample = getValueFromSource<twoBytes, bigEndian>(srcU, srcIdxUV*inValSkip);
+    int curVSample = getValueFromSource<twoBytes, bigEndian>(srcV, srcIdxUV*inValSkip);
     if (applyMathChroma)
     {
       curUSample = transformYUV(mathC.invert, mathC.scale, mathC.offset, curUSample, inMax);
@@ -2749,8 +3024,8 @@ inline void YUVPlaneToRGB_411(const int w, const int h, const yuvMathParameters
     {
       // Get the next U/V sample
       const int srcIdxUVLine = srcIdxUV + x + 1;
-      int nextUSample = getValueFromSource(srcU, srcIdxUVLine*inValSkip, bps, bigEndian);
-      int nextVSample = getValueFromSource(srcV, srcIdxUVLine*inValSkip, bps, bigEndian);
+      int nextUSample = getValueFromSource<twoBytes, bigEndian>(srcU, srcIdxUVLine*inValSkip);
+      int nextVSample = getValueFromSource<twoBytes, bigEndian>(srcV, srcIdxUVLine*inValSkip);
       if (applyMathChroma)
       {
         nextUSample = transformYUV(mathC.invert, mathC.scale, mathC.offset, nextUSample, inMax);
@@ -2766,10 +3041,10 @@ inline void YUVPlaneToRGB_411(const int w, const int h, const yuvMathParameters
       int interpolatedV3 = interpolateUVSampleQ(interpolation, curVSample, nextVSample, 3);
 
       // Get the 4 Y samples
-      int valY1 = getValueFromSource(srcY, y*w+x*4,   bps, bigEndian);
-      int valY2 = getValueFromSource(srcY, y*w+x*4+1, bps, bigEndian);
-      int valY3 = getValueFromSource(srcY, y*w+x*4+2, bps, bigEndian);
-      int valY4 = getValueFromSource(srcY, y*w+x*4+3, bps, bigEndian);
+      int valY1 = getValueFromSource<twoBytes, bigEndian>(srcY, y*w+x*4);
+      int valY2 = getValueFromSource<twoBytes, bigEndian>(srcY, y*w+x*4+1);
+      int valY3 = getValueFromSource<twoBytes, bigEndian>(srcY, y*w+x*4+2);
+      int valY4 = getValueFromSource<twoBytes, bigEndian>(srcY, y*w+x*4+3);
       if (applyMathLuma)
       {
         valY1 = transformYUV(mathY.invert, mathY.scale, mathY.offset, valY1, inMax);
@@ -2810,10 +3085,10 @@ inline void YUVPlaneToRGB_411(const int w, const int h, const yuvMathParameters
     // For the last row, there is no next sample. Just reuse the current one again. No interpolation required either.
 
     // Get the 2 Y samples
-    int valY1 = getValueFromSource(srcY, (y+1)*w-4, bps, bigEndian);
-    int valY2 = getValueFromSource(srcY, (y+1)*w-3, bps, bigEndian);
-    int valY3 = getValueFromSource(srcY, (y+1)*w-2, bps, bigEndian);
-    int valY4 = getValueFromSource(srcY, (y+1)*w-1, bps, bigEndian);
+    int valY1 = getValueFromSource<twoBytes, bigEndian>(srcY, (y+1)*w-4);
+    int valY2 = getValueFromSource<twoBytes, bigEndian>(srcY, (y+1)*w-3);
+    int valY3 = getValueFromSource<twoBytes, bigEndian>(srcY, (y+1)*w-2);
+    int valY4 = getValueFromSource<twoBytes, bigEndian>(srcY, (y+1)*w-1);
     if (applyMathLuma)
     {
       valY1 = transformYUV(mathY.invert, mathY.scale, mathY.offset, valY1, inMax);
@@ -2848,6 +3123,227 @@ inline void YUVPlaneToRGB_411(const int w, const int h, const yuvMathParameters
   }
 }
 
+// All conversion functions are instantiated for every combination of the sample size (one or two bytes),
+// endianness, value range and chroma interpolation. The matching instance is selected only once per frame
+// from these tables so that the inner loops do not have to branch on these values for every sample.
+typedef void (*YUVPlaneToRGBFunction)(const int w, const int h, const yuvMathParameters mathY, const yuvMathParameters mathC,
+                                      const unsigned char * restrict srcY, const unsigned char * restrict srcU, const unsigned char * restrict srcV,
+                                      unsigned char * restrict dst, const int RGBConv[5], const int inMax, const int bps, const int inValSkip);
+typedef void (*YUVPlaneToRGBMonochromeFunction)(const int w, const int h, const yuvMathParameters math, const unsigned char * restrict src, unsigned char * restrict dst,
+                                                const int inMax, const int bps, const int inValSkip);
+typedef void (*UVPlaneResamplingFunction)(const yuvPixelFormat format, const int w, const int h,
+                                          const unsigned char * restrict srcU, const unsigned char * restrict srcV, const int inValSkip,
+                                          unsigned char * restrict dstU, unsigned char * restrict dstV);
+
+// The functions for one combination in the order of YUVSubsamplingType. 4:0:0 is handled by the monochrome functions.
+#define YUV_PLANE_TO_RGB_FUNCTIONS(twoBytes, bigEndian, fullRange, interpolation) \
+  { &YUVPlaneToRGB_444<twoBytes, bigEndian, fullRange, interpolation>, \
+    &YUVPlaneToRGB_422<twoBytes, bigEndian, fullRange, interpolation>, \
+    &YUVPlaneToRGB_420<twoBytes, bigEndian, fullRange, interpolation>, \
+    &YUVPlaneToRGB_440<twoBytes, bigEndian, fullRange, interpolation>, \
+    &YUVPlaneToRGB_410<twoBytes, bigEndian, fullRange, interpolation>, \
+    &YUVPlaneToRGB_411<twoBytes, bigEndian, fullRange, interpolation>, \
+    nullptr }
+
+// For 4:0:0, only the luma plane is converted which has the full resolution.
+#define YUV_PLANE_TO_RGB_MONOCHROME_FUNCTIONS(twoBytes, bigEndian, fullRange) \
+  { &YUVPlaneToRGBMonochrome_444<twoBytes, bigEndian, fullRange>, \
+    &YUVPlaneToRGBMonochrome_422<twoBytes, bigEndian, fullRange>, \
+    &YUVPlaneToRGBMonochrome_420<twoBytes, bigEndian, fullRange>, \
+    &YUVPlaneToRGBMonochrome_440<twoBytes, bigEndian, fullRange>, \
+    &YUVPlaneToRGBMonochrome_410<twoBytes, bigEndian, fullRange>, \
+    &YUVPlaneToRGBMonochrome_411<twoBytes, bigEndian, fullRange>, \
+    &YUVPlaneToRGBMonochrome_444<twoBytes, bigEndian, fullRange> }
+
+// Indexed by [twoBytes][bigEndian][fullRange][biLinearInterpolation][subsampling]. The interstitial interpolation
+// is not implemented yet and is handled like nearest neighbor interpolation.
+static const YUVPlaneToRGBFunction YUVPlaneToRGBFunctionTable[2][2][2][2][YUV_NUM_SUBSAMPLINGS] =
+{
+  {
+    {
+      { YUV_PLANE_TO_RGB_FUNCTIONS(false, false, false, NearestNeighborInterpolation), YUV_PLANE_TO_RGB_FUNCTIONS(false, false, false, BiLinearInterpolation) },
+      { YUV_PLANE_TO_RGB_FUNCTIONS(false, false, true,  NearestNeighborInterpolation), YUV_PLANE_TO_RGB_FUNCTIONS(false, false, true,  BiLinearInterpolation) }
+    },
+    {
+      { YUV_PLANE_TO_RGB_FUNCTIONS(false, true,  false, NearestNeighborInterpolation), YUV_PLANE_TO_RGB_FUNCTIONS(false, true,  false, BiLinearInterpolation) },
+      { YUV_PLANE_TO_RGB_FUNCTIONS(false, true,  true,  NearestNeighborInterpolation), YUV_PLANE_TO_RGB_FUNCTIONS(false, true,  true,  BiLinearInterpolation) }
+    }
+  },
+  {
+    {
+      { YUV_PLANE_TO_RGB_FUNCTIONS(true,  false, false, NearestNeighborInterpolation), YUV_PLANE_TO_RGB_FUNCTIONS(true,  false, false, BiLinearInterpolation) },
+      { YUV_PLANE_TO_RGB_FUNCTIONS(true,  false, true,  NearestNeighborInterpolation), YUV_PLANE_TO_RGB_FUNCTIONS(true,  false, true,  BiLinearInterpolation) }
+    },
+    {
+      { YUV_PLANE_TO_RGB_FUNCTIONS(true,  true,  false, NearestNeighborInterpolation), YUV_PLANE_TO_RGB_FUNCTIONS(true,  true,  false, BiLinearInterpolation) },
+      { YUV_PLANE_TO_RGB_FUNCTIONS(true,  true,  true,  NearestNeighborInterpolation), YUV_PLANE_TO_RGB_FUNCTIONS(true,  true,  true,  BiLinearInterpolation) }
+    }
+  }
+};
+
+// Indexed by [twoBytes][bigEndian][fullRange][subsampling]
+static const YUVPlaneToRGBMonochromeFunction YUVPlaneToRGBMonochromeFunctionTable[2][2][2][YUV_NUM_SUBSAMPLINGS] =
+{
+  {
+    { YUV_PLANE_TO_RGB_MONOCHROME_FUNCTIONS(false, false, false), YUV_PLANE_TO_RGB_MONOCHROME_FUNCTIONS(false, false, true) },
+    { YUV_PLANE_TO_RGB_MONOCHROME_FUNCTIONS(false, true,  false), YUV_PLANE_TO_RGB_MONOCHROME_FUNCTIONS(false, true,  true) }
+  },
+  {
+    { YUV_PLANE_TO_RGB_MONOCHROME_FUNCTIONS(true,  false, false), YUV_PLANE_TO_RGB_MONOCHROME_FUNCTIONS(true,  false, true) },
+    { YUV_PLANE_TO_RGB_MONOCHROME_FUNCTIONS(true,  true,  false), YUV_PLANE_TO_RGB_MONOCHROME_FUNCTIONS(true,  true,  true) }
+  }
+};
+
+// Indexed by [twoBytes][bigEndian]
+static const UVPlaneResamplingFunction UVPlaneResamplingFunctionTable[2][2] =
+{
+  { &UVPlaneResamplingChromaOffset<false, false>, &UVPlaneResamplingChromaOffset<false, true> },
+  { &UVPlaneResamplingChromaOffset<true,  false>, &UVPlaneResamplingChromaOffset<true,  true> }
+};
+
+// Convert packed 4:2:2 data directly to RGB without creating planar Y, U and V planes first. Each block of 4 values
+// contains two luma samples and one U and V sample. The positions of the components in a block are given in
+// offsets (Y, U, V). The chroma sample for the second luma value of a block is interpolated like in YUVPlaneToRGB_422.
+template<bool twoBytes, bool bigEndian, bool fullRange, InterpolationMode interpolation>
+inline void YUVPackedToRGB_422(const int w, const int h, const yuvMathParameters mathY, const yuvMathParameters mathC,
+                               const unsigned char * restrict src, unsigned char * restrict dst, const int RGBConv[5], const int inMax, const int bps,
+                               const int offsets[4])
+{
+  const bool applyMathLuma = mathY.yuvMathRequired();
+  const bool applyMathChroma = mathC.yuvMathRequired();
+  const int oY = offsets[0];
+  const int oU = offsets[1];
+  const int oV = offsets[2];
+  const int nrBlocks = w / 2;
+
+  for (int y = 0; y < h; y++)
+  {
+    // The index of the first value of the line in src (in samples)
+    const int srcLine = y * nrBlocks * 4;
+    int curUSample = getValueFromSource<twoBytes, bigEndian>(src, srcLine + oU);
+    int curVSample = getValueFromSource<twoBytes, bigEndian>(src, srcLine + oV);
+    if (applyMathChroma)
+    {
+      curUSample = transformYUV(mathC.invert, mathC.scale, mathC.offset, curUSample, inMax);
+      curVSample = transformYUV(mathC.invert, mathC.scale, mathC.offset, curVSample, inMax);
+    }
+
+    for (int x = 0; x < nrBlocks; x++)
+    {
+      const int srcBlock = srcLine + x * 4;
+
+      // Get the U/V sample of the next block. For the last block in the line there is no next one. Just reuse the current one.
+      int nextUSample = curUSample;
+      int nextVSample = curVSample;
+      if (x < nrBlocks - 1)
+      {
+        nextUSample = getValueFromSource<twoBytes, bigEndian>(src, srcBlock + 4 + oU);
+        nextVSample = getValueFromSource<twoBytes, bigEndian>(src, srcBlock + 4 + oV);
+        if (applyMathChroma)
+        {
+          nextUSample = transformYUV(mathC.invert, mathC.scale, mathC.offset, nextUSample, inMax);
+          nextVSample = transformYUV(mathC.invert, mathC.scale, mathC.offset, nextVSample, inMax);
+        }
+      }
+
+      // From the current and the next U/V sample, interpolate the UV sample in between
+      const int interpolatedU = interpolateUVSample(interpolation, curUSample, nextUSample);
+      const int interpolatedV = interpolateUVSample(interpolation, curVSample, nextVSample);
+
+      // Get the 2 Y samples
+      int valY1 = getValueFromSource<twoBytes, bigEndian>(src, srcBlock + oY);
+      int valY2 = getValueFromSource<twoBytes, bigEndian>(src, srcBlock + oY + 2);
+      if (applyMathLuma)
+      {
+        valY1 = transformYUV(mathY.invert, mathY.scale, mathY.offset, valY1, inMax);
+        valY2 = transformYUV(mathY.invert, mathY.scale, mathY.offset, valY2, inMax);
+      }
+
+      // Convert to 2 RGB values and save them (BGRA)
+      int valR1, valR2, valG1, valG2, valB1, valB2;
+      convertYUVToRGB8Bit(valY1, curUSample   , curVSample   , valR1, valG1, valB1, RGBConv, fullRange, bps);
+      convertYUVToRGB8Bit(valY2, interpolatedU, interpolatedV, valR2, valG2, valB2, RGBConv, fullRange, bps);
+      const int pos = (y*w+x*2)*4;
+      dst[pos  ] = valB1;
+      dst[pos+1] = valG1;
+      dst[pos+2] = valR1;
+      dst[pos+3] = 255;
+      dst[pos+4] = valB2;
+      dst[pos+5] = valG2;
+      dst[pos+6] = valR2;
+      dst[pos+7] = 255;
+
+      // The next one is now the current one
+      curUSample = nextUSample;
+      curVSample = nextVSample;
+    }
+  }
+}
+
+// Convert packed 4:4:4 data directly to RGB. Every pixel consists of offsets[3] values (3 or 4 if there is an alpha
+// value which is ignored). The positions of the components within a pixel are given in offsets (Y, U, V).
+template<bool twoBytes, bool bigEndian, bool fullRange, InterpolationMode interpolation>
+inline void YUVPackedToRGB_444(const int w, const int h, const yuvMathParameters mathY, const yuvMathParameters mathC,
+                               const unsigned char * restrict src, unsigned char * restrict dst, const int RGBConv[5], const int inMax, const int bps,
+                               const int offsets[4])
+{
+  // No interpolation is required for 4:4:4.
+  const bool applyMathLuma = mathY.yuvMathRequired();
+  const bool applyMathChroma = mathC.yuvMathRequired();
+  const int oY = offsets[0];
+  const int oU = offsets[1];
+  const int oV = offsets[2];
+  const int offsetNext = offsets[3];
+  const int componentSize = w * h;
+
+  for (int i = 0; i < componentSize; ++i)
+  {
+    const int srcIdx = i * offsetNext;
+    unsigned int valY = getValueFromSource<twoBytes, bigEndian>(src, srcIdx + oY);
+    unsigned int valU = getValueFromSource<twoBytes, bigEndian>(src, srcIdx + oU);
+    unsigned int valV = getValueFromSource<twoBytes, bigEndian>(src, srcIdx + oV);
+
+    if (applyMathLuma)
+      valY = transformYUV(mathY.invert, mathY.scale, mathY.offset, valY, inMax);
+    if (applyMathChroma)
+    {
+      valU = transformYUV(mathC.invert, mathC.scale, mathC.offset, valU, inMax);
+      valV = transformYUV(mathC.invert, mathC.scale, mathC.offset, valV, inMax);
+    }
+
+    // Get the RGB values for this sample
+    int valR, valG, valB;
+    convertYUVToRGB8Bit(valY, valU, valV, valR, valG, valB, RGBConv, fullRange, bps);
+
+    // Save the RGB values
+    dst[i*4  ] = valB;
+    dst[i*4+1] = valG;
+    dst[i*4+2] = valR;
+    dst[i*4+3] = 255;
+  }
+}
+
+typedef void (*YUVPackedToRGBFunction)(const int w, const int h, const yuvMathParameters mathY, const yuvMathParameters mathC,
+                                       const unsigned char * restrict src, unsigned char * restrict dst, const int RGBConv[5], const int inMax, const int bps,
+                                       const int offsets[4]);
+
+#define YUV_PACKED_TO_RGB_FUNCTIONS(twoBytes, bigEndian, fullRange) \
+  { { &YUVPackedToRGB_444<twoBytes, bigEndian, fullRange, NearestNeighborInterpolation>, &YUVPackedToRGB_422<twoBytes, bigEndian, fullRange, NearestNeighborInterpolation> }, \
+    { &YUVPackedToRGB_444<twoBytes, bigEndian, fullRange, BiLinearInterpolation>,        &YUVPackedToRGB_422<twoBytes, bigEndian, fullRange, BiLinearInterpolation> } }
+
+// Indexed by [twoBytes][bigEndian][fullRange][biLinearInterpolation][is422]
+static const YUVPackedToRGBFunction YUVPackedToRGBFunctionTable[2][2][2][2][2] =
+{
+  {
+    { YUV_PACKED_TO_RGB_FUNCTIONS(false, false, false), YUV_PACKED_TO_RGB_FUNCTIONS(false, false, true) },
+    { YUV_PACKED_TO_RGB_FUNCTIONS(false, true,  false), YUV_PACKED_TO_RGB_FUNCTIONS(false, true,  true) }
+  },
+  {
+    { YUV_PACKED_TO_RGB_FUNCTIONS(true,  false, false), YUV_PACKED_TO_RGB_FUNCTIONS(true,  false, true) },
+    { YUV_PACKED_TO_RGB_FUNCTIONS(true,  true,  false), YUV_PACKED_TO_RGB_FUNCTIONS(true,  true,  true) }
+  }
+};
+
 bool videoHandlerYUV::convertYUVPackedToPlanar(const QByteArray &sourceBuffer, QByteArray &targetBuffer, const QSize &curFrameSize, yuvPixelFormat &sourceBufferFormat)
 {
   const yuvPixelFormat format = sourceBufferFormat;
@@ -2961,6 +3457,60 @@ bool videoHandlerYUV::convertYUVPackedToPlanar(const QByteArray &sourceBuffer, Q
   return true;
 }
 
+bool videoHandlerYUV::convertYUVPackedToRGB(const QByteArray &sourceBuffer, unsigned char *targetBuffer, const QSize &curFrameSize, const yuvPixelFormat &sourceBufferFormat) const
+{
+  const yuvPixelFormat format = sourceBufferFormat;
+  const YUVPackingOrder packing = format.packingOrder;
+  const int w = curFrameSize.width();
+  const int h = curFrameSize.height();
+  const int bps = format.bitsPerSample;
+  const int inputMax = (1<<bps)-1;
+
+  // Only the display of all components without a chroma offset is supported. All other cases must go through the planar conversion.
+  if (format.planar || format.bytePacking || componentDisplayMode != DisplayAll || format.chromaOffset[0] != 0 || format.chromaOffset[1] != 0)
+    return false;
+
+  // What are the offsets of the components within a packed block and how many values are in a block?
+  int offsets[4];
+  if (format.subsampling == YUV_422)
+  {
+    offsets[0] = (packing == Packing_YUYV || packing == Packing_YVYU) ? 0 : 1;
+    offsets[1] = (packing == Packing_UYVY) ? 0 : (packing == Packing_YUYV) ? 1 : (packing == Packing_VYUY) ? 2 : 3;
+    offsets[2] = (packing == Packing_VYUY) ? 0 : (packing == Packing_YVYU) ? 1 : (packing == Packing_UYVY) ? 2 : 3;
+    offsets[3] = 4;
+  }
+  else if (format.subsampling == YUV_444)
+  {
+    offsets[0] = (packing == Packing_AYUV) ? 1 : 0;
+    offsets[1] = (packing == Packing_YUV || packing == Packing_YUVA) ? 1 : 2;
+    offsets[2] = (packing == Packing_YVU) ? 1 : (packing == Packing_AYUV) ? 3 : 2;
+    offsets[3] = (packing == Packing_YUV || packing == Packing_YVU) ? 3 : 4;
+  }
+  else
+    return false;
+
+  // Get/set the parameters used for YUV -> RGB conversion
+  const ColorConversion conversion = yuvColorConversionType;
+  const bool fullRange = (conversion == BT709_FullRange || conversion == BT601_FullRange || conversion == BT2020_FullRange);
+  const int RGBConv[5] = { 
+    yuvRgbConvCoeffs[conversion][0],
+    yuvRgbConvCoeffs[conversion][1],
+    yuvRgbConvCoeffs[conversion][2],
+    yuvRgbConvCoeffs[conversion][3],
+    yuvRgbConvCoeffs[conversion][4]
+  };
+
+  const bool twoBytes = (bps > 8);
+  const bool biLinear = (interpolationMode == BiLinearInterpolation);
+  const bool is422 = (format.subsampling == YUV_422);
+  const YUVPackedToRGBFunction convertYUV = YUVPackedToRGBFunctionTable[twoBytes][format.bigEndian][fullRange][biLinear][is422];
+
+  const unsigned char * restrict src = (unsigned char*)sourceBuffer.data();
+  convertYUV(w, h, mathParameters[Luma], mathParameters[Chroma], src, targetBuffer, RGBConv, inputMax, bps, offsets);
+
+  return true;
+}
+
 bool videoHandlerYUV::convertYUVPlanarToRGB(const QByteArray &sourceBuffer, uchar *targetBuffer, const QSize &curFrameSize, const yuvPixelFormat &sourceBufferFormat) const
 {
   // These are constant for the runtime of this function. This way, the compiler can optimize the
@@ -3002,6 +3552,16 @@ bool videoHandlerYUV::convertYUVPlanarToRGB(const QByteArray &sourceBuffer, ucha
   // A pointer to the output
   unsigned char * restrict dst = targetBuffer;
 
+  // Select the conversion functions for this format once. See the function tables above.
+  const bool twoBytes = (bps > 8);
+  const bool bigEndian = format.bigEndian;
+  const bool biLinear = (interpolation == BiLinearInterpolation);
+  if (format.subsampling >= YUV_NUM_SUBSAMPLINGS)
+    return false;
+  const YUVPlaneToRGBMonochromeFunction convertLuma = YUVPlaneToRGBMonochromeFunctionTable[twoBytes][bigEndian][fullRange][YUV_444];
+  const YUVPlaneToRGBMonochromeFunction convertChroma = YUVPlaneToRGBMonochromeFunctionTable[twoBytes][bigEndian][fullRange][format.subsampling];
+  const YUVPlaneToRGBFunction convertYUV = YUVPlaneToRGBFunctionTable[twoBytes][bigEndian][fullRange][biLinear][format.subsampling];
+
   if (component != DisplayAll || format.subsampling == YUV_400)
   {
     // We only display (or there is only) one of the color components (possibly with YUV math)
@@ -3009,7 +3569,7 @@ bool videoHandlerYUV::convertYUVPlanarToRGB(const QByteArray &sourceBuffer, ucha
     {
       // Luma only. The chroma subsampling does not matter.
       const unsigned char * restrict srcY = (unsigned char*)sourceBuffer.data();
-      YUVPlaneToRGBMonochrome_444(componentSizeLuma, mathY, srcY, dst, inputMax, bps, format.bigEndian, 1, fullRange);
+      convertLuma(w, h, mathY, srcY, dst, inputMax, bps, 1);
     }
     else
     {
@@ -3027,20 +3587,8 @@ bool videoHandlerYUV::convertYUVPlanarToRGB(const QByteArray &sourceBuffer, ucha
       }
 
       const unsigned char * restrict srcC = (unsigned char*)sourceBuffer.data() + srcOffset;
-      if (format.subsampling == YUV_444)
-        YUVPlaneToRGBMonochrome_444(componentSizeChroma, mathC, srcC, dst, inputMax, bps, format.bigEndian, inputValSkip, fullRange);
-      else if (format.subsampling == YUV_422)
-        YUVPlaneToRGBMonochrome_422(componentSizeChroma, mathC, srcC, dst, inputMax, bps, format.bigEndian, inputValSkip, fullRange);
-      else if (format.subsampling == YUV_420)
-        YUVPlaneToRGBMonochrome_420(w, h, mathC, srcC, dst, inputMax, bps, format.bigEndian, inputValSkip, fullRange);
-      else if (format.subsampling == YUV_440)
-        YUVPlaneToRGBMonochrome_440(w, h, mathC, srcC, dst, inputMax, bps, format.bigEndian, inputValSkip, fullRange);
-      else if (format.subsampling == YUV_410)
-        YUVPlaneToRGBMonochrome_410(w, h, mathC, srcC, dst, inputMax, bps, format.bigEndian, inputValSkip, fullRange);
-      else if (format.subsampling == YUV_411)
-        YUVPlaneToRGBMonochrome_411(componentSizeChroma, mathC, srcC, dst, inputMax, bps, format.bigEndian, inputValSkip, fullRange);
-      else
-        return false;
+      // The chroma plane may have a lower resolution. The monochrome functions perform the upsampling.
+      convertChroma(w, h, mathC, srcC, dst, inputMax, bps, inputValSkip);
     }
   }
   else
@@ -3078,22 +3626,9 @@ bool videoHandlerYUV::convertYUVPlanarToRGB(const QByteArray &sourceBuffer, ucha
       unsigned char * restrict srcY = (unsigned char*)sourceBuffer.data();
       unsigned char * restrict srcU = uPlaneFirst ? srcY + nrBytesLumaPlane : srcY + nrBytesLumaPlane + nrBytesToNextChromaPlane;
       unsigned char * restrict srcV = uPlaneFirst ? srcY + nrBytesLumaPlane + nrBytesToNextChromaPlane: srcY + nrBytesLumaPlane;
-      UVPlaneResamplingChromaOffset(format, w / format.getSubsamplingHor(), h / format.getSubsamplingVer(), srcU, srcV, inputValSkip, dstU, dstV);
-
-      if (format.subsampling == YUV_444)
-        YUVPlaneToRGB_444(componentSizeLuma, mathY, mathC, srcY, dstU, dstV, dst, RGBConv, fullRange, inputMax, bps, format.bigEndian, 1);
-      else if (format.subsampling == YUV_422)
-        YUVPlaneToRGB_422(w, h, mathY, mathC, srcY, dstU, dstV, dst, RGBConv, fullRange, inputMax, interpolation, bps, format.bigEndian, 1);
-      else if (format.subsampling == YUV_420)
-        YUVPlaneToRGB_420(w, h, mathY, mathC, srcY, dstU, dstV, dst, RGBConv, fullRange, inputMax, interpolation, bps, format.bigEndian, 1);
-      else if (format.subsampling == YUV_440)
-        YUVPlaneToRGB_440(w, h, mathY, mathC, srcY, dstU, dstV, dst, RGBConv, fullRange, inputMax, interpolation, bps, format.bigEndian, 1);
-      else if (format.subsampling == YUV_410)
-        YUVPlaneToRGB_410(w, h, mathY, mathC, srcY, dstU, dstV, dst, RGBConv, fullRange, inputMax, interpolation, bps, format.bigEndian, 1);
-      else if (format.subsampling == YUV_411)
-        YUVPlaneToRGB_411(w, h, mathY, mathC, srcY, dstU, dstV, dst, RGBConv, fullRange, inputMax, interpolation, bps, format.bigEndian, 1);
-      else
-        return false;
+      UVPlaneResamplingFunctionTable[twoBytes][bigEndian](format, w / format.getSubsamplingHor(), h / format.getSubsamplingVer(), srcU, srcV, inputValSkip, dstU, dstV);
+
+      convertYUV(w, h, mathY, mathC, srcY, dstU, dstV, dst, RGBConv, inputMax, bps, 1);
     }
     else
     {
@@ -3102,22 +3637,7 @@ bool videoHandlerYUV::convertYUVPlanarToRGB(const QByteArray &sourceBuffer, ucha
       const unsigned char * restrict srcU = uPlaneFirst ? srcY + nrBytesLumaPlane : srcY + nrBytesLumaPlane + nrBytesToNextChromaPlane;
       const unsigned char * restrict srcV = uPlaneFirst ? srcY + nrBytesLumaPlane + nrBytesToNextChromaPlane: srcY + nrBytesLumaPlane;
 
-      if (format.subsampling == YUV_444)
-        YUVPlaneToRGB_444(componentSizeLuma, mathY, mathC, srcY, srcU, srcV, dst, RGBConv, fullRange, inputMax, bps, format.bigEndian, inputValSkip);
-      else if (format.subsampling == YUV_422)
-        YUVPlaneToRGB_422(w, h, mathY, mathC, srcY, srcU, srcV, dst, RGBConv, fullRange, inputMax, interpolation, bps, format.bigEndian, inputValSkip);
-      else if (format.subsampling == YUV_420)
-        YUVPlaneToRGB_420(w, h, mathY, mathC, srcY, srcU, srcV, dst, RGBConv, fullRange, inputMax, interpolation, bps, format.bigEndian, inputValSkip);
-      else if (format.subsampling == YUV_440)
-        YUVPlaneToRGB_440(w, h, mathY, mathC, srcY, srcU, srcV, dst, RGBConv, fullRange, inputMax, interpolation, bps, format.bigEndian, inputValSkip);
-      else if (format.subsampling == YUV_410)
-        YUVPlaneToRGB_410(w, h, mathY, mathC, srcY, srcU, srcV, dst, RGBConv, fullRange, inputMax, interpolation, bps, format.bigEndian, inputValSkip);
-      else if (format.subsampling == YUV_411)
-        YUVPlaneToRGB_411(w, h, mathY, mathC, srcY, srcU, srcV, dst, RGBConv, fullRange, inputMax, interpolation, bps, format.bigEndian, inputValSkip);
-      else if (format.subsampling == YUV_400)
-        YUVPlaneToRGBMonochrome_444(componentSizeLuma, mathY, srcY, dst, fullRange, inputMax, bps, format.bigEndian, 1);
-      else
-        return false;
+      convertYUV(w, h, mathY, mathC, srcY, srcU, srcV, dst, RGBConv, inputMax, bps, inputValSkip);
     }
   }
 
@@ -3168,9 +3688,9 @@ void videoHandlerYUV::convertYUVToImage(const QByteArray &sourceBuffer, QImage &
     else
       convOK = convertYUVPlanarToRGB(sourceBuffer, outputImage.bits(), curFrameSize, yuvFormat);
   }
-  else
+  else if (!convertYUVPackedToRGB(sourceBuffer, outputImage.bits(), curFrameSize, yuvFormat))
   {
-    // Convert to a planar format first
+    // The packed format can not be converted directly. Convert to a planar format first.
     QByteArray tmpPlanarYUVSource;
     // This is the current format of the buffer. The conversion function will change this.
     yuvPixelFormat bufferPixelFormat = yuvFormat;
@@ -3622,9 +4142,28 @@ QImage videoHandlerYUV::calculateDifference(frameHandler *item2, const int frame
     // The two items have different subsampling modes. Compare RGB values instead.
     return videoHandler::calculateDifference(item2, frameIdxItem0, frameIdxItem1, differenceInfoList, amplificationFactor, markDifference);
 
+  // Load the right raw YUV data (if not already loaded).
+  // This will just update the raw YUV data. No conversion to image (RGB) is performed. This is either
+  // done on request if the frame is actually shown or has already been done by the caching process.
+  if (!loadRawYUVData(frameIdxItem0))
+    return QImage();  // Loading failed
+  if (!yuvItem2->loadRawYUVData(frameIdxItem1))
+    return QImage();  // Loading failed
+
+  // Both YUV buffers are up to date. Really calculate the difference.
+  DEBUG_YUV("videoHandlerYUV::calculateDifference frame idx item 0 %d - item 1 %d", frameIdxItem0, frameIdxItem1);
+  QImage diffImage = calculateDifferenceYUV(currentFrameRawData, srcPixelFormat, frameSize, yuvItem2->currentFrameRawData, yuvItem2->srcPixelFormat, yuvItem2->frameSize, differenceInfoList, amplificationFactor, markDifference, diffYUV, diffYUVFormat);
+
+  // we have a yuv differance available
+  is_YUV_diff = !diffImage.isNull();
+  return diffImage;
+}
+
+QImage videoHandlerYUV::calculateDifferenceYUV(const QByteArray &rawYUV0, const yuvPixelFormat &format0, const QSize &size0, const QByteArray &rawYUV1, const yuvPixelFormat &format1, const QSize &size1, QList<infoItem> &differenceInfoList, const int amplificationFactor, const bool markDifference, QByteArray &diffYUVOut, yuvPixelFormat &diffYUVFormatOut) const
+{
   // Get/Set the bit depth of the input and output
   // If the bit depth if the two items is different, we will scale the item with the lower bit depth up.
-  const int bps_in[2] = {srcPixelFormat.bitsPerSample, yuvItem2->srcPixelFormat.bitsPerSample};
+  const int bps_in[2] = {format0.bitsPerSample, format1.bitsPerSample};
   const int bps_out = std::max(bps_in[0], bps_in[1]);
   // Which of the two input values has to be scaled up? Only one of these (or neither) can be set.
   const bool bitDepthScaling[2] = {bps_in[0] != bps_out, bps_in[1] != bps_out};
@@ -3640,39 +4179,28 @@ QImage videoHandlerYUV::calculateDifference(frameHandler *item2, const int frame
   // Do we amplify the values?
   const bool amplification = (amplificationFactor != 1 && !markDifference);
 
-  // Load the right raw YUV data (if not already loaded).
-  // This will just update the raw YUV data. No conversion to image (RGB) is performed. This is either
-  // done on request if the frame is actually shown or has already been done by the caching process.
-  if (!loadRawYUVData(frameIdxItem0))
-    return QImage();  // Loading failed
-  if (!yuvItem2->loadRawYUVData(frameIdxItem1))
-    return QImage();  // Loading failed
-
-  // Both YUV buffers are up to date. Really calculate the difference.
-  DEBUG_YUV("videoHandlerYUV::calculateDifference frame idx item 0 %d - item 1 %d", frameIdxItem0, frameIdxItem1);
-
   // The items can be of different size (we then calculate the difference of the top left aligned part)
-  const int w_in[2] = {frameSize.width(), yuvItem2->frameSize.width()};
-  const int h_in[2] = {frameSize.height(), yuvItem2->frameSize.height()};
+  const int w_in[2] = {size0.width(), size1.width()};
+  const int h_in[2] = {size0.height(), size1.height()};
   const int w_out = qMin(w_in[0], w_in[1]);
   const int h_out = qMin(h_in[0], h_in[1]);
   // Append a warning if the frame sizes are different
-  if (frameSize != yuvItem2->frameSize)
+  if (size0 != size1)
     differenceInfoList.append(infoItem("Warning", "The size of the two items differs.", "The size of the two input items is different. The difference of the top left aligned part that overlaps will be calculated."));
 
-  yuvPixelFormat tmpDiffYUVFormat(srcPixelFormat.subsampling, bps_out, Order_YUV, true);
-  diffYUVFormat = tmpDiffYUVFormat;
+  yuvPixelFormat tmpDiffYUVFormat(format0.subsampling, bps_out, Order_YUV, true);
+  diffYUVFormatOut = tmpDiffYUVFormat;
 
   if (!canConvertToRGB(tmpDiffYUVFormat, QSize(w_out, h_out)))
     return QImage();
 
 
   // Get subsampling modes (they are identical for both inputs and the output)
-  const int subH = srcPixelFormat.getSubsamplingHor();
-  const int subV = srcPixelFormat.getSubsamplingVer();
+  const int subH = format0.getSubsamplingHor();
+  const int subV = format0.getSubsamplingVer();
 
   // Get the endianess of the inputs
-  const bool bigEndian[2] = {srcPixelFormat.bigEndian, yuvItem2->srcPixelFormat.bigEndian};
+  const bool bigEndian[2] = {format0.bigEndian, format1.bigEndian};
 
   // Get pointers to the inputs
   const int componentSizeLuma_In[2] = {w_in[0]*h_in[0], w_in[1]*h_in[1]};
@@ -3680,20 +4208,20 @@ QImage videoHandlerYUV::calculateDifference(frameHandler *item2, const int frame
   const int nrBytesLumaPlane_In[2] = {bps_in[0] > 8 ? 2 * componentSizeLuma_In[0] : componentSizeLuma_In[0], bps_in[1] > 8 ? 2 * componentSizeLuma_In[1] : componentSizeLuma_In[1]};
   const int nrBytesChromaPlane_In[2] = {bps_in[0] > 8 ? 2 * componentSizeChroma_In[0] : componentSizeChroma_In[0], bps_in[1] > 8 ? 2 * componentSizeChroma_In[1] : componentSizeChroma_In[1]};
   // Current item
-  const unsigned char * restrict srcY1 = (unsigned char*)currentFrameRawData.data();
-  const unsigned char * restrict srcU1 = (srcPixelFormat.planeOrder == Order_YUV || srcPixelFormat.planeOrder == Order_YUVA) ? srcY1 + nrBytesLumaPlane_In[0] : srcY1 + nrBytesLumaPlane_In[0] + nrBytesChromaPlane_In[0];
-  const unsigned char * restrict srcV1 = (srcPixelFormat.planeOrder == Order_YUV || srcPixelFormat.planeOrder == Order_YUVA) ? srcY1 + nrBytesLumaPlane_In[0] + nrBytesChromaPlane_In[0]: srcY1 + nrBytesLumaPlane_In[0];
+  const unsigned char * restrict srcY1 = (unsigned char*)rawYUV0.data();
+  const unsigned char * restrict srcU1 = (format0.planeOrder == Order_YUV || format0.planeOrder == Order_YUVA) ? srcY1 + nrBytesLumaPlane_In[0] : srcY1 + nrBytesLumaPlane_In[0] + nrBytesChromaPlane_In[0];
+  const unsigned char * restrict srcV1 = (format0.planeOrder == Order_YUV || format0.planeOrder == Order_YUVA) ? srcY1 + nrBytesLumaPlane_In[0] + nrBytesChromaPlane_In[0]: srcY1 + nrBytesLumaPlane_In[0];
   // The other item
-  const unsigned char * restrict srcY2 = (unsigned char*)yuvItem2->currentFrameRawData.data();
-  const unsigned char * restrict srcU2 = (yuvItem2->srcPixelFormat.planeOrder == Order_YUV || yuvItem2->srcPixelFormat.planeOrder == Order_YUVA) ? srcY2 + nrBytesLumaPlane_In[1] : srcY2 + nrBytesLumaPlane_In[1] + nrBytesChromaPlane_In[1];
-  const unsigned char * restrict srcV2 = (yuvItem2->srcPixelFormat.planeOrder == Order_YUV || yuvItem2->srcPixelFormat.planeOrder == Order_YUVA) ? srcY2 + nrBytesLumaPlane_In[1] + nrBytesChromaPlane_In[1]: srcY2 + nrBytesLumaPlane_In[1];
+  const unsigned char * restrict srcY2 = (unsigned char*)rawYUV1.data();
+  const unsigned char * restrict srcU2 = (format1.planeOrder == Order_YUV || format1.planeOrder == Order_YUVA) ? srcY2 + nrBytesLumaPlane_In[1] : srcY2 + nrBytesLumaPlane_In[1] + nrBytesChromaPlane_In[1];
+  const unsigned char * restrict srcV2 = (format1.planeOrder == Order_YUV || format1.planeOrder == Order_YUVA) ? srcY2 + nrBytesLumaPlane_In[1] + nrBytesChromaPlane_In[1]: srcY2 + nrBytesLumaPlane_In[1];
 
   // Get pointers to the output
   const int componentSizeLuma_out = w_out*h_out * (bps_out > 8 ? 2 : 1); // Size in bytes
   const int componentSizeChroma_out = (w_out/subH) * (h_out/subV) * (bps_out > 8 ? 2 : 1);
   // Resize the output buffer to the right size
-  diffYUV.resize(componentSizeLuma_out + 2*componentSizeChroma_out);
-  unsigned char * restrict dstY = (unsigned char*)diffYUV.data();
+  diffYUVOut.resize(componentSizeLuma_out + 2*componentSizeChroma_out);
+  unsigned char * restrict dstY = (unsigned char*)diffYUVOut.data();
   unsigned char * restrict dstU = dstY + componentSizeLuma_out;
   unsigned char * restrict dstV = dstU + componentSizeChroma_out;
 
@@ -3804,14 +4332,14 @@ QImage videoHandlerYUV::calculateDifference(frameHandler *item2, const int frame
 
   if (markDifference)
     // We don't want to see the actual difference but just where differences are.
-    markDifferencesYUVPlanarToRGB(diffYUV, outputImage.bits(), QSize(w_out, h_out), tmpDiffYUVFormat);
+    markDifferencesYUVPlanarToRGB(diffYUVOut, outputImage.bits(), QSize(w_out, h_out), tmpDiffYUVFormat);
   else
     // Get the format of the tmpDiffYUV buffer and convert it to RGB
-    convertYUVPlanarToRGB(diffYUV, outputImage.bits(), QSize(w_out, h_out), tmpDiffYUVFormat);
+    convertYUVPlanarToRGB(diffYUVOut, outputImage.bits(), QSize(w_out, h_out), tmpDiffYUVFormat);
 
   // Append the conversion information that will be returned
   QStringList yuvSubsamplings = QStringList() << "4:4:4" << "4:2:2" << "4:2:0" << "4:4:0" << "4:1:0" << "4:1:1" << "4:0:0";
-  differenceInfoList.append(infoItem("Difference Type",QString("YUV %1").arg(yuvSubsamplings[srcPixelFormat.subsampling])));
+  differenceInfoList.append(infoItem("Difference Type",QString("YUV %1").arg(yuvSubsamplings[format0.subsampling])));
   double mse[4];
   mse[0] = double(mseAdd[0]) / (w_out * h_out);
   mse[1] = double(mseAdd[1]) / (w_out * h_out);
@@ -3831,8 +4359,6 @@ QImage videoHandlerYUV::calculateDifference(frameHandler *item2, const int frame
       return outputImage.convertToFormat(f);
   }  
 
-  // we have a yuv differance available
-  is_YUV_diff = true;
   return outputImage;
 }
 
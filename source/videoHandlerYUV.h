@@ -33,6 +33,8 @@
 #ifndef VIDEOHANDLERYUV_H
 #define VIDEOHANDLERYUV_H
 
+#include <QAtomicInt>
+#include <QBitArray>
 #include "videoHandler.h"
 #include "ui_videoHandlerYUV.h"
 #include "ui_videoHandlerYUV_CustomFormatDialog.h"
@@ -210,6 +212,12 @@ public:
   // we will use the playlistItemVideo::calculateDifference function to calculate the difference
   // using the RGB values.
   virtual QImage calculateDifference(frameHandler *item2, const int frameIdxItem0, const int frameIdxItem1, QList<infoItem> &differenceInfoList, const int amplificationFactor, const bool markDifference) Q_DECL_OVERRIDE;
+  // Calculate the difference of the two given raw YUV frames (which must have the same subsampling). Only the given buffers
+  // are used, so this can also be called with local buffers from a caching thread. The YUV difference is put into diffYUVOut.
+  QImage calculateDifferenceYUV(const QByteArray &rawYUV0, const YUV_Internals::yuvPixelFormat &format0, const QSize &size0, const QByteArray &rawYUV1, const YUV_Internals::yuvPixelFormat &format1, const QSize &size1, QList<infoItem> &differenceInfoList, const int amplificationFactor, const bool markDifference, QByteArray &diffYUVOut, YUV_Internals::yuvPixelFormat &diffYUVFormatOut) const;
+  // Load the raw YUV data of the given frame the same way as loadFrameForCaching does. The current buffers are not modified.
+  // The format and size of the data are returned as well. Return false if loading failed.
+  bool loadRawYUVDataForCaching(int frameIndex, QByteArray &rawYUV, YUV_Internals::yuvPixelFormat &yuvFormat, QSize &curFrameSize);
 
   // Get the number of bytes for one YUV frame with the current format
   virtual int64_t getBytesPerFrame() const Q_DECL_OVERRIDE { return srcPixelFormat.bytesPerFrame(frameSize); }
@@ -222,6 +230,9 @@ public:
   // Try to guess and set the format (frameSize/srcPixelFormat) from the raw YUV data.
   // If a file size is given, it is tested if the YUV format and the file size match.
   virtual void setFormatFromCorrelation(const QByteArray &rawYUVData, int64_t fileSize=-1) Q_DECL_OVERRIDE;
+  // The same as setFormatFromCorrelation but the result is returned instead of set. This does not access any members
+  // and can be called from any thread. Return false if no matching format was found.
+  static bool getFormatFromCorrelation(const QByteArray &rawYUVData, int64_t fileSize, QSize &frameSize, YUV_Internals::yuvPixelFormat &format);
 
   // Create the YUV controls and return a pointer to the layout.
   // yuvFormatFixed: For example a YUV file does not have a fixed format (the user can change this),
@@ -293,6 +304,9 @@ protected:
   // A static list of preset YUV formats. These are the formats that are shown in the YUV format selection comboBox.
   YUV_Internals::YUVFormatList yuvPresetsList;
 
+  // With tile conversion, the tile that contains the pixel may not be converted yet. Convert it first.
+  virtual QRgb getPixelVal(int x, int y) Q_DECL_OVERRIDE;
+
   // Get the YUV values for the given pixel.
   virtual void getPixelValue(const QPoint &pixelPos, unsigned int &Y, unsigned int &U, unsigned int &V);
 
@@ -320,10 +334,39 @@ private:
   bool convertYUV420ToRGB(const QByteArray &sourceBuffer, unsigned char *targetBuffer, const QSize &size, const YUV_Internals::yuvPixelFormat format);
 #endif
 
+  // Convert packed 4:2:2 and 4:4:4 formats to RGB in one pass. Return false if the format/settings are not supported. In
+  // this case the data must be converted to planar first (convertYUVPackedToPlanar).
+  bool convertYUVPackedToRGB(const QByteArray &sourceBuffer, unsigned char *targetBuffer, const QSize &frameSize, const YUV_Internals::yuvPixelFormat &sourceBufferFormat) const;
   bool convertYUVPackedToPlanar(const QByteArray &sourceBuffer, QByteArray &targetBuffer, const QSize &frameSize, YUV_Internals::yuvPixelFormat &sourceBufferFormat);
   bool convertYUVPlanarToRGB(const QByteArray &sourceBuffer, unsigned char *targetBuffer, const QSize &frameSize, const YUV_Internals::yuvPixelFormat &sourceBufferFormat) const;
   bool markDifferencesYUVPlanarToRGB(const QByteArray &sourceBuffer, unsigned char *targetBuffer, const QSize &frameSize, const YUV_Internals::yuvPixelFormat &sourceBufferFormat) const;
 
+  // --- Tile conversion
+  // Very large frames (see YUV_TILE_CONVERSION_MIN_PIXELS) are not converted to RGB as a whole if only a small part of
+  // them is visible. The frame is split into tiles and only the tiles in the visible area are converted. Tiles that
+  // become visible later (e.g. when panning) are converted in drawFrame. The partially converted image is tileImage
+  // which shares its data with currentImage for as long as that is the current image.
+  // Get the area of the frame (in pixels) that should be converted. If the whole frame should be converted, an empty
+  // rect is returned.
+  QRect getTileConversionRect() const;
+  // Start the tile conversion of the current raw data into image. Only the tiles in rect are converted.
+  void startTileConversion(QImage &image, const QRect &rect);
+  // If the current image is the tileImage, convert all tiles that intersect rect and were not converted yet.
+  void convertTiles(const QRect &rect);
+  // Convert all tiles of the tileImage that intersect rect and were not converted yet (in parallel). The
+  // tileConversionMutex must be locked.
+  void convertTilesInRect(const QRect &rect);
+  QImage tileImage;
+  // The tiles are written directly to the data of the tileImage.
+  uchar *tileImageBits {nullptr};
+  QByteArray tileRawData;
+  YUV_Internals::yuvPixelFormat tileFormat;
+  QBitArray tilesConverted;
+  QAtomicInt nrTilesNotConverted;
+  // The visible area of the frame in the last call to drawFrame (in pixels)
+  QRect tileVisibleRect;
+  mutable QMutex tileConversionMutex;
+
 #if SSE_CONVERSION_420_ALT
   void yuv420_to_argb8888(quint8 *yp, quint8 *up, quint8 *vp,
                           quint32 sy, quint32 suv,